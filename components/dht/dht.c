@@ -0,0 +1,770 @@
+/*
+ * Copyright (c) 2016 Jonathan Hartsuiker <https://github.com/jsuiker>
+ * Copyright (c) 2018 Ruslan V. Uss <unclerus@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of itscontributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file dht.c
+ *
+ * ESP-IDF driver for DHT11, AM2301 (DHT21, DHT22, AM2302, AM2321), Itead Si7021
+ *
+ * Ported from esp-open-rtos
+ *
+ * Copyright (c) 2016 Jonathan Hartsuiker <https://github.com/jsuiker>\n
+ * Copyright (c) 2018 Ruslan V. Uss <unclerus@gmail.com>\n
+ *
+ * BSD Licensed as described in the file LICENSE
+ */
+#include "dht.h"
+#include "dht_decode.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/lock.h>
+#include <esp_log.h>
+#include <esp_attr.h>
+#include <esp_timer.h>
+#include <esp_cpu.h>
+#include <rom/ets_sys.h>
+#include <soc/soc_caps.h>
+#if SOC_RMT_SUPPORTED
+#include <driver/rmt_rx.h>
+#endif
+//#include <esp_idf_lib_helpers.h>
+
+// DHT timer precision in microseconds
+#define DHT_TIMER_INTERVAL 2
+#define DHT_DATA_BITS DHT_DECODE_BITS
+
+// RMT capture settings: 1 us resolution, a whole frame (~86 edges) fits into one memory block
+#define DHT_RMT_RESOLUTION_HZ 1000000
+#define DHT_RMT_MEM_SYMBOLS 64
+#define DHT_RMT_GLITCH_NS 1000
+#define DHT_RMT_IDLE_NS 200000
+// Longest valid 'high' level of a data bit, anything above is the idle line after the frame
+#define DHT_MAX_BIT_HIGH_US 100
+// Response + 40 bits take at most ~5 ms after the line is released
+#define DHT_FRAME_TIMEOUT_US 8000
+// Start pulse + frame take ~28 ms, leave some margin for scheduling
+#define DHT_RMT_TIMEOUT_MS 60
+// Define DHT_TRACE_DUMP (e.g. target_compile_definitions in CMakeLists.txt) to print every
+// capture in the trace format of host_test/dht_decode, for recording new corpus entries
+
+/*
+ *  Note:
+ *  A suitable pull-up resistor should be connected to the selected GPIO line
+ *
+ *  __           ______          _______                              ___________________________
+ *    \    A    /      \   C    /       \   DHT duration_data_low    /                           \
+ *     \_______/   B    \______/    D    \__________________________/   DHT duration_data_high    \__
+ *
+ *
+ *  Initializing communications with the DHT requires four 'phases' as follows:
+ *
+ *  Phase A - MCU pulls signal low for at least 18000 us
+ *  Phase B - MCU allows signal to float back up and waits 20-40us for DHT to pull it low
+ *  Phase C - DHT pulls signal low for ~80us
+ *  Phase D - DHT lets signal float back up for ~80us
+ *
+ *  After this, the DHT transmits its first bit by holding the signal low for 50us
+ *  and then letting it float back high for a period of time that depends on the data bit.
+ *  duration_data_high is shorter than 50us for a logic '0' and longer than 50us for logic '1'.
+ *
+ *  There are a total of 40 data bits transmitted sequentially. These bits are read into a byte array
+ *  of length 5.  The first and third bytes are humidity (%) and temperature (C), respectively.  Bytes 2 and 4
+ *  are zero-filled and the fifth is a checksum such that:
+ *
+ *  byte_5 == (byte_1 + byte_2 + byte_3 + byte_4) & 0xFF
+ *
+ */
+
+static const char *TAG = "dht";
+
+static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t irq_off_start_us;
+static dht_irq_stats_t irq_stats;
+static dht_decode_stats_t decode_stats = { .worst_min_margin_us = UINT16_MAX };
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+#if SOC_RMT_SUPPORTED
+static dht_backend_t backend = DHT_BACKEND_RMT;
+#else
+static dht_backend_t backend = DHT_BACKEND_BITBANG;
+#endif
+
+/**
+ * Account interrupt-disabled time of a finished transaction.
+ */
+static void dht_account_irq_off(uint32_t irq_off_us)
+{
+    portENTER_CRITICAL(&stats_mux);
+    irq_stats.transactions++;
+    irq_stats.last_irq_off_us = irq_off_us;
+    if (irq_off_us > irq_stats.max_irq_off_us)
+        irq_stats.max_irq_off_us = irq_off_us;
+    irq_stats.total_irq_off_us += irq_off_us;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+static inline void dht_enter_critical(void)
+{
+    portENTER_CRITICAL(&mux);
+    irq_off_start_us = esp_timer_get_time();
+}
+
+static inline void dht_exit_critical(void)
+{
+    uint32_t irq_off_us = (uint32_t)(esp_timer_get_time() - irq_off_start_us);
+    portEXIT_CRITICAL(&mux);
+    dht_account_irq_off(irq_off_us);
+}
+
+#define PORT_ENTER_CRITICAL() dht_enter_critical()
+#define PORT_EXIT_CRITICAL() dht_exit_critical()
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+#define CHECK_LOGE(x, f, msg, ...) do { \
+        esp_err_t __; \
+        if ((__ = x) != ESP_OK) { \
+            PORT_EXIT_CRITICAL(); \
+            *fault = f; \
+            ESP_LOGE(TAG, msg, ## __VA_ARGS__); \
+            return __; \
+        } \
+    } while (0)
+
+
+/**
+ * Wait specified time for pin to go to a specified state.
+ * If timeout is reached and pin doesn't go to a requested state
+ * false is returned.
+ * The elapsed time is returned in pointer 'duration' if it is not NULL.
+ */
+static esp_err_t dht_await_pin_state(gpio_num_t pin, uint32_t timeout,
+       int expected_pin_state, uint32_t *duration)
+{
+    /* XXX dht_await_pin_state() should save pin direction and restore
+     * the direction before return. however, the SDK does not provide
+     * gpio_get_direction().
+     */
+    gpio_set_direction(pin, GPIO_MODE_INPUT);
+    for (uint32_t i = 0; i < timeout; i += DHT_TIMER_INTERVAL)
+    {
+        // need to wait at least a single interval to prevent reading a jitter
+        ets_delay_us(DHT_TIMER_INTERVAL);
+        if (gpio_get_level(pin) == expected_pin_state)
+        {
+            if (duration)
+                *duration = i;
+            return ESP_OK;
+        }
+    }
+
+    return ESP_ERR_TIMEOUT;
+}
+
+/**
+ * Request data from DHT and measure (low, high) widths of every bit.
+ * The function call should be protected from task switching.
+ * Return false if error occurred.
+ */
+static inline esp_err_t dht_fetch_data(dht_sensor_type_t sensor_type, gpio_num_t pin, uint16_t pulses[DHT_DECODE_PULSES],
+        dht_fault_t *fault)
+{
+    uint32_t low_duration;
+    uint32_t high_duration;
+
+    // Phase 'A' pulling signal low to initiate read sequence
+    gpio_set_direction(pin, GPIO_MODE_OUTPUT_OD);
+    gpio_set_level(pin, 0);
+    ets_delay_us(sensor_type == DHT_TYPE_SI7021 ? 500 : 20000);
+    gpio_set_level(pin, 1);
+
+    // Step through Phase 'B', 40us
+    CHECK_LOGE(dht_await_pin_state(pin, 40, 0, NULL), DHT_FAULT_PHASE_B,
+            "Initialization error, problem in phase 'B'");
+    // Step through Phase 'C', 88us
+    CHECK_LOGE(dht_await_pin_state(pin, 88, 1, NULL), DHT_FAULT_PHASE_C,
+            "Initialization error, problem in phase 'C'");
+    // Step through Phase 'D', 88us
+    CHECK_LOGE(dht_await_pin_state(pin, 88, 0, NULL), DHT_FAULT_PHASE_D,
+            "Initialization error, problem in phase 'D'");
+
+    // Read in each of the 40 bits of data...
+    for (int i = 0; i < DHT_DATA_BITS; i++)
+    {
+        CHECK_LOGE(dht_await_pin_state(pin, 65, 1, &low_duration), DHT_FAULT_BIT_TIMEOUT,
+                "LOW bit timeout");
+        CHECK_LOGE(dht_await_pin_state(pin, 75, 0, &high_duration), DHT_FAULT_BIT_TIMEOUT,
+                "HIGH bit timeout");
+
+        // Decoding is done after leaving the critical section
+        pulses[i * 2] = low_duration;
+        pulses[i * 2 + 1] = high_duration;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * Pack two data bytes into single value and take into account sign bit.
+ */
+static inline int16_t dht_convert_data(dht_sensor_type_t sensor_type, uint8_t msb, uint8_t lsb)
+{
+    int16_t data;
+
+    if (sensor_type == DHT_TYPE_DHT11)
+    {
+        data = msb * 10;
+    }
+    else
+    {
+        data = msb & 0x7F;
+        data <<= 8;
+        data |= lsb;
+        if (msb & BIT(7))
+            data = -data;       // convert it to negative
+    }
+
+    return data;
+}
+
+/**
+ * Decode measured pulse widths, verify checksum and convert the frame into
+ * humidity and temperature. Decode cost and timing margin are accounted.
+ */
+static esp_err_t dht_process_pulses(dht_sensor_type_t sensor_type, const uint16_t pulses[DHT_DECODE_PULSES],
+        int16_t *humidity, int16_t *temperature, uint16_t *min_margin_us, dht_fault_t *fault)
+{
+    dht_decode_result_t decoded;
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    dht_decode_status_t status = dht_decode_bits(pulses, &decoded);
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+
+    portENTER_CRITICAL(&stats_mux);
+    decode_stats.decodes++;
+    decode_stats.last_cycles = cycles;
+    if (cycles > decode_stats.max_cycles)
+        decode_stats.max_cycles = cycles;
+    decode_stats.total_cycles += cycles;
+    decode_stats.last_min_margin_us = decoded.min_margin_us;
+    if (decoded.min_margin_us < decode_stats.worst_min_margin_us)
+        decode_stats.worst_min_margin_us = decoded.min_margin_us;
+    portEXIT_CRITICAL(&stats_mux);
+
+    if (min_margin_us)
+        *min_margin_us = decoded.min_margin_us;
+
+    if (status != DHT_DECODE_OK)
+    {
+        ESP_LOGE(TAG, "Checksum failed, invalid data received from sensor");
+        *fault = DHT_FAULT_CHECKSUM;
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    const uint8_t *data = decoded.data;
+    if (humidity)
+        *humidity = dht_convert_data(sensor_type, data[0], data[1]);
+    if (temperature)
+        *temperature = dht_convert_data(sensor_type, data[2], data[3]);
+
+    return ESP_OK;
+}
+
+/**
+ * Bit-bang backend: busy-poll the whole transaction with interrupts disabled.
+ */
+static esp_err_t dht_bitbang_read(dht_sensor_type_t sensor_type, gpio_num_t pin,
+        int16_t *humidity, int16_t *temperature, uint16_t *min_margin_us, dht_fault_t *fault)
+{
+    uint16_t pulses[DHT_DECODE_PULSES];
+
+    gpio_set_direction(pin, GPIO_MODE_OUTPUT_OD);
+    gpio_set_level(pin, 1);
+
+    PORT_ENTER_CRITICAL();
+    esp_err_t result = dht_fetch_data(sensor_type, pin, pulses, fault);
+    if (result == ESP_OK)
+        PORT_EXIT_CRITICAL();
+
+    /* restore GPIO direction because, after calling dht_fetch_data(), the
+     * GPIO direction mode changes */
+    gpio_set_direction(pin, GPIO_MODE_OUTPUT_OD);
+    gpio_set_level(pin, 1);
+
+    if (result != ESP_OK)
+        return result;
+
+    return dht_process_pulses(sensor_type, pulses, humidity, temperature, min_margin_us, fault);
+}
+
+#if SOC_RMT_SUPPORTED
+
+/*
+ * RMT backend.
+ *
+ * The start pulse is timed by an esp_timer one-shot instead of ets_delay_us(),
+ * and the response edge train is captured by an RMT RX channel, so the CPU
+ * never disables interrupts and no task has to wait for the transaction.
+ *
+ * A transaction is a small state machine driven by one esp_timer:
+ *   START   - line is held low, timer fires after phase 'A'
+ *   CAPTURE - receiver armed and line released, timer fires after the
+ *             longest possible frame and completes the transaction
+ * Completion (decode, checksum, user callback) runs in the esp_timer task.
+ *
+ * A single RX channel is shared by all pins and re-created when the pin
+ * changes; only one transaction can be in flight, guarded by `busy`.
+ */
+typedef enum
+{
+    DHT_RMT_PHASE_START = 0,
+    DHT_RMT_PHASE_CAPTURE,
+} dht_rmt_phase_t;
+
+typedef struct
+{
+    rmt_channel_handle_t channel;
+    gpio_num_t pin;
+    esp_timer_handle_t timer;
+    SemaphoreHandle_t busy;
+    SemaphoreHandle_t sync_done;
+    rmt_receive_config_t receive_config;
+    rmt_symbol_word_t symbols[DHT_RMT_MEM_SYMBOLS];
+    volatile size_t num_symbols;
+    dht_rmt_phase_t phase;
+    dht_reading_t reading;
+    dht_read_cb_t cb;
+    void *cb_arg;
+} dht_rmt_ctx_t;
+
+static dht_rmt_ctx_t rmt_ctx = { .pin = GPIO_NUM_NC };
+static _lock_t rmt_init_lock;
+static StaticSemaphore_t rmt_busy_buf;
+static StaticSemaphore_t rmt_sync_done_buf;
+
+static bool IRAM_ATTR dht_rmt_rx_done(rmt_channel_handle_t channel,
+        const rmt_rx_done_event_data_t *edata, void *user_ctx)
+{
+    rmt_ctx.num_symbols = edata->num_symbols;
+    return false;
+}
+
+/**
+ * Flatten captured RMT symbols into a level stream and locate the data bits.
+ */
+static esp_err_t dht_rmt_locate(const rmt_symbol_word_t *symbols, size_t num_symbols,
+        uint16_t pulses[DHT_DECODE_PULSES], dht_fault_t *fault)
+{
+    uint16_t durations[DHT_RMT_MEM_SYMBOLS * 2];
+    uint8_t levels[DHT_RMT_MEM_SYMBOLS * 2];
+    size_t n = 0;
+
+#ifdef DHT_TRACE_DUMP
+    printf("# DHT trace, %u symbols\n", (unsigned)num_symbols);
+    for (size_t i = 0; i < num_symbols && i < DHT_RMT_MEM_SYMBOLS; i++)
+        printf("%u %u %u %u\n", symbols[i].level0, symbols[i].duration0, symbols[i].level1, symbols[i].duration1);
+#endif
+
+    for (size_t i = 0; i < num_symbols && i < DHT_RMT_MEM_SYMBOLS; i++)
+    {
+        if (!symbols[i].duration0)
+            break;
+        levels[n] = symbols[i].level0;
+        durations[n++] = symbols[i].duration0;
+        if (!symbols[i].duration1)
+            break;
+        levels[n] = symbols[i].level1;
+        durations[n++] = symbols[i].duration1;
+    }
+
+    switch (dht_decode_locate(levels, durations, n, DHT_MAX_BIT_HIGH_US, pulses))
+    {
+        case DHT_DECODE_OK:
+            return ESP_OK;
+        case DHT_DECODE_SHORT_FRAME:
+            ESP_LOGE(TAG, "Incomplete frame, %u levels captured", (unsigned)n);
+            *fault = DHT_FAULT_SHORT_FRAME;
+            return ESP_ERR_INVALID_SIZE;
+        default:
+            ESP_LOGE(TAG, "Malformed frame, levels do not alternate");
+            *fault = DHT_FAULT_BAD_LEVEL;
+            return ESP_ERR_INVALID_RESPONSE;
+    }
+}
+
+/**
+ * Finish the transaction in flight and hand the result to its callback.
+ */
+static void dht_rmt_complete(esp_err_t result)
+{
+    uint16_t pulses[DHT_DECODE_PULSES];
+    dht_reading_t reading = rmt_ctx.reading;
+    dht_read_cb_t cb = rmt_ctx.cb;
+    void *cb_arg = rmt_ctx.cb_arg;
+
+    if (result != ESP_OK)
+        reading.fault = DHT_FAULT_DRIVER;
+    else if (!rmt_ctx.num_symbols)
+    {
+        ESP_LOGE(TAG, "No response from sensor on GPIO %d", reading.pin);
+        reading.fault = DHT_FAULT_NO_RESPONSE;
+        result = ESP_ERR_TIMEOUT;
+    }
+    if (result != ESP_OK)
+    {
+        // Abort a pending receive so the next transaction can start
+        rmt_disable(rmt_ctx.channel);
+        rmt_enable(rmt_ctx.channel);
+    }
+    else
+        result = dht_rmt_locate(rmt_ctx.symbols, rmt_ctx.num_symbols, pulses, &reading.fault);
+
+    if (result == ESP_OK)
+        result = dht_process_pulses(reading.sensor_type, pulses, &reading.humidity, &reading.temperature,
+                &reading.min_margin_us, &reading.fault);
+
+    gpio_set_direction(reading.pin, GPIO_MODE_OUTPUT_OD);
+    gpio_set_level(reading.pin, 1);
+
+    // Interrupts are never disabled on this path
+    dht_account_irq_off(0);
+
+    reading.result = result;
+    xSemaphoreGive(rmt_ctx.busy);
+    cb(&reading, cb_arg);
+}
+
+static void dht_rmt_timer_cb(void *arg)
+{
+    if (rmt_ctx.phase == DHT_RMT_PHASE_START)
+    {
+        // End of phase 'A': arm the receiver and release the line, the
+        // sensor answers within 20-40 us so both must happen back to back
+        esp_err_t res = rmt_receive(rmt_ctx.channel, rmt_ctx.symbols,
+                sizeof(rmt_ctx.symbols), &rmt_ctx.receive_config);
+        gpio_set_level(rmt_ctx.pin, 1);
+
+        if (res != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to start RMT receive: %s", esp_err_to_name(res));
+            dht_rmt_complete(res);
+            return;
+        }
+        rmt_ctx.phase = DHT_RMT_PHASE_CAPTURE;
+        esp_timer_start_once(rmt_ctx.timer, DHT_FRAME_TIMEOUT_US);
+    }
+    else
+        dht_rmt_complete(ESP_OK);
+}
+
+static esp_err_t dht_rmt_init(void)
+{
+    esp_err_t res = ESP_OK;
+
+    _lock_acquire(&rmt_init_lock);
+    if (!rmt_ctx.busy)
+    {
+        rmt_ctx.busy = xSemaphoreCreateBinaryStatic(&rmt_busy_buf);
+        rmt_ctx.sync_done = xSemaphoreCreateBinaryStatic(&rmt_sync_done_buf);
+        xSemaphoreGive(rmt_ctx.busy);
+    }
+    if (!rmt_ctx.timer)
+    {
+        const esp_timer_create_args_t timer_args = {
+            .callback = dht_rmt_timer_cb,
+            .name = "dht",
+        };
+        res = esp_timer_create(&timer_args, &rmt_ctx.timer);
+    }
+    _lock_release(&rmt_init_lock);
+
+    return res;
+}
+
+/**
+ * Bind the RX channel to a pin. Must be called with `busy` taken.
+ */
+static esp_err_t dht_rmt_setup(gpio_num_t pin)
+{
+    if (rmt_ctx.channel && rmt_ctx.pin == pin)
+        return ESP_OK;
+
+    if (rmt_ctx.channel)
+    {
+        rmt_disable(rmt_ctx.channel);
+        rmt_del_channel(rmt_ctx.channel);
+        rmt_ctx.channel = NULL;
+        rmt_ctx.pin = GPIO_NUM_NC;
+    }
+
+    const rmt_rx_channel_config_t rx_config = {
+        .gpio_num = pin,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = DHT_RMT_RESOLUTION_HZ,
+        .mem_block_symbols = DHT_RMT_MEM_SYMBOLS,
+    };
+    esp_err_t res = rmt_new_rx_channel(&rx_config, &rmt_ctx.channel);
+    if (res != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to create RMT RX channel on GPIO %d: %s", pin, esp_err_to_name(res));
+        rmt_ctx.channel = NULL;
+        return res;
+    }
+
+    const rmt_rx_event_callbacks_t callbacks = {
+        .on_recv_done = dht_rmt_rx_done,
+    };
+    rmt_rx_register_event_callbacks(rmt_ctx.channel, &callbacks, NULL);
+    rmt_enable(rmt_ctx.channel);
+
+    rmt_ctx.receive_config.signal_range_min_ns = DHT_RMT_GLITCH_NS;
+    rmt_ctx.receive_config.signal_range_max_ns = DHT_RMT_IDLE_NS;
+    rmt_ctx.pin = pin;
+
+    return ESP_OK;
+}
+
+/**
+ * Start a transaction. Must be called with `busy` taken, releases it on error.
+ */
+static esp_err_t dht_rmt_start(dht_sensor_type_t sensor_type, gpio_num_t pin,
+        dht_read_cb_t cb, void *cb_arg)
+{
+    esp_err_t res = dht_rmt_setup(pin);
+    if (res != ESP_OK)
+    {
+        xSemaphoreGive(rmt_ctx.busy);
+        return res;
+    }
+
+    memset(&rmt_ctx.reading, 0, sizeof(rmt_ctx.reading));
+    rmt_ctx.reading.sensor_type = sensor_type;
+    rmt_ctx.reading.pin = pin;
+    rmt_ctx.reading.timestamp_us = esp_timer_get_time();
+    rmt_ctx.cb = cb;
+    rmt_ctx.cb_arg = cb_arg;
+    rmt_ctx.num_symbols = 0;
+    rmt_ctx.phase = DHT_RMT_PHASE_START;
+
+    // Phase 'A' pulling signal low, the timer releases it
+    gpio_set_direction(pin, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_level(pin, 0);
+    res = esp_timer_start_once(rmt_ctx.timer, sensor_type == DHT_TYPE_SI7021 ? 500 : 20000);
+    if (res != ESP_OK)
+    {
+        gpio_set_direction(pin, GPIO_MODE_OUTPUT_OD);
+        gpio_set_level(pin, 1);
+        xSemaphoreGive(rmt_ctx.busy);
+    }
+
+    return res;
+}
+
+static void dht_rmt_sync_done(const dht_reading_t *reading, void *arg)
+{
+    *(dht_reading_t *)arg = *reading;
+    xSemaphoreGive(rmt_ctx.sync_done);
+}
+
+static esp_err_t dht_rmt_read(dht_sensor_type_t sensor_type, gpio_num_t pin,
+        int16_t *humidity, int16_t *temperature)
+{
+    dht_reading_t reading;
+
+    esp_err_t res = dht_rmt_init();
+    if (res != ESP_OK)
+        return res;
+
+    // Wait for an asynchronous transaction in flight, if any
+    if (xSemaphoreTake(rmt_ctx.busy, pdMS_TO_TICKS(DHT_RMT_TIMEOUT_MS)) != pdTRUE)
+        return ESP_ERR_TIMEOUT;
+
+    res = dht_rmt_start(sensor_type, pin, dht_rmt_sync_done, &reading);
+    if (res != ESP_OK)
+        return res;
+
+    // The timer always completes the transaction, with a timeout error at worst
+    xSemaphoreTake(rmt_ctx.sync_done, portMAX_DELAY);
+
+    if (reading.result != ESP_OK)
+        return reading.result;
+
+    if (humidity)
+        *humidity = reading.humidity;
+    if (temperature)
+        *temperature = reading.temperature;
+
+    return ESP_OK;
+}
+
+#endif // SOC_RMT_SUPPORTED
+
+esp_err_t dht_read_data(dht_sensor_type_t sensor_type, gpio_num_t pin,
+        int16_t *humidity, int16_t *temperature)
+{
+    CHECK_ARG(humidity || temperature);
+
+    esp_err_t result;
+
+#if SOC_RMT_SUPPORTED
+    if (backend == DHT_BACKEND_RMT)
+        result = dht_rmt_read(sensor_type, pin, humidity, temperature);
+    else
+#endif
+    {
+        dht_fault_t fault;
+        result = dht_bitbang_read(sensor_type, pin, humidity, temperature, NULL, &fault);
+    }
+
+    if (result != ESP_OK)
+        return result;
+
+    ESP_LOGD(TAG, "Sensor data: humidity=%d, temp=%d",
+            humidity ? *humidity : 0, temperature ? *temperature : 0);
+
+    return ESP_OK;
+}
+
+esp_err_t dht_read_async(dht_sensor_type_t sensor_type, gpio_num_t pin,
+        dht_read_cb_t cb, void *cb_arg)
+{
+    CHECK_ARG(cb);
+
+#if SOC_RMT_SUPPORTED
+    if (backend == DHT_BACKEND_RMT)
+    {
+        esp_err_t res = dht_rmt_init();
+        if (res != ESP_OK)
+            return res;
+
+        if (xSemaphoreTake(rmt_ctx.busy, 0) != pdTRUE)
+            return ESP_ERR_INVALID_STATE;
+
+        return dht_rmt_start(sensor_type, pin, cb, cb_arg);
+    }
+#endif
+
+    // Bit-bang backend can't run in background, complete the read in place
+    dht_reading_t reading = {
+        .sensor_type = sensor_type,
+        .pin = pin,
+        .timestamp_us = esp_timer_get_time(),
+    };
+    reading.result = dht_bitbang_read(sensor_type, pin, &reading.humidity, &reading.temperature,
+            &reading.min_margin_us, &reading.fault);
+    cb(&reading, cb_arg);
+
+    return ESP_OK;
+}
+
+esp_err_t dht_read_float_data(dht_sensor_type_t sensor_type, gpio_num_t pin,
+        float *humidity, float *temperature)
+{
+    CHECK_ARG(humidity || temperature);
+
+    int16_t i_humidity, i_temp;
+
+    esp_err_t res = dht_read_data(sensor_type, pin, humidity ? &i_humidity : NULL, temperature ? &i_temp : NULL);
+    if (res != ESP_OK)
+        return res;
+
+    if (humidity)
+        *humidity = i_humidity / 10.0;
+    if (temperature)
+        *temperature = i_temp / 10.0;
+
+    return ESP_OK;
+}
+
+esp_err_t dht_set_backend(dht_backend_t new_backend)
+{
+#if !SOC_RMT_SUPPORTED
+    if (new_backend == DHT_BACKEND_RMT)
+        return ESP_ERR_NOT_SUPPORTED;
+#endif
+    CHECK_ARG(new_backend == DHT_BACKEND_BITBANG || new_backend == DHT_BACKEND_RMT);
+
+    backend = new_backend;
+
+    return ESP_OK;
+}
+
+dht_backend_t dht_get_backend(void)
+{
+    return backend;
+}
+
+void dht_get_irq_stats(dht_irq_stats_t *stats)
+{
+    if (!stats)
+        return;
+
+    portENTER_CRITICAL(&stats_mux);
+    *stats = irq_stats;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void dht_reset_irq_stats(void)
+{
+    portENTER_CRITICAL(&stats_mux);
+    memset(&irq_stats, 0, sizeof(irq_stats));
+    memset(&decode_stats, 0, sizeof(decode_stats));
+    decode_stats.worst_min_margin_us = UINT16_MAX;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void dht_get_decode_stats(dht_decode_stats_t *stats)
+{
+    if (!stats)
+        return;
+
+    portENTER_CRITICAL(&stats_mux);
+    *stats = decode_stats;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+const char *dht_fault_to_string(dht_fault_t fault)
+{
+    switch (fault)
+    {
+        case DHT_FAULT_NONE: return "none";
+        case DHT_FAULT_PHASE_B: return "phase B";
+        case DHT_FAULT_PHASE_C: return "phase C";
+        case DHT_FAULT_PHASE_D: return "phase D";
+        case DHT_FAULT_BIT_TIMEOUT: return "bit timeout";
+        case DHT_FAULT_NO_RESPONSE: return "no response";
+        case DHT_FAULT_SHORT_FRAME: return "short frame";
+        case DHT_FAULT_BAD_LEVEL: return "bad level";
+        case DHT_FAULT_CHECKSUM: return "checksum";
+        case DHT_FAULT_DRIVER: return "driver";
+        default: return "unknown";
+    }
+}
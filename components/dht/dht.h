@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2016 Jonathan Hartsuiker <https://github.com/jsuiker>
+ * Copyright (c) 2018 Ruslan V. Uss <unclerus@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of itscontributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file dht.h
+ * @defgroup dht dht
+ * @{
+ *
+ * ESP-IDF driver for DHT11, AM2301 (DHT21, DHT22, AM2302, AM2321), Itead Si7021
+ *
+ * Ported from esp-open-rtos
+ *
+ * Copyright (c) 2016 Jonathan Hartsuiker <https://github.com/jsuiker>\n
+ * Copyright (c) 2018 Ruslan V. Uss <unclerus@gmail.com>\n
+ *
+ * BSD Licensed as described in the file LICENSE
+ *
+ * @note A suitable pull-up resistor should be connected to the selected GPIO line
+ *
+ */
+#ifndef __DHT_H__
+#define __DHT_H__
+
+#include <driver/gpio.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Sensor type
+ */
+typedef enum
+{
+    DHT_TYPE_DHT11 = 0,   //!< DHT11
+    DHT_TYPE_AM2301,      //!< AM2301 (DHT21, DHT22, AM2302, AM2321)
+    DHT_TYPE_SI7021       //!< Itead Si7021
+} dht_sensor_type_t;
+
+/**
+ * Acquisition backend
+ */
+typedef enum
+{
+    DHT_BACKEND_BITBANG = 0, //!< Busy-poll the line with interrupts disabled (~25 ms per read)
+    DHT_BACKEND_RMT          //!< Capture edges with RMT, start pulse timed by esp_timer, interrupts stay enabled
+} dht_backend_t;
+
+/**
+ * Failure class of a read
+ */
+typedef enum
+{
+    DHT_FAULT_NONE = 0,    //!< No failure
+    DHT_FAULT_PHASE_B,     //!< Sensor did not pull the line low after the start pulse (bit-bang)
+    DHT_FAULT_PHASE_C,     //!< Sensor response 'low' too long (bit-bang)
+    DHT_FAULT_PHASE_D,     //!< Sensor response 'high' too long (bit-bang)
+    DHT_FAULT_BIT_TIMEOUT, //!< Data bit level too long (bit-bang)
+    DHT_FAULT_NO_RESPONSE, //!< No edges captured at all (RMT)
+    DHT_FAULT_SHORT_FRAME, //!< Fewer than 40 bits captured (RMT)
+    DHT_FAULT_BAD_LEVEL,   //!< Captured levels do not form a valid frame (RMT)
+    DHT_FAULT_CHECKSUM,    //!< Frame decoded but checksum does not match
+    DHT_FAULT_DRIVER,      //!< Peripheral or timer error
+    DHT_FAULT_MAX
+} dht_fault_t;
+
+/**
+ * Result of an asynchronous read
+ */
+typedef struct
+{
+    esp_err_t result;              //!< `ESP_OK` on success, error code otherwise
+    dht_sensor_type_t sensor_type; //!< Sensor type
+    gpio_num_t pin;                //!< GPIO pin the read was started on
+    int16_t humidity;              //!< Humidity, percents * 10, valid when `result` is `ESP_OK`
+    int16_t temperature;           //!< Temperature, degrees Celsius * 10, valid when `result` is `ESP_OK`
+    int64_t timestamp_us;          //!< esp_timer time the read was started at, us
+    uint16_t min_margin_us;        //!< Smallest bit timing margin of the frame, us (0 if not decoded)
+    dht_fault_t fault;             //!< Failure class when `result` is not `ESP_OK`
+} dht_reading_t;
+
+/**
+ * Completion callback of dht_read_async()
+ *
+ * Called from the esp_timer task (or from the caller with the bit-bang
+ * backend). It must not block, typical use is to copy the reading and notify
+ * a task. A new read may be started from the callback.
+ *
+ * @param reading Result of the read, valid only during the call
+ * @param arg User argument passed to dht_read_async()
+ */
+typedef void (*dht_read_cb_t)(const dht_reading_t *reading, void *arg);
+
+/**
+ * Interrupt-off statistics, accumulated over all transactions
+ */
+typedef struct
+{
+    uint32_t transactions;     //!< Number of started transactions
+    uint32_t last_irq_off_us;  //!< Interrupt-disabled time of the last transaction, us
+    uint32_t max_irq_off_us;   //!< Longest interrupt-disabled time, us
+    uint64_t total_irq_off_us; //!< Sum of interrupt-disabled time, us
+} dht_irq_stats_t;
+
+/**
+ * Decoder cost and timing margin statistics, accumulated over all decoded frames
+ */
+typedef struct
+{
+    uint32_t decodes;             //!< Number of decoded frames
+    uint32_t last_cycles;         //!< CPU cycles spent decoding the last frame
+    uint32_t max_cycles;          //!< Most CPU cycles spent decoding a frame
+    uint64_t total_cycles;        //!< Sum of CPU cycles spent decoding
+    uint16_t last_min_margin_us;  //!< Smallest bit timing margin of the last frame, us
+    uint16_t worst_min_margin_us; //!< Smallest bit timing margin seen so far, us
+} dht_decode_stats_t;
+
+/**
+ * @brief Read integer data from sensor on specified pin
+ *
+ * Humidity and temperature are returned as integers.
+ * For example: humidity=625 is 62.5 %, temperature=244 is 24.4 degrees Celsius
+ *
+ * @param sensor_type DHT11 or DHT22
+ * @param pin GPIO pin connected to sensor OUT
+ * @param[out] humidity Humidity, percents * 10, nullable
+ * @param[out] temperature Temperature, degrees Celsius * 10, nullable
+ * @return `ESP_OK` on success
+ */
+esp_err_t dht_read_data(dht_sensor_type_t sensor_type, gpio_num_t pin,
+        int16_t *humidity, int16_t *temperature);
+
+/**
+ * @brief Read float data from sensor on specified pin
+ *
+ * Humidity and temperature are returned as floats.
+ *
+ * @param sensor_type DHT11 or DHT22
+ * @param pin GPIO pin connected to sensor OUT
+ * @param[out] humidity Humidity, percents, nullable
+ * @param[out] temperature Temperature, degrees Celsius, nullable
+ * @return `ESP_OK` on success
+ */
+esp_err_t dht_read_float_data(dht_sensor_type_t sensor_type, gpio_num_t pin,
+        float *humidity, float *temperature);
+
+/**
+ * @brief Start a read without waiting for it to complete
+ *
+ * With the RMT backend the call returns immediately and `cb` is invoked
+ * about 30 ms later with the decoded sample or an error code. Only one read
+ * can be in flight at a time. With the bit-bang backend the read is done in
+ * place and `cb` is invoked before returning.
+ *
+ * @param sensor_type DHT11 or DHT22
+ * @param pin GPIO pin connected to sensor OUT
+ * @param cb Completion callback
+ * @param cb_arg User argument passed to `cb`
+ * @return `ESP_OK` if the read was started, `ESP_ERR_INVALID_STATE` if
+ *         another read is in flight
+ */
+esp_err_t dht_read_async(dht_sensor_type_t sensor_type, gpio_num_t pin,
+        dht_read_cb_t cb, void *cb_arg);
+
+/**
+ * @brief Get a short name of a failure class
+ *
+ * @param fault Failure class
+ * @return Static string
+ */
+const char *dht_fault_to_string(dht_fault_t fault);
+
+/**
+ * @brief Select acquisition backend used by all following reads
+ *
+ * `DHT_BACKEND_RMT` is the default on targets with the RMT peripheral.
+ *
+ * @param backend Backend
+ * @return `ESP_OK` on success, `ESP_ERR_NOT_SUPPORTED` if the target has no RMT
+ */
+esp_err_t dht_set_backend(dht_backend_t backend);
+
+/**
+ * @brief Get current acquisition backend
+ *
+ * @return Backend
+ */
+dht_backend_t dht_get_backend(void);
+
+/**
+ * @brief Get interrupt-off statistics
+ *
+ * Use together with dht_reset_irq_stats() and dht_set_backend() to compare
+ * the time interrupts are blocked by each backend.
+ *
+ * @param[out] stats Statistics
+ */
+void dht_get_irq_stats(dht_irq_stats_t *stats);
+
+/**
+ * @brief Get decoder cost and timing margin statistics
+ *
+ * Frames are decoded by the pure dht_decode_bits() (see dht_decode.h), its
+ * cost is measured with the CPU cycle counter.
+ *
+ * @param[out] stats Statistics
+ */
+void dht_get_decode_stats(dht_decode_stats_t *stats);
+
+/**
+ * @brief Reset interrupt-off and decoder statistics
+ */
+void dht_reset_irq_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif  // __DHT_H__
@@ -0,0 +1,67 @@
+/**
+ * @file dht_decode.c
+ *
+ * Pure DHT pulse-train decoder, see dht_decode.h
+ *
+ * BSD Licensed as described in the file LICENSE
+ */
+#include "dht_decode.h"
+
+#include <string.h>
+
+dht_decode_status_t dht_decode_bits(const uint16_t pulses[DHT_DECODE_PULSES],
+        dht_decode_result_t *result)
+{
+    if (!pulses || !result)
+        return DHT_DECODE_INVALID_ARG;
+
+    memset(result->data, 0, sizeof(result->data));
+    result->min_margin_us = UINT16_MAX;
+    result->min_margin_bit = 0;
+
+    for (int i = 0; i < DHT_DECODE_BITS; i++)
+    {
+        uint16_t low = pulses[i * 2];
+        uint16_t high = pulses[i * 2 + 1];
+        uint16_t margin = high > low ? high - low : low - high;
+
+        result->data[i / 8] |= (high > low) << (7 - i % 8);
+        result->margin_us[i] = margin;
+        if (margin < result->min_margin_us)
+        {
+            result->min_margin_us = margin;
+            result->min_margin_bit = i;
+        }
+    }
+
+    const uint8_t *data = result->data;
+    result->checksum_ok = data[4] == ((data[0] + data[1] + data[2] + data[3]) & 0xFF);
+
+    return result->checksum_ok ? DHT_DECODE_OK : DHT_DECODE_BAD_CHECKSUM;
+}
+
+dht_decode_status_t dht_decode_locate(const uint8_t *levels, const uint16_t *durations,
+        size_t count, uint16_t max_high_us, uint16_t pulses[DHT_DECODE_PULSES])
+{
+    if (!levels || !durations || !pulses)
+        return DHT_DECODE_INVALID_ARG;
+
+    size_t n = count;
+    while (n && levels[n - 1] && durations[n - 1] > max_high_us)
+        n--;
+    if (n && !levels[n - 1])
+        n--;
+    if (n < DHT_DECODE_PULSES)
+        return DHT_DECODE_SHORT_FRAME;
+
+    size_t first = n - DHT_DECODE_PULSES;
+    for (size_t i = 0; i < DHT_DECODE_PULSES; i++)
+    {
+        // Even entries are 'low', odd entries are 'high'
+        if ((levels[first + i] != 0) != ((i & 1) != 0))
+            return DHT_DECODE_BAD_LEVEL;
+        pulses[i] = durations[first + i];
+    }
+
+    return DHT_DECODE_OK;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file dht_decode.h
+ *
+ * Pure DHT pulse-train decoder.
+ *
+ * Converts measured level durations into data bytes without touching any
+ * hardware, so it can be built for the host and fed with recorded traces.
+ * Only standard C headers are used.
+ *
+ * BSD Licensed as described in the file LICENSE
+ */
+#ifndef __DHT_DECODE_H__
+#define __DHT_DECODE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DHT_DECODE_BITS 40
+#define DHT_DECODE_BYTES (DHT_DECODE_BITS / 8)
+//! Number of levels in a data frame: (low, high) pair per bit
+#define DHT_DECODE_PULSES (DHT_DECODE_BITS * 2)
+
+/**
+ * Decoder status
+ */
+typedef enum
+{
+    DHT_DECODE_OK = 0,          //!< Frame decoded, checksum matches
+    DHT_DECODE_BAD_CHECKSUM,    //!< Frame decoded, checksum does not match
+    DHT_DECODE_SHORT_FRAME,     //!< Less than 40 bits found in the level stream
+    DHT_DECODE_BAD_LEVEL,       //!< Levels of the frame do not alternate low/high
+    DHT_DECODE_INVALID_ARG      //!< NULL pointer passed
+} dht_decode_status_t;
+
+/**
+ * Decoder output
+ */
+typedef struct
+{
+    uint8_t data[DHT_DECODE_BYTES];       //!< Raw bytes: humidity, temperature, checksum
+    bool checksum_ok;                     //!< data[4] matches the sum of data[0..3]
+    uint16_t margin_us[DHT_DECODE_BITS];  //!< Per-bit |high - low| distance from the decision threshold, us
+    uint16_t min_margin_us;               //!< Smallest margin of the frame, us
+    uint8_t min_margin_bit;               //!< Index of the bit with the smallest margin
+} dht_decode_result_t;
+
+/**
+ * @brief Decode 40 bits from (low, high) pulse widths
+ *
+ * A bit is '1' when its high level is longer than the preceding low level,
+ * the same rule the bit-bang driver has always used.
+ *
+ * @param pulses Pulse widths in us, low_0, high_0, low_1, high_1, ...
+ * @param[out] result Decoded bytes, checksum status and timing margins
+ * @return `DHT_DECODE_OK` or `DHT_DECODE_BAD_CHECKSUM`
+ */
+dht_decode_status_t dht_decode_bits(const uint16_t pulses[DHT_DECODE_PULSES],
+        dht_decode_result_t *result);
+
+/**
+ * @brief Locate the data bits inside a captured level stream
+ *
+ * The stream may start anywhere before the data bits (start pulse, response
+ * phases). The frame is located from its end: trailing idle 'high' levels
+ * longer than `max_high_us` and the final 'low' are dropped, the preceding
+ * 80 levels are the data bits.
+ *
+ * @param levels Line level of every entry, 0 or 1
+ * @param durations Duration of every entry, us
+ * @param count Number of entries
+ * @param max_high_us Longest valid 'high' of a data bit, us
+ * @param[out] pulses Pulse widths for dht_decode_bits()
+ * @return `DHT_DECODE_OK`, `DHT_DECODE_SHORT_FRAME` or `DHT_DECODE_BAD_LEVEL`
+ */
+dht_decode_status_t dht_decode_locate(const uint8_t *levels, const uint16_t *durations,
+        size_t count, uint16_t max_high_us, uint16_t pulses[DHT_DECODE_PULSES]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __DHT_DECODE_H__
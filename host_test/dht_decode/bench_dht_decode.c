@@ -0,0 +1,82 @@
+/**
+ * @file bench_dht_decode.c
+ *
+ * Host microbenchmark of the DHT decoder.
+ *
+ * Usage: bench_dht_decode [--iterations N] trace...
+ *
+ * Times the flatten -> locate -> decode path of the RMT backend over every
+ * trace and prints ns per frame, so decode-cost regressions show up without
+ * hardware. Host numbers are relative; on the ESP32 the same path runs in
+ * the esp_timer task once per read.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dht_decode.h"
+#include "dht_trace.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned iterations = 100000;
+    int status = 0;
+
+    printf("%-28s %10s %10s %10s\n", "trace", "locate ns", "decode ns", "total ns");
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+        {
+            iterations = strtoul(argv[++i], NULL, 0);
+            continue;
+        }
+
+        dht_trace_t trace;
+        if (!dht_trace_load(argv[i], &trace))
+        {
+            status = 1;
+            continue;
+        }
+
+        uint8_t levels[DHT_TRACE_MAX_LEVELS];
+        uint16_t durations[DHT_TRACE_MAX_LEVELS];
+        uint16_t pulses[DHT_DECODE_PULSES];
+        dht_decode_result_t result;
+        // Keeps the compiler from dropping the loops
+        volatile unsigned sink = 0;
+
+        uint64_t start = now_ns();
+        for (unsigned it = 0; it < iterations; it++)
+        {
+            size_t n = dht_trace_flatten(trace.symbols, trace.num_symbols, levels, durations);
+            sink += dht_decode_locate(levels, durations, n, DHT_TRACE_MAX_BIT_HIGH_US, pulses);
+        }
+        uint64_t locate_ns = now_ns() - start;
+
+        uint64_t decode_ns = 0;
+        if (trace.expect_locate == DHT_DECODE_OK)
+        {
+            start = now_ns();
+            for (unsigned it = 0; it < iterations; it++)
+            {
+                sink += dht_decode_bits(pulses, &result);
+                pulses[it % DHT_DECODE_PULSES] ^= sink & 1;
+            }
+            decode_ns = now_ns() - start;
+        }
+
+        const char *name = strrchr(argv[i], '/');
+        name = name ? name + 1 : argv[i];
+        double n = iterations ? iterations : 1;
+        printf("%-28s %10.1f %10.1f %10.1f\n", name, locate_ns / n, decode_ns / n, (locate_ns + decode_ns) / n);
+    }
+    return status;
+}
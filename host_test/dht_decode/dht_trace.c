@@ -0,0 +1,148 @@
+/**
+ * @file dht_trace.c
+ *
+ * Trace file loader, see dht_trace.h
+ */
+#include "dht_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *status_names[] = {
+    [DHT_DECODE_OK] = "OK",
+    [DHT_DECODE_BAD_CHECKSUM] = "BAD_CHECKSUM",
+    [DHT_DECODE_SHORT_FRAME] = "SHORT_FRAME",
+    [DHT_DECODE_BAD_LEVEL] = "BAD_LEVEL",
+    [DHT_DECODE_INVALID_ARG] = "INVALID_ARG",
+};
+
+const char *dht_trace_status_name(dht_decode_status_t status)
+{
+    if ((size_t)status < sizeof(status_names) / sizeof(status_names[0]))
+        return status_names[status];
+    return "?";
+}
+
+static bool parse_status(const char *name, dht_decode_status_t *status)
+{
+    for (size_t i = 0; i < sizeof(status_names) / sizeof(status_names[0]); i++)
+    {
+        if (!strcmp(name, status_names[i]))
+        {
+            *status = (dht_decode_status_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_expect(char *line, dht_trace_t *trace)
+{
+    bool has_locate = false;
+
+    for (char *tok = strtok(line + strlen("expect"), " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n"))
+    {
+        char *value = strchr(tok, '=');
+        if (!value)
+            return false;
+        *value++ = '\0';
+
+        if (!strcmp(tok, "locate"))
+            has_locate = parse_status(value, &trace->expect_locate);
+        else if (!strcmp(tok, "decode"))
+        {
+            if (!parse_status(value, &trace->expect_decode))
+                return false;
+            trace->has_decode = true;
+        }
+        else if (!strcmp(tok, "data"))
+        {
+            if (strlen(value) != DHT_DECODE_BYTES * 2)
+                return false;
+            for (int i = 0; i < DHT_DECODE_BYTES; i++)
+            {
+                char byte[3] = { value[i * 2], value[i * 2 + 1], '\0' };
+                trace->expect_data[i] = (uint8_t)strtoul(byte, NULL, 16);
+            }
+            trace->has_data = true;
+        }
+        else if (!strcmp(tok, "margin_ge"))
+            trace->margin_ge = atoi(value);
+        else if (!strcmp(tok, "margin_le"))
+            trace->margin_le = atoi(value);
+        else
+            return false;
+    }
+    return has_locate;
+}
+
+bool dht_trace_load(const char *path, dht_trace_t *trace)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    memset(trace, 0, sizeof(*trace));
+    trace->margin_ge = -1;
+    trace->margin_le = -1;
+
+    char line[256];
+    bool has_expect = false;
+    bool ok = true;
+    int line_no = 0;
+    while (ok && fgets(line, sizeof(line), f))
+    {
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+        if (!strncmp(line, "expect", strlen("expect")))
+        {
+            ok = has_expect = parse_expect(line, trace);
+            continue;
+        }
+
+        unsigned l0, d0, l1, d1;
+        if (sscanf(line, "%u %u %u %u", &l0, &d0, &l1, &d1) != 4 || l0 > 1 || l1 > 1 ||
+            d0 > 0x7FFF || d1 > 0x7FFF || trace->num_symbols == DHT_TRACE_MAX_SYMBOLS)
+        {
+            ok = false;
+            continue;
+        }
+        dht_trace_symbol_t *s = &trace->symbols[trace->num_symbols++];
+        s->level0 = l0;
+        s->duration0 = d0;
+        s->level1 = l1;
+        s->duration1 = d1;
+    }
+    fclose(f);
+
+    if (!ok || !has_expect)
+    {
+        fprintf(stderr, "%s:%d: malformed trace\n", path, line_no);
+        return false;
+    }
+    return true;
+}
+
+size_t dht_trace_flatten(const dht_trace_symbol_t *symbols, size_t num_symbols,
+        uint8_t levels[DHT_TRACE_MAX_LEVELS], uint16_t durations[DHT_TRACE_MAX_LEVELS])
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < num_symbols && i < DHT_TRACE_MAX_SYMBOLS; i++)
+    {
+        if (!symbols[i].duration0)
+            break;
+        levels[n] = symbols[i].level0;
+        durations[n++] = symbols[i].duration0;
+        if (!symbols[i].duration1)
+            break;
+        levels[n] = symbols[i].level1;
+        durations[n++] = symbols[i].duration1;
+    }
+    return n;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file dht_trace.h
+ *
+ * Recorded RMT captures of a DHT transaction for host tests.
+ *
+ * A trace file holds one rmt_symbol_word_t per line, "level0 duration0
+ * level1 duration1" (durations in us, 1 MHz RMT resolution), exactly as
+ * printed by the driver when built with DHT_TRACE_DUMP. Lines starting
+ * with '#' are comments; one "expect ..." line states the decoder result:
+ *
+ *   expect locate=OK|SHORT_FRAME|BAD_LEVEL [decode=OK|BAD_CHECKSUM]
+ *          [data=<10 hex digits>] [margin_ge=<us>] [margin_le=<us>]
+ */
+#ifndef __DHT_TRACE_H__
+#define __DHT_TRACE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dht_decode.h"
+
+//! Same capture buffer size as the driver (DHT_RMT_MEM_SYMBOLS)
+#define DHT_TRACE_MAX_SYMBOLS 64
+#define DHT_TRACE_MAX_LEVELS (DHT_TRACE_MAX_SYMBOLS * 2)
+//! Same threshold as the driver (DHT_MAX_BIT_HIGH_US)
+#define DHT_TRACE_MAX_BIT_HIGH_US 100
+
+typedef struct
+{
+    uint8_t level0, level1;
+    uint16_t duration0, duration1;
+} dht_trace_symbol_t;
+
+typedef struct
+{
+    dht_trace_symbol_t symbols[DHT_TRACE_MAX_SYMBOLS];
+    size_t num_symbols;
+
+    dht_decode_status_t expect_locate;
+    bool has_decode;
+    dht_decode_status_t expect_decode;
+    bool has_data;
+    uint8_t expect_data[DHT_DECODE_BYTES];
+    int margin_ge;              //!< -1 when not given
+    int margin_le;              //!< -1 when not given
+} dht_trace_t;
+
+/**
+ * @brief Load a trace file
+ * @return true on success, false with a message on stderr otherwise
+ */
+bool dht_trace_load(const char *path, dht_trace_t *trace);
+
+/**
+ * @brief Flatten symbols into a level stream, like dht_rmt_locate() in the driver
+ * @return Number of levels
+ */
+size_t dht_trace_flatten(const dht_trace_symbol_t *symbols, size_t num_symbols,
+        uint8_t levels[DHT_TRACE_MAX_LEVELS], uint16_t durations[DHT_TRACE_MAX_LEVELS]);
+
+const char *dht_trace_status_name(dht_decode_status_t status);
+
+#endif  // __DHT_TRACE_H__
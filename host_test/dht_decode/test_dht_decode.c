@@ -0,0 +1,280 @@
+/**
+ * @file test_dht_decode.c
+ *
+ * Host unit test for the pure DHT decoder (components/dht/dht_decode.c).
+ *
+ * Usage: test_dht_decode [--fuzz N] trace...
+ *
+ * 1. Hand-built pulse trains pin down the 'high > low' bit rule, margins
+ *    and argument checks of dht_decode_bits()/dht_decode_locate().
+ * 2. Every trace of the corpus is replayed through the same
+ *    flatten -> locate -> decode path as the RMT backend and checked
+ *    against its "expect" line.
+ * 3. N mutations of the corpus (jitter, truncation, glitches, flipped
+ *    levels) must never crash and must keep the decoder invariants.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dht_decode.h"
+#include "dht_trace.h"
+
+static int failures;
+
+#define CHECK(cond, ...)                                                 \
+    do                                                                   \
+    {                                                                    \
+        if (!(cond))                                                     \
+        {                                                                \
+            failures++;                                                  \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                                \
+            fprintf(stderr, "\n");                                       \
+        }                                                                \
+    } while (0)
+
+// Nominal DHT timing: 50 us low, 26 us high for '0', 70 us high for '1'
+static void make_pulses(const uint8_t data[DHT_DECODE_BYTES], uint16_t pulses[DHT_DECODE_PULSES])
+{
+    for (int i = 0; i < DHT_DECODE_BITS; i++)
+    {
+        pulses[i * 2] = 50;
+        pulses[i * 2 + 1] = (data[i / 8] >> (7 - i % 8)) & 1 ? 70 : 26;
+    }
+}
+
+static void test_bit_rule(void)
+{
+    const uint8_t data[DHT_DECODE_BYTES] = { 0x02, 0x8C, 0x00, 0xEB, 0x79 };
+    uint16_t pulses[DHT_DECODE_PULSES];
+    dht_decode_result_t result;
+
+    make_pulses(data, pulses);
+    CHECK(dht_decode_bits(pulses, &result) == DHT_DECODE_OK, "nominal frame");
+    CHECK(!memcmp(result.data, data, sizeof(data)), "nominal data");
+    CHECK(result.checksum_ok, "nominal checksum");
+    CHECK(result.min_margin_us == 20, "min margin %u", result.min_margin_us);
+
+    // A bit is '1' only when high is strictly longer than low
+    memset(pulses, 0, sizeof(pulses));
+    pulses[0] = 50;
+    pulses[1] = 50;
+    pulses[2] = 50;
+    pulses[3] = 51;
+    pulses[4] = 51;
+    pulses[5] = 50;
+    dht_decode_bits(pulses, &result);
+    CHECK((result.data[0] & 0xE0) == 0x40, "high == low is 0, high > low is 1, got 0x%02X", result.data[0]);
+    CHECK(result.margin_us[0] == 0 && result.margin_us[1] == 1 && result.margin_us[2] == 1, "margins %u %u %u",
+            result.margin_us[0], result.margin_us[1], result.margin_us[2]);
+    CHECK(result.min_margin_us == 0 && result.min_margin_bit == 0, "min margin %u at bit %u",
+            result.min_margin_us, result.min_margin_bit);
+
+    // Smallest margin is reported with its bit index
+    make_pulses(data, pulses);
+    pulses[17 * 2 + 1] = 57;
+    dht_decode_bits(pulses, &result);
+    CHECK(result.min_margin_us == 7 && result.min_margin_bit == 17, "min margin %u at bit %u",
+            result.min_margin_us, result.min_margin_bit);
+
+    // Checksum covers the sum of the four data bytes modulo 256
+    const uint8_t wrap[DHT_DECODE_BYTES] = { 0xFF, 0xFF, 0x01, 0x02, 0x01 };
+    make_pulses(wrap, pulses);
+    CHECK(dht_decode_bits(pulses, &result) == DHT_DECODE_OK, "checksum wraps");
+    pulses[39 * 2 + 1] = 26;
+    CHECK(dht_decode_bits(pulses, &result) == DHT_DECODE_BAD_CHECKSUM && !result.checksum_ok, "bad checksum");
+
+    CHECK(dht_decode_bits(NULL, &result) == DHT_DECODE_INVALID_ARG, "NULL pulses");
+    CHECK(dht_decode_bits(pulses, NULL) == DHT_DECODE_INVALID_ARG, "NULL result");
+}
+
+static void test_locate(void)
+{
+    uint8_t levels[DHT_TRACE_MAX_LEVELS];
+    uint16_t durations[DHT_TRACE_MAX_LEVELS];
+    uint16_t pulses[DHT_DECODE_PULSES];
+    size_t n = 0;
+
+    // Preamble (released line, phases C and D), 40 bits, final low, idle
+    levels[n] = 1, durations[n++] = 30;
+    levels[n] = 0, durations[n++] = 80;
+    levels[n] = 1, durations[n++] = 80;
+    for (int i = 0; i < DHT_DECODE_BITS; i++)
+    {
+        levels[n] = 0, durations[n++] = 50;
+        levels[n] = 1, durations[n++] = 26 + i;
+    }
+    levels[n] = 0, durations[n++] = 50;
+
+    CHECK(dht_decode_locate(levels, durations, n, 100, pulses) == DHT_DECODE_OK, "frame with final low");
+    CHECK(pulses[0] == 50 && pulses[1] == 26 && pulses[79] == 65, "pulses %u %u .. %u", pulses[0], pulses[1], pulses[79]);
+
+    // Idle high longer than max_high is dropped, a shorter one is taken as
+    // the last data bit and shifts the frame by one bit
+    levels[n] = 1, durations[n++] = 150;
+    CHECK(dht_decode_locate(levels, durations, n, 100, pulses) == DHT_DECODE_OK && pulses[79] == 65, "idle dropped");
+    durations[n - 1] = 90;
+    CHECK(dht_decode_locate(levels, durations, n, 100, pulses) == DHT_DECODE_OK && pulses[1] == 27 && pulses[79] == 90,
+            "short idle is a bit");
+    n--;
+
+    // Exactly 80 levels after trimming, then one short
+    CHECK(dht_decode_locate(levels + 3, durations + 3, n - 3, 100, pulses) == DHT_DECODE_OK, "no preamble");
+    CHECK(dht_decode_locate(levels + 4, durations + 4, n - 4, 100, pulses) == DHT_DECODE_SHORT_FRAME, "79 levels");
+    CHECK(dht_decode_locate(levels, durations, 0, 100, pulses) == DHT_DECODE_SHORT_FRAME, "empty stream");
+
+    levels[40] = !levels[40];
+    CHECK(dht_decode_locate(levels, durations, n, 100, pulses) == DHT_DECODE_BAD_LEVEL, "flipped level");
+
+    CHECK(dht_decode_locate(NULL, durations, n, 100, pulses) == DHT_DECODE_INVALID_ARG, "NULL levels");
+    CHECK(dht_decode_locate(levels, NULL, n, 100, pulses) == DHT_DECODE_INVALID_ARG, "NULL durations");
+    CHECK(dht_decode_locate(levels, durations, n, 100, NULL) == DHT_DECODE_INVALID_ARG, "NULL pulses");
+}
+
+static void test_trace(const char *path, const dht_trace_t *trace)
+{
+    uint8_t levels[DHT_TRACE_MAX_LEVELS];
+    uint16_t durations[DHT_TRACE_MAX_LEVELS];
+    uint16_t pulses[DHT_DECODE_PULSES];
+    dht_decode_result_t result;
+
+    size_t n = dht_trace_flatten(trace->symbols, trace->num_symbols, levels, durations);
+    dht_decode_status_t status = dht_decode_locate(levels, durations, n, DHT_TRACE_MAX_BIT_HIGH_US, pulses);
+    CHECK(status == trace->expect_locate, "%s: locate %s, expected %s", path,
+            dht_trace_status_name(status), dht_trace_status_name(trace->expect_locate));
+    if (status != DHT_DECODE_OK || !trace->has_decode)
+        return;
+
+    status = dht_decode_bits(pulses, &result);
+    CHECK(status == trace->expect_decode, "%s: decode %s, expected %s", path,
+            dht_trace_status_name(status), dht_trace_status_name(trace->expect_decode));
+    if (trace->has_data)
+        CHECK(!memcmp(result.data, trace->expect_data, DHT_DECODE_BYTES),
+                "%s: data %02X%02X%02X%02X%02X", path,
+                result.data[0], result.data[1], result.data[2], result.data[3], result.data[4]);
+    if (trace->margin_ge >= 0)
+        CHECK(result.min_margin_us >= trace->margin_ge, "%s: min margin %u us at bit %u, expected >= %d",
+                path, result.min_margin_us, result.min_margin_bit, trace->margin_ge);
+    if (trace->margin_le >= 0)
+        CHECK(result.min_margin_us <= trace->margin_le, "%s: min margin %u us, expected <= %d",
+                path, result.min_margin_us, trace->margin_le);
+}
+
+// xorshift32, fixed seed so a failing mutation can be reproduced
+static uint32_t fuzz_state = 0x2545F491;
+
+static uint32_t fuzz_rand(uint32_t bound)
+{
+    fuzz_state ^= fuzz_state << 13;
+    fuzz_state ^= fuzz_state >> 17;
+    fuzz_state ^= fuzz_state << 5;
+    return fuzz_state % bound;
+}
+
+static void mutate(uint8_t *levels, uint16_t *durations, size_t *n)
+{
+    size_t i = *n ? fuzz_rand(*n) : 0;
+
+    switch (fuzz_rand(5))
+    {
+        case 0: // Timing jitter
+            if (*n)
+                durations[i] = (uint16_t)(durations[i] + fuzz_rand(41) - 20);
+            break;
+        case 1: // Capture cut short
+            *n = fuzz_rand(*n + 1);
+            break;
+        case 2: // Glitch splitting a level in three
+            if (*n && *n + 2 <= DHT_TRACE_MAX_LEVELS && durations[i] > 4)
+            {
+                memmove(levels + i + 2, levels + i, *n - i);
+                memmove(durations + i + 2, durations + i, (*n - i) * sizeof(durations[0]));
+                uint16_t spike = 1 + fuzz_rand(3);
+                uint16_t before = fuzz_rand(durations[i] - spike);
+                levels[i + 1] = !levels[i];
+                durations[i + 1] = spike;
+                durations[i + 2] = durations[i] - spike - before;
+                durations[i] = before;
+                *n += 2;
+            }
+            break;
+        case 3: // Corrupted level
+            if (*n)
+                levels[i] = !levels[i];
+            break;
+        default: // Random duration, including 0 and the 15-bit maximum
+            if (*n)
+                durations[i] = fuzz_rand(0x8000);
+            break;
+    }
+}
+
+static void fuzz(const dht_trace_t *traces, size_t num_traces, unsigned iterations)
+{
+    for (unsigned it = 0; it < iterations; it++)
+    {
+        const dht_trace_t *trace = &traces[fuzz_rand(num_traces)];
+        uint8_t levels[DHT_TRACE_MAX_LEVELS];
+        uint16_t durations[DHT_TRACE_MAX_LEVELS];
+        uint16_t pulses[DHT_DECODE_PULSES];
+        dht_decode_result_t result;
+
+        size_t n = dht_trace_flatten(trace->symbols, trace->num_symbols, levels, durations);
+        for (uint32_t m = 1 + fuzz_rand(4); m; m--)
+            mutate(levels, durations, &n);
+
+        dht_decode_status_t status = dht_decode_locate(levels, durations, n, DHT_TRACE_MAX_BIT_HIGH_US, pulses);
+        CHECK(status == DHT_DECODE_OK || status == DHT_DECODE_SHORT_FRAME || status == DHT_DECODE_BAD_LEVEL,
+                "iteration %u: locate %s", it, dht_trace_status_name(status));
+        if (status != DHT_DECODE_OK)
+            continue;
+
+        status = dht_decode_bits(pulses, &result);
+        CHECK(status == (result.checksum_ok ? DHT_DECODE_OK : DHT_DECODE_BAD_CHECKSUM),
+                "iteration %u: status %s disagrees with checksum_ok", it, dht_trace_status_name(status));
+
+        uint16_t min_margin = UINT16_MAX;
+        for (int i = 0; i < DHT_DECODE_BITS; i++)
+        {
+            uint16_t low = pulses[i * 2], high = pulses[i * 2 + 1];
+            int bit = (result.data[i / 8] >> (7 - i % 8)) & 1;
+            CHECK(bit == (high > low), "iteration %u: bit %d is %d for low %u high %u", it, i, bit, low, high);
+            CHECK(result.margin_us[i] == (high > low ? high - low : low - high), "iteration %u: margin of bit %d", it, i);
+            if (result.margin_us[i] < min_margin)
+                min_margin = result.margin_us[i];
+        }
+        CHECK(result.min_margin_us == min_margin && result.margin_us[result.min_margin_bit] == min_margin,
+                "iteration %u: min margin", it);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static dht_trace_t traces[32];
+    size_t num_traces = 0;
+    unsigned fuzz_iterations = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--fuzz") && i + 1 < argc)
+            fuzz_iterations = strtoul(argv[++i], NULL, 0);
+        else if (num_traces == sizeof(traces) / sizeof(traces[0]))
+        {
+            fprintf(stderr, "too many traces\n");
+            return 2;
+        }
+        else if (dht_trace_load(argv[i], &traces[num_traces]))
+            test_trace(argv[i], &traces[num_traces++]);
+        else
+            failures++;
+    }
+
+    test_bit_rule();
+    test_locate();
+    if (fuzz_iterations && num_traces)
+        fuzz(traces, num_traces, fuzz_iterations);
+
+    printf("%zu traces, %u fuzz iterations, %d failures\n", num_traces, fuzz_iterations, failures);
+    return failures ? 1 : 0;
+}
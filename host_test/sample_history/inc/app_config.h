@@ -0,0 +1,10 @@
+// Cấu hình thật của ứng dụng, chỉ đổi số cảm biến có lịch sử để kiểm tra ring riêng từng cảm biến
+#ifndef HOST_TEST_APP_CONFIG_H
+#define HOST_TEST_APP_CONFIG_H
+
+#include "../../../main/inc/app_config.h"
+
+#undef APP_HISTORY_SENSORS
+#define APP_HISTORY_SENSORS 3
+
+#endif // HOST_TEST_APP_CONFIG_H
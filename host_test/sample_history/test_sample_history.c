@@ -0,0 +1,265 @@
+// Host test cho main/src/sample_history.c
+//
+// Nạp vài giờ mẫu cho ba cảm biến với chu kỳ khác nhau rồi so các bản tổng hợp
+// phút/giờ được cập nhật O(1) mỗi mẫu với kết quả tính lại từ đầu trên toàn bộ
+// mẫu; kiểm tra ring mẫu thô giữ đủ 1 giờ ở chu kỳ nhanh nhất cho từng cảm biến,
+// truy vấn theo wall-clock và việc căn khoảng theo mốc UTC sau khi đồng bộ.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "inc/app_config.h"
+#include "inc/sample_history.h"
+
+static int failures;
+
+#define CHECK(cond, ...)                                                            \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            failures++;                                                             \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                                           \
+            fprintf(stderr, "\n");                                                  \
+        }                                                                           \
+    } while (0)
+
+// Thời gian giả: esp_timer (kể từ khởi động) và đồng hồ hệ thống
+static int64_t s_boot_us;
+static int64_t s_wall_offset_s;     // wall = boot + offset; 0 = chưa đồng bộ NTP
+
+int64_t esp_timer_get_time(void) {
+    return s_boot_us;
+}
+
+// sample_history.c được build với -Dgettimeofday=host_test_gettimeofday
+int host_test_gettimeofday(struct timeval *tv, void *tz) {
+    tv->tv_sec = (time_t)(s_boot_us / 1000000 + s_wall_offset_s);
+    tv->tv_usec = (suseconds_t)(s_boot_us % 1000000);
+    return 0;
+}
+
+#define SENSORS APP_HISTORY_SENSORS
+#define RUN_S (3 * 3600 + 1234)   // Hơn 3 giờ: đủ để ring mẫu thô và ring phút của cảm biến nhanh bị ghi đè
+#define SYNC_S 125               // Đồng hồ được đồng bộ giữa một phút tính theo thời gian khởi động
+#define MAX_SAMPLES (RUN_S * 1000 / APP_SENSOR_MIN_INTERVAL_MS + 1)
+
+// Chu kỳ của từng cảm biến: nhanh nhất, 5 s mặc định, heartbeat 60 s
+static const uint32_t s_period_s[SENSORS] = {
+    APP_SENSOR_MIN_INTERVAL_MS / 1000, APP_SENSOR_UPDATE_INTERVAL_MS / 1000, APP_SENSOR_MAX_INTERVAL_MS / 1000,
+};
+
+// Toàn bộ mẫu đã nạp, để tính lại từ đầu
+typedef struct {
+    uint32_t boot_s;
+    int16_t temperature, humidity;
+    uint8_t flags;
+} reference_t;
+
+static reference_t s_ref[SENSORS][MAX_SAMPLES];
+static size_t s_ref_count[SENSORS];
+
+static uint32_t s_rand = 12345;
+
+static int16_t next_value(int16_t center, int16_t spread) {
+    s_rand = s_rand * 1103515245 + 12345;
+    return (int16_t)(center + (int32_t)((s_rand >> 16) % (2 * spread + 1)) - spread);
+}
+
+// Tổng hợp tính lại từ đầu trên các mẫu có boot_s trong [start, end)
+static sample_history_rollup_t reference_rollup(uint8_t id, uint32_t start, uint32_t end) {
+    sample_history_rollup_t r = { .start_s = start, .sensor_id = id };
+    for (size_t i = 0; i < s_ref_count[id]; i++) {
+        const reference_t *s = &s_ref[id][i];
+        if (s->boot_s < start || s->boot_s >= end) {
+            continue;
+        }
+        if (r.count == 0 || s->temperature < r.temp_min) r.temp_min = s->temperature;
+        if (r.count == 0 || s->temperature > r.temp_max) r.temp_max = s->temperature;
+        if (r.count == 0 || s->humidity < r.hum_min) r.hum_min = s->humidity;
+        if (r.count == 0 || s->humidity > r.hum_max) r.hum_max = s->humidity;
+        r.temp_sum += s->temperature;
+        r.hum_sum += s->humidity;
+        r.count++;
+    }
+    return r;
+}
+
+static void check_rollup(const char *what, const sample_history_rollup_t *got, const sample_history_rollup_t *want) {
+    CHECK(got->count == want->count && got->temp_sum == want->temp_sum && got->hum_sum == want->hum_sum &&
+          got->temp_min == want->temp_min && got->temp_max == want->temp_max &&
+          got->hum_min == want->hum_min && got->hum_max == want->hum_max && got->sensor_id == want->sensor_id,
+          "%s sensor %u @%u: count %u/%u, T sum %d/%d min %d/%d max %d/%d, H sum %d/%d min %d/%d max %d/%d",
+          what, want->sensor_id, want->start_s, got->count, want->count, got->temp_sum, want->temp_sum,
+          got->temp_min, want->temp_min, got->temp_max, want->temp_max, got->hum_sum, want->hum_sum,
+          got->hum_min, want->hum_min, got->hum_max, want->hum_max);
+}
+
+static void feed(uint32_t from, uint32_t to) {
+    for (uint32_t t = from; t <= to; t++) {
+        s_boot_us = (int64_t)t * 1000000 + 250000;
+        for (uint8_t id = 0; id < SENSORS; id++) {
+            if (t % s_period_s[id]) {
+                continue;
+            }
+            sensor_sample_t sample = {
+                .sensor_id = id,
+                .temperature = next_value(250 + id * 10, 40),
+                .humidity = next_value(600, 150),
+                .flags = (uint8_t)(t & SENSOR_FLAG_UNCHANGED),
+                .timestamp_us = s_boot_us,
+            };
+            sample_history_add(&sample);
+            s_ref[id][s_ref_count[id]++] = (reference_t){ t, sample.temperature, sample.humidity, sample.flags };
+        }
+    }
+}
+
+static void test_unsynced(void) {
+    sample_history_raw_t raw[4];
+    sample_history_rollup_t rollup;
+    time_t now;
+
+    CHECK(!sample_history_now(&now), "clock before SAMPLE_HISTORY_MIN_VALID_TIME is not synced");
+    CHECK(sample_history_query_raw(0, 0, (time_t)1 << 40, raw, 4) == 0, "raw query before sync");
+    CHECK(sample_history_query_rollup(SAMPLE_HISTORY_MINUTE, 0, 0, (time_t)1 << 40, &rollup, 1) == 0,
+          "rollup query before sync");
+    CHECK(!sample_history_summarize(0, 0, (time_t)1 << 40, &rollup), "summary before sync");
+}
+
+static void test_raw(int64_t offset) {
+    static sample_history_raw_t raw[MAX_SAMPLES];
+    sample_history_stats_t stats;
+    time_t now;
+
+    CHECK(sample_history_now(&now) && now == s_boot_us / 1000000 + offset, "now");
+
+    sample_history_get_stats(&stats);
+    CHECK(stats.added == s_ref_count[0] + s_ref_count[1] + s_ref_count[2], "added %u", stats.added);
+    CHECK(stats.raw_capacity == SENSORS * APP_HISTORY_RAW_SAMPLES, "raw capacity %u", stats.raw_capacity);
+    // Ring của cảm biến nhanh nhất vẫn phủ ~1 giờ; ring của các cảm biến chậm không bị nó đẩy ra
+    CHECK(stats.raw_span_s >= 3600 - APP_SENSOR_MIN_INTERVAL_MS / 1000, "raw span %us", stats.raw_span_s);
+
+    for (uint8_t id = 0; id < SENSORS; id++) {
+        size_t kept = s_ref_count[id] < APP_HISTORY_RAW_SAMPLES ? s_ref_count[id] : APP_HISTORY_RAW_SAMPLES;
+        const reference_t *oldest = &s_ref[id][s_ref_count[id] - kept];
+
+        size_t n = sample_history_query_raw(id, 0, now, raw, MAX_SAMPLES);
+        CHECK(n == kept, "sensor %u: %zu raw samples, expected %zu", id, n, kept);
+        CHECK(n && raw[0].time_s == oldest->boot_s + offset && raw[n - 1].time_s == RUN_S - RUN_S % s_period_s[id] + offset,
+              "sensor %u: raw range", id);
+        for (size_t i = 0; i < n; i++) {
+            const reference_t *want = &oldest[i];
+            if (raw[i].time_s != want->boot_s + offset || raw[i].temperature != want->temperature ||
+                raw[i].humidity != want->humidity || raw[i].flags != want->flags || raw[i].sensor_id != id) {
+                CHECK(0, "sensor %u: raw sample %zu differs", id, i);
+                break;
+            }
+        }
+
+        // Khoảng wall-clock ở giữa: đúng các mẫu có from <= t <= to, tìm bằng tìm kiếm nhị phân
+        time_t from = now - 1800 + 1, to = now - 600;
+        size_t want = 0;
+        for (size_t i = 0; i < s_ref_count[id]; i++) {
+            time_t t = s_ref[id][i].boot_s + offset;
+            want += t >= from && t <= to;
+        }
+        n = sample_history_query_raw(id, from, to, raw, MAX_SAMPLES);
+        CHECK(n == want && raw[0].time_s >= from && raw[n - 1].time_s <= to, "sensor %u: range query %zu/%zu", id, n, want);
+        CHECK(sample_history_query_raw(id, to, from, raw, MAX_SAMPLES) == 0, "reversed range");
+        CHECK(sample_history_query_raw(id, from, to, raw, 3) == 3, "max is honoured");
+    }
+
+    // Mọi cảm biến: theo từng cảm biến, trong mỗi cảm biến cũ trước mới sau
+    size_t n = sample_history_query_raw(SAMPLE_HISTORY_ALL_SENSORS, now - 120, now, raw, MAX_SAMPLES);
+    size_t want = 0;
+    for (uint8_t id = 0; id < SENSORS; id++) {
+        for (size_t i = 0; i < s_ref_count[id]; i++) {
+            want += s_ref[id][i].boot_s + offset >= now - 120;
+        }
+    }
+    CHECK(n == want && raw[0].sensor_id == 0 && raw[n - 1].sensor_id == SENSORS - 1, "all sensors %zu/%zu", n, want);
+}
+
+static void test_rollups(int64_t offset) {
+    static sample_history_rollup_t rollups[APP_HISTORY_MINUTE_ROLLUPS * SENSORS + SENSORS];
+    time_t now;
+    sample_history_now(&now);
+
+    for (int res = 0; res < SAMPLE_HISTORY_RES_MAX; res++) {
+        uint32_t len = res == SAMPLE_HISTORY_MINUTE ? 60 : 3600;
+        uint32_t capacity = res == SAMPLE_HISTORY_MINUTE ? APP_HISTORY_MINUTE_ROLLUPS : APP_HISTORY_HOUR_ROLLUPS;
+        const char *name = res == SAMPLE_HISTORY_MINUTE ? "minute" : "hour";
+
+        for (uint8_t id = 0; id < SENSORS; id++) {
+            size_t n = sample_history_query_rollup(res, id, 0, now, rollups, sizeof(rollups) / sizeof(rollups[0]));
+            // Khoảng đã đóng (tối đa capacity, mới nhất) + khoảng đang mở, khoảng mở bắt đầu ở mốc UTC
+            CHECK(n >= 2 && n <= capacity + 1, "%s sensor %u: %zu rollups", name, id, n);
+            CHECK(n && rollups[n - 1].start_s == now - now % len, "%s sensor %u: open bucket last", name, id);
+            if (res == SAMPLE_HISTORY_MINUTE) {
+                // Mỗi phút đều có mẫu nên ring phút đầy
+                CHECK(n == capacity + 1, "%s sensor %u: ring not full", name, id);
+            }
+
+            // Mỗi cảm biến đều có mẫu trong mọi khoảng nên các khoảng liền nhau: khoảng i phủ
+            // [start_i, start_i+1), khoảng mở phủ tới mẫu cuối
+            uint32_t total = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint32_t start = (uint32_t)(rollups[i].start_s - offset);
+                uint32_t end = i + 1 < n ? (uint32_t)(rollups[i + 1].start_s - offset) : RUN_S + 1;
+                CHECK(end > start, "%s sensor %u: bucket %zu start %u not increasing", name, id, i, start);
+                // Sau khi đồng bộ mọi khoảng mới đều căn theo mốc UTC; khoảng mở lúc đồng bộ dài hơn bình thường
+                CHECK(start < SYNC_S ? end - start < 2 * len : rollups[i].start_s % len == 0 && end - start <= len,
+                      "%s sensor %u: bucket %zu [%u, %u)", name, id, i, start, end);
+                sample_history_rollup_t ref = reference_rollup(id, start, end);
+                check_rollup(name, &rollups[i], &ref);
+                total += rollups[i].count;
+            }
+            if (res == SAMPLE_HISTORY_HOUR) {
+                CHECK(total == s_ref_count[id], "%s sensor %u: %u of %zu samples", name, id, total, s_ref_count[id]);
+            }
+        }
+    }
+
+    // Truy vấn một phút ở giữa: chỉ đúng bucket giao với khoảng
+    time_t minute = (now - 3000) - (now - 3000) % 60;
+    size_t n = sample_history_query_rollup(SAMPLE_HISTORY_MINUTE, 0, minute + 30, minute + 30, rollups, 4);
+    CHECK(n == 1 && rollups[0].start_s == minute, "single minute query: %zu", n);
+
+    // Tóm tắt 1 giờ: gộp các bucket phút giao với [now - 3600, now]
+    for (uint8_t id = 0; id < SENSORS; id++) {
+        sample_history_rollup_t summary;
+        time_t start = (now - 3600) - (now - 3600) % 60;
+        sample_history_rollup_t ref = reference_rollup(id, (uint32_t)(start - offset), RUN_S + 1);
+        CHECK(sample_history_summarize(id, now - 3600, now, &summary), "summary sensor %u", id);
+        ref.start_s = summary.start_s;
+        check_rollup("summary", &summary, &ref);
+        CHECK(summary.start_s == start, "summary start");
+    }
+    sample_history_rollup_t summary;
+    CHECK(!sample_history_summarize(SENSORS, now - 3600, now, &summary), "summary of unknown sensor");
+}
+
+int main(void) {
+    const int64_t offset = 1718000000;  // 2024-06-10 UTC
+
+    sample_history_init();
+    feed(0, SYNC_S - 1);
+    test_unsynced();
+
+    s_wall_offset_s = offset;
+    feed(SYNC_S, RUN_S);
+    // Mẫu của cảm biến ngoài APP_HISTORY_SENSORS bị bỏ qua
+    sensor_sample_t stray = { .sensor_id = SENSORS, .timestamp_us = s_boot_us };
+    sample_history_add(&stray);
+
+    test_raw(offset);
+    test_rollups(offset);
+
+    sample_history_stats_t stats;
+    sample_history_get_stats(&stats);
+    printf("%zu bytes for %d sensors, %u samples added, %u evicted, %d failures\n",
+           stats.ram_bytes, SENSORS, stats.added, stats.evicted, failures);
+    return failures ? 1 : 0;
+}
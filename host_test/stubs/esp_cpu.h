@@ -0,0 +1,15 @@
+// Stub tối thiểu của esp_cpu.h cho host test: "chu kỳ" là nano giây của CLOCK_MONOTONIC.
+// Chỉ lấy 32 bit thấp như bộ đếm CCOUNT, hiệu hai lần đọc đúng với khoảng dưới ~4 s.
+#ifndef HOST_STUB_ESP_CPU_H
+#define HOST_STUB_ESP_CPU_H
+
+#include <stdint.h>
+#include <time.h>
+
+static inline uint32_t esp_cpu_get_cycle_count(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+#endif // HOST_STUB_ESP_CPU_H
@@ -0,0 +1,19 @@
+// Stub của esp_rom_crc.h: CRC-16 little-endian (đa thức 0x1021 phản xạ) như hàm trong ROM
+#ifndef HOST_STUB_ESP_ROM_CRC_H
+#define HOST_STUB_ESP_ROM_CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+static inline uint16_t esp_rom_crc16_le(uint16_t crc, const uint8_t *buf, uint32_t len) {
+    crc = (uint16_t)~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (uint16_t)(crc & 1 ? (crc >> 1) ^ 0x8408 : crc >> 1);
+        }
+    }
+    return (uint16_t)~crc;
+}
+
+#endif // HOST_STUB_ESP_ROM_CRC_H
@@ -0,0 +1,9 @@
+// Stub của esp_timer.h: mỗi host test tự định nghĩa esp_timer_get_time() để điều khiển thời gian
+#ifndef HOST_STUB_ESP_TIMER_H
+#define HOST_STUB_ESP_TIMER_H
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif // HOST_STUB_ESP_TIMER_H
@@ -0,0 +1,14 @@
+// Stub tối thiểu của semphr.h: mutex luôn lấy được ngay (host test chỉ có một luồng)
+#ifndef HOST_STUB_SEMPHR_H
+#define HOST_STUB_SEMPHR_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct { int unused; } StaticSemaphore_t;
+typedef StaticSemaphore_t *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buf) { return buf; }
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) { (void)sem; (void)ticks; return pdTRUE; }
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) { (void)sem; return pdTRUE; }
+
+#endif // HOST_STUB_SEMPHR_H
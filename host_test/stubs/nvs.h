@@ -0,0 +1,18 @@
+// Stub tối thiểu của nvs.h: không có NVS trên máy, mọi thao tác báo lỗi
+#ifndef HOST_STUB_NVS_H
+#define HOST_STUB_NVS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef uint32_t nvs_handle_t;
+typedef enum { NVS_READONLY, NVS_READWRITE } nvs_open_mode_t;
+
+static inline esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *handle) { (void)name; (void)mode; (void)handle; return ESP_ERR_NOT_FOUND; }
+static inline esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t len) { (void)handle; (void)key; (void)value; (void)len; return ESP_ERR_NOT_FOUND; }
+static inline esp_err_t nvs_commit(nvs_handle_t handle) { (void)handle; return ESP_ERR_NOT_FOUND; }
+static inline esp_err_t nvs_erase_all(nvs_handle_t handle) { (void)handle; return ESP_ERR_NOT_FOUND; }
+static inline void nvs_close(nvs_handle_t handle) { (void)handle; }
+
+#endif // HOST_STUB_NVS_H
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""Giải mã payloads.bin do test_telemetry_codec ghi ra bằng tools/telemetry_decode.py (chạy như
+người dùng chạy, qua dòng lệnh) và so từng mẫu với expected.jsonl.
+
+    check_decode.py <telemetry_decode.py> <thư mục chứa payloads.bin và expected.jsonl>
+"""
+
+import json
+import subprocess
+import sys
+from datetime import datetime, timezone
+
+
+def wall_ms(timestamp):
+    # Lô và nhị phân: ISO 8601 UTC; JSON một mẫu: giờ địa phương của firmware (test đặt TZ=UTC)
+    if "T" in timestamp:
+        t = datetime.fromisoformat(timestamp)
+    else:
+        t = datetime.strptime(timestamp, "%Y-%m-%d %H:%M:%S.%f").replace(tzinfo=timezone.utc)
+    return round(t.timestamp() * 1000)
+
+
+def main():
+    decoder, directory = sys.argv[1], sys.argv[2]
+    with open(f"{directory}/expected.jsonl") as f:
+        expected = [json.loads(line) for line in f]
+    output = subprocess.run([sys.executable, decoder, f"{directory}/payloads.bin"],
+                            check=True, capture_output=True, text=True).stdout
+    decoded = [json.loads(line) for line in output.splitlines()]
+
+    errors = 0
+    if len(decoded) != len(expected):
+        print(f"decoded {len(decoded)} samples, expected {len(expected)}")
+        errors += 1
+    for i, (got, want) in enumerate(zip(decoded, expected)):
+        actual = {
+            "sensor": got["sensor"],
+            "seq": got["seq"],
+            "temperature": round(got["temperature"] * 10),
+            "humidity": round(got["humidity"] * 10),
+            "flags": got["flags"],
+            "wall_ms": wall_ms(got["timestamp"]),
+            "replay": got["replay"],
+        }
+        if actual != want:
+            print(f"sample {i}: decoded {actual}, expected {want}")
+            errors += 1
+    print(f"{len(decoded)} samples decoded, {errors} mismatches")
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,225 @@
+// Host test và benchmark cho main/src/telemetry_codec.c + json_writer.c
+//
+//   test_telemetry_codec [--iterations N] [--out DIR]
+//
+// Kiểm tra giới hạn buffer của từng bộ mã hóa, so thời gian mã hóa và kích thước payload của
+// JSON (một mẫu, bộ cũ snprintf, mảng gọn) với nhị phân, rồi ghi các payload vào DIR/payloads.bin
+// (nối liền như mosquitto_sub -N) cùng giá trị mong đợi DIR/expected.jsonl để check_decode.py
+// giải mã lại bằng tools/telemetry_decode.py.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "inc/telemetry_codec.h"
+#include "esp_timer.h"
+
+static int failures;
+
+#define CHECK(cond, ...)                                                            \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            failures++;                                                             \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                                           \
+            fprintf(stderr, "\n");                                                  \
+        }                                                                           \
+    } while (0)
+
+// sensor_sample.c dùng esp_timer cho độ trễ; bộ mã hóa không cần
+int64_t esp_timer_get_time(void) {
+    return 0;
+}
+
+#define T0_US 1714557600123000LL    // 2024-05-01 10:00:00.123 UTC
+
+// Mẫu có giá trị lớn nhất về độ dài khi định dạng
+static const sensor_sample_t s_widest = {
+    .temperature = INT16_MIN, .humidity = INT16_MIN, .sensor_id = UINT8_MAX, .flags = UINT8_MAX, .seq = UINT32_MAX,
+};
+
+static telemetry_log_entry_t make_record(size_t i, int64_t wall_us) {
+    return (telemetry_log_entry_t){
+        .sample = {
+            .temperature = (int16_t)(i % 3 == 0 ? -(int16_t)(i * 7) : (int16_t)(200 + i * 13)),
+            .humidity = (int16_t)(i * 37 % 1001),
+            .sensor_id = (uint8_t)(i % 4),
+            .flags = (uint8_t)(i % 2 ? SENSOR_FLAG_FILTERED : SENSOR_FLAG_FILTERED | SENSOR_FLAG_UNCHANGED),
+            .seq = (uint32_t)(4294967290u + i),     // Qua mốc tràn uint32
+        },
+        .wall_us = wall_us,
+    };
+}
+
+static void test_sample(void) {
+    char buf[TELEMETRY_CODEC_SAMPLE_LEN];
+    sensor_sample_t sample = { .temperature = -53, .humidity = 551, .sensor_id = 1, .flags = 1, .seq = 12 };
+    const char *want = "{\"sensor\":1,\"seq\":12,\"temperature\":-5.3,\"humidity\":55.1,\"flags\":1,"
+                       "\"timestamp\":\"2024-05-01 10:00:00.123\"}";
+
+    size_t len = telemetry_codec_encode_sample(&sample, T0_US, false, buf, sizeof(buf));
+    CHECK(len == strlen(want) && strcmp(buf, want) == 0, "sample JSON: %s", buf);
+
+    // Mẫu dài nhất, có "replay", vừa TELEMETRY_CODEC_SAMPLE_LEN; thiếu chỗ cho '\0' thì trả về 0
+    len = telemetry_codec_encode_sample(&s_widest, T0_US, true, buf, sizeof(buf));
+    CHECK(len > 0 && len < TELEMETRY_CODEC_SAMPLE_LEN, "widest sample JSON: %zu bytes", len);
+    CHECK(telemetry_codec_encode_sample(&s_widest, T0_US, true, buf, len) == 0, "sample JSON overflow");
+
+    len = telemetry_codec_encode_alert("outlier", &s_widest, T0_US, buf, sizeof(buf));
+    CHECK(len > 0 && strncmp(buf, "{\"alert\":\"outlier\",\"sensor\":255,", 32) == 0, "alert JSON: %s", buf);
+}
+
+static void test_batch(void) {
+    enum { N = 8 };
+    static telemetry_log_entry_t records[N];
+    static char buf[TELEMETRY_CODEC_BATCH_LEN(N)];
+
+    // Mỗi hàng dài nhất: dt_ms âm nhỏ nhất và các trường lớn nhất
+    records[0] = (telemetry_log_entry_t){ .sample = s_widest, .wall_us = T0_US };
+    for (size_t i = 1; i < N; i++) {
+        records[i] = (telemetry_log_entry_t){ .sample = s_widest, .wall_us = T0_US + (int64_t)INT32_MIN * 1000 };
+    }
+    size_t len = telemetry_codec_encode_batch(records, N, true, buf, sizeof(buf));
+    CHECK(len > 0 && len < sizeof(buf), "widest batch: %zu bytes, bound %zu", len, sizeof(buf));
+    CHECK(telemetry_codec_encode_batch(records, N, true, buf, len) == 0, "batch overflow");
+    CHECK(telemetry_codec_encode_batch(records, 0, false, buf, sizeof(buf)) == 0, "empty batch");
+
+    records[0] = make_record(0, T0_US);
+    len = telemetry_codec_encode_batch(records, 1, false, buf, sizeof(buf));
+    const char *want = "{\"v\":1,\"t0\":1714557600123,\"s\":[[0,4294967290,0,0,0,17]]}";
+    CHECK(len == strlen(want) && strcmp(buf, want) == 0, "batch JSON: %s", buf);
+}
+
+static void test_packed(void) {
+    static telemetry_log_entry_t records[UINT8_MAX + 1];
+    static uint8_t buf[TELEMETRY_CODEC_PACKED_LEN(UINT8_MAX + 1)];
+
+    for (size_t i = 0; i <= UINT8_MAX; i++) {
+        records[i] = make_record(i, T0_US + (int64_t)i * 2000000);
+    }
+    size_t len = telemetry_codec_encode_packed(records, 2, true, buf, sizeof(buf));
+    CHECK(len == TELEMETRY_CODEC_PACKED_LEN(2), "packed length %zu", len);
+    // Phần đầu little-endian: schema, cờ, số bản ghi, dự trữ, t0_ms
+    static const uint8_t header[] = { TELEMETRY_PACKED_SCHEMA, TELEMETRY_PACKED_FLAG_REPLAY, 2, 0,
+                                      0x7B, 0xC1, 0x98, 0x33, 0x8F, 0x01, 0, 0 };
+    CHECK(memcmp(buf, header, sizeof(header)) == 0, "packed header bytes");
+    // Bản ghi thứ hai: sensor 1, cờ FILTERED, 213, 37, seq 4294967291, dt 2000 ms
+    static const uint8_t second[] = { 1, SENSOR_FLAG_FILTERED, 0xD5, 0x00, 0x25, 0x00,
+                                      0xFB, 0xFF, 0xFF, 0xFF, 0xD0, 0x07, 0x00, 0x00 };
+    CHECK(memcmp(buf + 12 + 14, second, sizeof(second)) == 0, "packed record bytes");
+
+    CHECK(telemetry_codec_encode_packed(records, UINT8_MAX, false, buf, sizeof(buf)) ==
+          TELEMETRY_CODEC_PACKED_LEN(UINT8_MAX), "255 records");
+    CHECK(telemetry_codec_encode_packed(records, UINT8_MAX + 1, false, buf, sizeof(buf)) == 0, "256 records");
+    CHECK(telemetry_codec_encode_packed(records, 2, false, buf, TELEMETRY_CODEC_PACKED_LEN(2) - 1) == 0,
+          "packed overflow");
+}
+
+static void benchmark(uint32_t iterations) {
+    telemetry_codec_bench_t r;
+
+    telemetry_codec_benchmark(iterations, &r);
+    CHECK(r.iterations == iterations, "iterations");
+    // Cùng TELEMETRY_CODEC_BENCH_BATCH mẫu: nhị phân < mảng gọn < JSON một mẫu
+    CHECK(r.packed_bytes == TELEMETRY_CODEC_PACKED_LEN(TELEMETRY_CODEC_BENCH_BATCH) / TELEMETRY_CODEC_BENCH_BATCH,
+          "packed bytes %u", r.packed_bytes);
+    CHECK(r.packed_bytes < r.json_batch_bytes && r.json_batch_bytes < r.json_bytes && r.json_bytes < r.json_snprintf_bytes,
+          "payload sizes");
+
+    printf("Encode %u x %d samples, per sample (ns on host, CPU cycles on target):\n",
+           r.iterations, TELEMETRY_CODEC_BENCH_BATCH);
+    printf("  %-16s %8s %8s\n", "format", "ns", "bytes");
+    printf("  %-16s %8u %8u\n", "json snprintf", r.json_snprintf_cycles, r.json_snprintf_bytes);
+    printf("  %-16s %8u %8u\n", "json writer", r.json_cycles, r.json_bytes);
+    printf("  %-16s %8u %8u\n", "json batch", r.json_batch_cycles, r.json_batch_bytes);
+    printf("  %-16s %8u %8u\n", "packed", r.packed_cycles, r.packed_bytes);
+}
+
+// Ghi payload và các mẫu mong đợi (giá trị 0.1 nguyên, thời gian ms UTC) cho check_decode.py
+static void write_payload(FILE *out, FILE *expected, const void *payload, size_t len,
+                          const telemetry_log_entry_t *records, size_t count, bool replay) {
+    CHECK(len > 0, "payload of %zu samples not encoded", count);
+    fwrite(payload, 1, len, out);
+    for (size_t i = 0; i < count; i++) {
+        const sensor_sample_t *s = &records[i].sample;
+        fprintf(expected, "{\"sensor\":%u,\"seq\":%u,\"temperature\":%d,\"humidity\":%d,\"flags\":%u,"
+                "\"wall_ms\":%lld,\"replay\":%s}\n",
+                s->sensor_id, s->seq, s->temperature, s->humidity, s->flags,
+                (long long)(records[i].wall_us / 1000), replay ? "true" : "false");
+    }
+}
+
+static int write_roundtrip(const char *dir) {
+    enum { N = 40 };
+    static telemetry_log_entry_t records[UINT8_MAX];
+    static char buf[TELEMETRY_CODEC_PAYLOAD_LEN(N)];
+    static uint8_t packed[TELEMETRY_CODEC_PACKED_LEN(UINT8_MAX)];
+    char path[512];
+
+    snprintf(path, sizeof(path), "%s/payloads.bin", dir);
+    FILE *out = fopen(path, "wb");
+    snprintf(path, sizeof(path), "%s/expected.jsonl", dir);
+    FILE *expected = fopen(path, "w");
+    if (out == NULL || expected == NULL) {
+        fprintf(stderr, "cannot write to %s\n", dir);
+        return 1;
+    }
+
+    // Thời gian tăng không đều (kể cả bằng nhau) để dt_ms có nhiều dạng
+    int64_t wall_us = T0_US;
+    for (size_t i = 0; i < UINT8_MAX; i++) {
+        records[i] = make_record(i, wall_us);
+        wall_us += (int64_t)(i % 5) * 1999000 + (i % 7 ? 1000 : 0);
+    }
+    records[3].sample = s_widest;
+
+    for (size_t i = 0; i < 4; i++) {
+        size_t len = telemetry_codec_encode_sample(&records[i].sample, records[i].wall_us, i == 2, buf, sizeof(buf));
+        write_payload(out, expected, buf, len, &records[i], 1, i == 2);
+    }
+    write_payload(out, expected, buf, telemetry_codec_encode_batch(records, 1, false, buf, sizeof(buf)),
+                  records, 1, false);
+    write_payload(out, expected, buf, telemetry_codec_encode_batch(records, N, false, buf, sizeof(buf)),
+                  records, N, false);
+    write_payload(out, expected, buf, telemetry_codec_encode_batch(&records[N], N, true, buf, sizeof(buf)),
+                  &records[N], N, true);
+    write_payload(out, expected, packed, telemetry_codec_encode_packed(records, 1, false, packed, sizeof(packed)),
+                  records, 1, false);
+    write_payload(out, expected, packed, telemetry_codec_encode_packed(records, N, true, packed, sizeof(packed)),
+                  records, N, true);
+    write_payload(out, expected, packed, telemetry_codec_encode_packed(records, UINT8_MAX, false, packed, sizeof(packed)),
+                  records, UINT8_MAX, false);
+
+    fclose(out);
+    fclose(expected);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = 1000;
+    const char *out_dir = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--iterations N] [--out DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+    // Timestamp JSON là giờ địa phương; cố định UTC để so được với giá trị mong đợi
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    test_sample();
+    test_batch();
+    test_packed();
+    benchmark(iterations);
+    if (out_dir != NULL && write_roundtrip(out_dir) != 0) {
+        return 1;
+    }
+    printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
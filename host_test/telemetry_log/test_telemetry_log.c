@@ -0,0 +1,265 @@
+// Host test cho main/src/telemetry_log.c
+//
+// Log chạy trên phân vùng giả trong RAM có đặc tính NOR flash (ghi chỉ xóa bit 1 -> 0, xóa
+// theo sector) và có thể "mất điện" giữa một lần ghi. Kiểm tra quét khôi phục sau lần ghi dở
+// và bản ghi CRC sai, bỏ qua trang bẩn khi mở trang mới, log đầy ghi đè bản ghi chưa gửi
+// (dropped, dời vị trí đọc) và thứ tự gửi lại qua nhiều lần khởi động lại (consumed_mask).
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_partition.h"
+#include "inc/telemetry_log.h"
+
+static int failures;
+
+#define CHECK(cond, ...)                                                            \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            failures++;                                                             \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                                           \
+            fprintf(stderr, "\n");                                                  \
+        }                                                                           \
+    } while (0)
+
+#define SECTORS 4
+#define PAGES_PER_SECTOR (TELEMETRY_LOG_SECTOR_SIZE / TELEMETRY_LOG_PAGE_SIZE)
+#define RECORDS_PER_PAGE 14
+#define CAPACITY (SECTORS * PAGES_PER_SECTOR * RECORDS_PER_PAGE)
+#define HEADER_SIZE 32
+#define RECORD_SIZE 16
+#define BASE_WALL_US 1718000000000000LL   // 2024-06-10 UTC
+
+// Thời gian giả: cố định nên buffer chỉ xuống flash khi đầy trang hoặc flush/peek
+int64_t esp_timer_get_time(void) {
+    return 0;
+}
+
+// Phân vùng "telemetry" trong RAM
+static uint8_t s_flash[SECTORS * TELEMETRY_LOG_SECTOR_SIZE];
+static const esp_partition_t s_partition = {
+    .type = ESP_PARTITION_TYPE_DATA,
+    .subtype = TELEMETRY_LOG_PARTITION_SUBTYPE,
+    .size = sizeof(s_flash),
+    .erase_size = TELEMETRY_LOG_SECTOR_SIZE,
+    .label = TELEMETRY_LOG_PARTITION_LABEL,
+};
+static long s_write_budget = -1;    // Số byte còn ghi được trước khi mất điện; -1: không giới hạn
+static bool s_power_lost;
+static uint32_t s_erases;
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+    if (type != s_partition.type || subtype != s_partition.subtype || strcmp(label, s_partition.label) != 0) {
+        return NULL;
+    }
+    return &s_partition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size) {
+    if (src_offset + size > partition->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(dst, &s_flash[src_offset], size);
+    return ESP_OK;
+}
+
+// NOR flash: ghi chỉ xóa bit. Mất điện giữa chừng thì phần còn lại (và mọi thao tác sau) không xuống flash.
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size) {
+    if (dst_offset + size > partition->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (s_power_lost) {
+        return ESP_OK;
+    }
+    if (s_write_budget >= 0 && (long)size > s_write_budget) {
+        size = (size_t)s_write_budget;
+        s_power_lost = true;
+    }
+    const uint8_t *p = src;
+    for (size_t i = 0; i < size; i++) {
+        s_flash[dst_offset + i] &= p[i];
+    }
+    if (s_write_budget >= 0) {
+        s_write_budget -= (long)size;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size) {
+    if (offset % TELEMETRY_LOG_SECTOR_SIZE || size % TELEMETRY_LOG_SECTOR_SIZE || offset + size > partition->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_power_lost) {
+        memset(&s_flash[offset], 0xFF, size);
+        s_erases++;
+    }
+    return ESP_OK;
+}
+
+// Mất điện sau budget byte ghi kế tiếp
+static void cut_power_after(long budget) {
+    s_write_budget = budget;
+    s_power_lost = false;
+}
+
+// Khởi động lại: nguồn ổn định, RAM của log mất, quét lại phân vùng
+static void reboot(void) {
+    s_write_budget = -1;
+    s_power_lost = false;
+    CHECK(telemetry_log_init() == ESP_OK, "init");
+}
+
+static void format(void) {
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    reboot();
+}
+
+static size_t page_offset(uint32_t page) {
+    return (size_t)page * TELEMETRY_LOG_PAGE_SIZE;
+}
+
+static bool page_erased(uint32_t page) {
+    for (size_t i = 0; i < TELEMETRY_LOG_PAGE_SIZE; i++) {
+        if (s_flash[page_offset(page) + i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void append(uint32_t seq) {
+    sensor_sample_t sample = {
+        .sensor_id = (uint8_t)(seq % 3),
+        .temperature = (int16_t)(200 + seq % 50),
+        .humidity = (int16_t)(500 + seq % 300),
+        .seq = seq,
+    };
+    CHECK(telemetry_log_append(&sample, BASE_WALL_US + (int64_t)seq * 1000000) == ESP_OK, "append %u", seq);
+}
+
+static bool entry_matches(const telemetry_log_entry_t *e, uint32_t seq) {
+    return e->sample.seq == seq && e->sample.sensor_id == seq % 3 && e->sample.temperature == (int16_t)(200 + seq % 50) &&
+           e->sample.humidity == (int16_t)(500 + seq % 300) && e->wall_us == BASE_WALL_US + (int64_t)seq * 1000000;
+}
+
+static telemetry_log_stats_t stats(void) {
+    telemetry_log_stats_t s;
+    telemetry_log_get_stats(&s);
+    return s;
+}
+
+// Lô đầu tiên của trang bị cắt giữa chừng, bản ghi bị hỏng trên flash: quét khi khởi động bỏ qua
+// chúng và trang bẩn không được ghi tiếp
+static void test_torn_writes(void) {
+    static const uint32_t want[] = { 0, 1, 2, 3, 4, 6, 7, 8, 9, 10, 11, 12, 13, 100, 200, 201 };
+    telemetry_log_entry_t entries[TELEMETRY_LOG_PEEK_MAX];
+
+    format();
+    CHECK(stats().capacity == CAPACITY, "capacity %u", stats().capacity);
+
+    // Trang 0 đầy và đã ghi; lô đầu của trang 1 mất điện giữa header
+    for (uint32_t seq = 0; seq < 17; seq++) {
+        append(seq);
+    }
+    CHECK(stats().buffered == 3 && stats().page_writes == 1, "buffered %u", stats().buffered);
+    cut_power_after(HEADER_SIZE / 2);
+    telemetry_log_flush();
+    // Bản ghi 5 của trang 0 hỏng (bit bị xóa)
+    s_flash[page_offset(0) + HEADER_SIZE + 5 * RECORD_SIZE + 4] &= 0xFE;
+
+    reboot();
+    CHECK(stats().pending == 13 && stats().torn == 2, "after torn header: pending %u, torn %u",
+          stats().pending, stats().torn);
+
+    // Trang kế tiếp (1) bẩn: trang mới mở ở sector sau; lô đầu của nó mất điện giữa bản ghi thứ hai
+    uint32_t erases = s_erases;
+    for (uint32_t seq = 100; seq < 103; seq++) {
+        append(seq);
+    }
+    CHECK(s_erases == erases + 1, "sector of the dirty page not erased");
+    cut_power_after(HEADER_SIZE + RECORD_SIZE + RECORD_SIZE / 2);
+    telemetry_log_flush();
+    CHECK(page_erased(2) && !page_erased(PAGES_PER_SECTOR), "dirty page skipped");
+
+    reboot();
+    CHECK(stats().pending == 14 && stats().torn == 3, "after torn record: pending %u, torn %u",
+          stats().pending, stats().torn);
+
+    // Sau khởi động lại ghi vào trang mới, không ghi tiếp trang đang dở
+    append(200);
+    append(201);
+    CHECK(telemetry_log_flush() == ESP_OK && !page_erased(PAGES_PER_SECTOR + 1), "new page after reboot");
+    CHECK(telemetry_log_pending() == 16, "pending %u", telemetry_log_pending());
+
+    size_t n = telemetry_log_peek(entries, TELEMETRY_LOG_PEEK_MAX);
+    CHECK(n == sizeof(want) / sizeof(want[0]), "peek %zu", n);
+    for (size_t i = 0; i < n && i < sizeof(want) / sizeof(want[0]); i++) {
+        CHECK(entry_matches(&entries[i], want[i]), "entry %zu: seq %u, expected %u", i, entries[i].sample.seq, want[i]);
+    }
+    CHECK(telemetry_log_consume(n) == ESP_OK && telemetry_log_pending() == 0, "consume");
+    reboot();
+    CHECK(stats().pending == 0 && telemetry_log_peek(entries, TELEMETRY_LOG_PEEK_MAX) == 0, "all replayed");
+}
+
+// Log đầy khi còn bản ghi chưa gửi: sector cũ nhất bị xóa, bản ghi trong đó tính vào dropped và vị
+// trí đọc dời sang sector kế. Sau đó gửi lại từng phần qua nhiều lần khởi động lại: thứ tự giữ
+// nguyên, bản ghi đã gửi (consumed_mask) không quay lại.
+static void test_wrap_and_replay(void) {
+    const uint32_t total = CAPACITY + 5 * RECORDS_PER_PAGE + 3;
+    telemetry_log_entry_t entries[TELEMETRY_LOG_PEEK_MAX];
+
+    format();
+    for (uint32_t seq = 0; seq < total; seq++) {
+        append(seq);
+    }
+    telemetry_log_stats_t s = stats();
+    CHECK(s.dropped == PAGES_PER_SECTOR * RECORDS_PER_PAGE, "dropped %u", s.dropped);
+    CHECK(s.pending + s.dropped == total && s.appended == total, "pending %u + dropped %u", s.pending, s.dropped);
+
+    uint32_t next = s.dropped;
+    size_t n = telemetry_log_peek(entries, TELEMETRY_LOG_PEEK_MAX);
+    CHECK(n == TELEMETRY_LOG_PEEK_MAX && entry_matches(&entries[0], next), "oldest kept %u, expected %u",
+          entries[0].sample.seq, next);
+
+    for (uint32_t round = 0; telemetry_log_pending() > 0 && round < total; round++) {
+        n = telemetry_log_peek(entries, TELEMETRY_LOG_PEEK_MAX);
+        CHECK(n > 0, "round %u: nothing to peek, %u pending", round, telemetry_log_pending());
+        for (size_t i = 0; i < n; i++) {
+            if (!entry_matches(&entries[i], next + (uint32_t)i)) {
+                CHECK(0, "round %u entry %zu: seq %u, expected %u", round, i, entries[i].sample.seq, next + (uint32_t)i);
+                break;
+            }
+        }
+        // Có lượt chỉ gửi được một phần (dừng giữa trang)
+        size_t count = round % 3 == 2 ? n / 2 + 1 : n;
+        CHECK(telemetry_log_consume(count) == ESP_OK, "consume");
+        next += (uint32_t)count;
+        if (round % 4 == 3) {
+            reboot();
+            CHECK(stats().pending == total - next, "round %u: pending %u after reboot, expected %u",
+                  round, stats().pending, total - next);
+        }
+    }
+    CHECK(next == total, "replayed up to %u of %u", next, total);
+
+    reboot();
+    CHECK(stats().pending == 0, "pending %u", stats().pending);
+
+    // Log rỗng sau khi gửi hết: bản ghi mới được đọc từ trang mới
+    append(total);
+    n = telemetry_log_peek(entries, TELEMETRY_LOG_PEEK_MAX);
+    CHECK(n == 1 && entry_matches(&entries[0], total), "append after drain");
+}
+
+int main(void) {
+    test_torn_writes();
+    test_wrap_and_replay();
+
+    telemetry_log_stats_t s = stats();
+    printf("%u records capacity, %u sector erases, max sector wear %u, %d failures\n",
+           s.capacity, s_erases, s.max_sector_erases, failures);
+    return failures ? 1 : 0;
+}
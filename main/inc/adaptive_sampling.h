@@ -0,0 +1,46 @@
+// inc/adaptive_sampling.h
+#ifndef ADAPTIVE_SAMPLING_H
+#define ADAPTIVE_SAMPLING_H
+
+#include <stdint.h>
+#include "inc/sensor_set.h"
+
+// Cấu hình lấy mẫu thích ứng theo mức thay đổi của dữ liệu
+typedef struct {
+    uint32_t min_period_ms;     // Chu kỳ nhanh nhất, dùng khi giá trị đang thay đổi
+    uint32_t max_period_ms;     // Chu kỳ heartbeat khi giá trị ổn định
+    int16_t temp_deadband;      // Ngưỡng thay đổi nhiệt độ, độ C * 10
+    int16_t hum_deadband;       // Ngưỡng thay đổi độ ẩm, % * 10
+} adaptive_sampling_config_t;
+
+// Bộ đếm cho biết tốc độ lấy mẫu thực tế
+typedef struct {
+    uint32_t sweeps;            // Tổng số lượt quét đã đánh giá
+    uint32_t changed_sweeps;    // Lượt có giá trị vượt deadband (tăng tốc)
+    uint32_t stable_sweeps;     // Lượt ổn định (giãn chu kỳ)
+    uint32_t period_ms;         // Chu kỳ hiện tại
+    uint64_t total_period_ms;   // Tổng các chu kỳ đã áp dụng, dùng tính tốc độ trung bình
+} adaptive_sampling_stats_t;
+
+/**
+ * @brief Khởi tạo bộ điều khiển chu kỳ lấy mẫu.
+ *
+ * Bắt đầu ở chu kỳ nhanh nhất cho đến khi có giá trị tham chiếu.
+ * @return Chu kỳ khởi đầu (ms).
+ */
+uint32_t adaptive_sampling_init(const adaptive_sampling_config_t *config);
+
+/**
+ * @brief Đánh giá một lượt quét và tính chu kỳ kế tiếp.
+ *
+ * Nếu bất kỳ cảm biến nào thay đổi vượt deadband so với giá trị tham chiếu,
+ * chu kỳ trở về min_period_ms; nếu không, chu kỳ tăng gấp đôi cho đến
+ * max_period_ms.
+ * @return Chu kỳ cho lượt quét kế tiếp (ms).
+ */
+uint32_t adaptive_sampling_update(const sensor_batch_t *batch);
+
+// Lấy bản sao bộ đếm (an toàn khi gọi từ task khác)
+void adaptive_sampling_get_stats(adaptive_sampling_stats_t *stats);
+
+#endif // ADAPTIVE_SAMPLING_H
@@ -10,18 +10,96 @@
 
 
 #define DHT11_GPIO_PIN  GPIO_NUM_4 // Chân GPIO kết nối với cảm biến DHT11
+// Danh sách đầu đo { loại, chân GPIO, địa chỉ I2C }, đọc lệch pha nhau trong chu kỳ cập nhật.
+// Loại: SENSOR_KIND_DHT11 / _AM2301 / _SI7021 (1 dây), SENSOR_KIND_SHT3X (I2C, chung bus với LCD).
+// Ví dụ: { { SENSOR_KIND_DHT11, GPIO_NUM_4, 0 }, { SENSOR_KIND_SHT3X, GPIO_NUM_NC, 0x44 } }
+#define APP_SENSORS { { SENSOR_KIND_DHT11, DHT11_GPIO_PIN, 0 } }
+// 1: đọc DHT bằng RMT (không tắt ngắt), 0: bit-bang trong critical section (~25 ms tắt ngắt)
+#define APP_DHT_USE_RMT 1
+
+
+// Bus I2C dùng chung cho LCD và các cảm biến I2C
+#define APP_I2C_PORT    I2C_NUM_0
+#define APP_I2C_SDA_PIN GPIO_NUM_21
+#define APP_I2C_SCL_PIN GPIO_NUM_22
 
 
 // Cấu hình MQTT Broker
 #define MQTT_BROKER_URL "mqtt://test.mosquitto.org" // Ví dụ: "mqtt://test.mosquitto.org"
 #define MQTT_TOPIC      "esp32/dht_data"
 
+// Gom nhiều mẫu vào một message MQTT (mảng gọn, xem inc/telemetry_codec.h): gửi khi đủ
+// APP_MQTT_BATCH_SIZE mẫu hoặc mẫu đầu tiên của lô đã chờ APP_MQTT_BATCH_FLUSH_MS
+#define APP_MQTT_BATCH_SIZE 8 // 1: mỗi mẫu một message JSON như trước
+#define APP_MQTT_BATCH_FLUSH_MS 5000
+
+// Định dạng payload: TELEMETRY_FORMAT_JSON hoặc TELEMETRY_FORMAT_PACKED (nhị phân ~14 byte/mẫu,
+// giải mã bằng tools/telemetry_decode.py). Payload nhị phân đi trên topic riêng để consumer JSON không nhận nhầm.
+#define APP_TELEMETRY_FORMAT TELEMETRY_FORMAT_JSON
+#define MQTT_TOPIC_PACKED MQTT_TOPIC "/packed"
+#define APP_TELEMETRY_CODEC_BENCHMARK_ITERATIONS 0 // > 0: lúc khởi động đo thời gian mã hóa / kích thước từng định dạng
+
+// Chính sách theo loại message (inc/mqtt_policy.h): { QoS, retain, TTL ms (0: không hết hạn), dùng phần outbox dự phòng }.
+// Mẫu trực tiếp QoS 0 không nằm trong outbox; mẫu quá TTL chuyển vào log flash và được gửi lại (QoS 1).
+#define APP_MQTT_POLICIES { \
+    [MQTT_CLASS_TELEMETRY] = { 0, false, 60000, false }, \
+    [MQTT_CLASS_REPLAY]    = { 1, false, 0, false }, \
+    [MQTT_CLASS_ALERT]     = { 1, false, 300000, true }, \
+    [MQTT_CLASS_STATUS]    = { 1, true, 0, true }, \
+}
+#define MQTT_ALERT_TOPIC  MQTT_TOPIC "/alert"
+#define MQTT_STATUS_TOPIC MQTT_TOPIC "/status" // "online" (retain) khi kết nối, broker gửi LWT "offline" khi mất kết nối
+// Trần bộ nhớ outbox của MQTT client (byte); phần APP_MQTT_OUTBOX_RESERVE cuối chỉ dành cho cảnh báo / trạng thái.
+// Message QoS 1 chờ PUBACK quá lâu bị client xóa khỏi outbox (CONFIG_MQTT_OUTBOX_EXPIRED_TIMEOUT_MS) trước khi chạm trần.
+#define APP_MQTT_OUTBOX_LIMIT 16384
+#define APP_MQTT_OUTBOX_RESERVE 2048
+// Cảnh báo đến lúc mất kết nối hoặc bị từ chối vì outbox chạm hạn mức được giữ lại và thử gửi lại mỗi
+// APP_MQTT_ALERT_RETRY_MS (khi đã kết nối) đến hết TTL
+#define APP_MQTT_ALERT_RETRY_MAX 4
+#define APP_MQTT_ALERT_RETRY_MS 1000
+
+// Kênh lệnh: subscribe MQTT_CMD_TOPIC "/#", payload là tham số dạng văn bản (inc/mqtt_command.h):
+//   sensor/interval <ms>   chu kỳ lấy mẫu cố định (APP_SENSOR_MIN..MAX_INTERVAL_MS), 0: trở lại thích ứng
+//   publish/interval <ms>  hạn gửi lô MQTT (APP_MQTT_BATCH_FLUSH_MS), tối đa nửa TTL của MQTT_CLASS_TELEMETRY
+//   ota/start              cập nhật firmware từ FIRMWARE_UPGRADE_URL
+//   stats/dump             in ngay bảng trạng thái hệ thống ra console
+#define MQTT_CMD_TOPIC MQTT_TOPIC "/cmd"
+
+
 
+// Lưu tạm mẫu vào flash (phân vùng "telemetry" trong partitions.csv) khi mất kết nối MQTT,
+// gửi lại theo lô sau khi kết nối lại
+#define APP_TELEMETRY_LOG 1 // 0: bỏ mẫu khi mất kết nối như trước
+#define APP_TELEMETRY_REPLAY_BATCH 10 // Số mẫu gửi lại mỗi lượt
+#define APP_TELEMETRY_REPLAY_INTERVAL_MS 1000 // Khoảng cách tối thiểu giữa hai lượt gửi lại
+#define APP_TELEMETRY_REPLAY_MAX_OUTBOX 4096 // Chỉ gửi lại khi outbox MQTT nhỏ hơn mức này (byte)
+// Bản ghi gửi lại chỉ được đánh dấu đã gửi khi có PUBACK; lượt chưa được xác nhận sau thời gian này (lâu hơn
+// CONFIG_MQTT_OUTBOX_EXPIRED_TIMEOUT_MS, phòng khi client không báo MQTT_EVENT_DELETED) được gửi lại
+#define APP_TELEMETRY_REPLAY_ACK_TIMEOUT_MS 60000
+#define APP_TELEMETRY_FLUSH_MS 30000 // Mẫu được gom trong RAM, ghi xuống flash khi đầy trang (14 mẫu) hoặc sau thời gian này
+#define APP_TELEMETRY_BENCHMARK_RECORDS 0 // > 0: lúc khởi động đo log so với NVS với số mẫu này (XÓA log)
 
-// Kích thước hàng đợi dữ liệu cảm biến
+// Độ sâu hàng đợi mẫu của MQTT trên sample bus (tối đa SAMPLE_BUS_SLOTS)
 #define SENSOR_DATA_QUEUE_SIZE 5
 
 
+// 1: mọi task, mutex và event group dùng bộ nhớ tĩnh (xTaskCreateStatic, ...Static) từ bảng
+// task trong main.c; heap chỉ còn dành cho WiFi/TLS/OTA nên không bị phân mảnh theo thời gian.
+// 0: tạo động trên heap như trước.
+#define APP_STATIC_ALLOCATION 1
+// system_monitor_task cảnh báo khi stack còn trống của một task dưới ngưỡng này (byte). Với bộ nhớ
+// tĩnh, tràn stack ghi đè .bss bên cạnh thay vì làm hỏng một lần cấp phát heap.
+#define APP_TASK_STACK_MIN_FREE 512
+
+// Phân bổ task lên hai nhân (inc/task_placement.h):
+// APP_PLACEMENT_FLOATING: không ghim; APP_PLACEMENT_SPLIT: mạng ở nhân 0, lấy mẫu + LCD ở nhân 1;
+// APP_PLACEMENT_ACQ_ISOLATED: chỉ lấy mẫu ở nhân 1, còn lại ở nhân 0
+#define APP_TASK_PLACEMENT APP_PLACEMENT_SPLIT
+// > 0: benchmark lần lượt mọi phương án, mỗi phương án chạy bấy nhiêu ms rồi khởi động lại;
+// bảng jitter chu kỳ quét / độ trễ publish được in bởi system_monitor_task. 0: tắt
+#define APP_PLACEMENT_BENCHMARK_MS 0
+
+
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT      BIT1
 
@@ -35,7 +113,35 @@
 #define FIRMWARE_UPGRADE_URL "http://192.168.0.101:8000/freeRTOS.bin"
 
 #define APP_LCD_UPDATE_INTERVAL_MS 3000 // Thời gian cập nhật LCD (ms)
+#define APP_LCD_RETRY_MS 200 // Vẽ lại dòng chưa vẽ được vì bus I2C bận sau khoảng này (ms)
 #define APP_SENSOR_UPDATE_INTERVAL_MS 5000 // Thời gian cập nhật cảm biến (ms)
 
+// Lấy mẫu thích ứng: nhanh khi giá trị thay đổi vượt deadband, chậm dần đến heartbeat khi ổn định
+#define APP_SENSOR_ADAPTIVE_SAMPLING 1 // 0: luôn dùng APP_SENSOR_UPDATE_INTERVAL_MS
+#define APP_SENSOR_MIN_INTERVAL_MS 2000 // Chu kỳ nhanh nhất (ms)
+#define APP_SENSOR_MAX_INTERVAL_MS 60000 // Chu kỳ heartbeat khi ổn định (ms)
+#define APP_SENSOR_TEMP_DEADBAND 5 // Ngưỡng thay đổi nhiệt độ (0.1 độ C)
+#define APP_SENSOR_HUM_DEADBAND 20 // Ngưỡng thay đổi độ ẩm (0.1 %)
+
+// Bộ lọc mẫu (số nguyên, đơn vị 0.1): median 5 mẫu rồi làm mượt
+#define APP_SENSOR_FILTER_MODE SENSOR_FILTER_EWMA // SENSOR_FILTER_NONE / _EWMA / _KALMAN
+#define APP_SENSOR_FILTER_EWMA_SHIFT 2 // alpha = 1/4
+#define APP_SENSOR_FILTER_KALMAN_Q 4 // Nhiễu quá trình ((0.1)^2 mỗi mẫu)
+#define APP_SENSOR_FILTER_KALMAN_R 100 // Nhiễu đo ((0.1)^2), DHT11 sai số ~1 độ C
+#define APP_SENSOR_OUTLIER_TEMP 30 // Lệch median > 3.0 độ C: gắn cờ outlier
+#define APP_SENSOR_OUTLIER_HUM 100 // Lệch median > 10 %: gắn cờ outlier
+#define APP_SENSOR_TEMP_MIN (-100) // Dải hợp lệ nhiệt độ (0.1 độ C)
+#define APP_SENSOR_TEMP_MAX 600
+#define APP_SENSOR_HUM_MIN 0 // Dải hợp lệ độ ẩm (0.1 %)
+#define APP_SENSOR_HUM_MAX 1000
+
+// Lịch sử mẫu trong RAM (inc/sample_history.h): mẫu thô + tổng hợp min/max/tb theo phút và giờ
+// Mỗi cảm biến có ring riêng; kho tốn ~20 KB cho mỗi cảm biến với các giá trị dưới đây
+#define APP_HISTORY_SENSORS 1 // Số cảm biến có lịch sử (sensor_id 0..N-1), ít nhất bằng số đầu đo trong APP_SENSORS
+#define APP_HISTORY_RAW_SAMPLES (3600 * 1000 / APP_SENSOR_MIN_INTERVAL_MS) // Mỗi cảm biến: đủ 1 giờ ở chu kỳ nhanh nhất
+#define APP_HISTORY_MINUTE_ROLLUPS 120 // Số bản ghi phút mỗi cảm biến (2 giờ)
+#define APP_HISTORY_HOUR_ROLLUPS 48 // Số bản ghi giờ mỗi cảm biến (2 ngày)
+#define APP_HISTORY_RAM_BUDGET (24576 * APP_HISTORY_SENSORS) // Giới hạn bộ nhớ của kho (byte), kiểm tra lúc biên dịch
+
 
 #endif // APP_CONFIG_H
\ No newline at end of file
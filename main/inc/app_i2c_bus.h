@@ -0,0 +1,16 @@
+// inc/app_i2c_bus.h
+#ifndef APP_I2C_BUS_H
+#define APP_I2C_BUS_H
+
+#include "driver/i2c_master.h"
+#include "esp_err.h"
+
+/**
+ * @brief Lấy bus I2C dùng chung (LCD và các cảm biến I2C), tạo ở lần gọi đầu.
+ *
+ * Mỗi giao dịch trên bus vẫn phải được bao bởi g_i2c_bus_mutex. Giữ mutex
+ * càng ngắn càng tốt (một giao dịch) để LCD và cảm biến xen kẽ nhau.
+ */
+esp_err_t app_i2c_bus_get(i2c_master_bus_handle_t *bus);
+
+#endif // APP_I2C_BUS_H
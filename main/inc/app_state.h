@@ -0,0 +1,95 @@
+// inc/app_state.h
+#ifndef APP_STATE_H
+#define APP_STATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "inc/sensor_sample.h"
+#include "inc/app_status.h"
+#include "inc/seqlock.h"
+
+// Các trường trạng thái, mỗi trường có một writer duy nhất
+typedef enum {
+    APP_STATE_SENSOR = 0,   // Mẫu cảm biến mới nhất (sensor_task)
+    APP_STATE_WIFI,         // Đã có IP hay chưa (wifi_task)
+    APP_STATE_TIME,         // Thời gian đã đồng bộ (ntp_task)
+    APP_STATE_OTA,          // Trạng thái OTA (ota_task)
+    APP_STATE_MQTT,         // Đã kết nối broker hay chưa (mqtt_task)
+    APP_STATE_FIELD_MAX
+} app_state_field_t;
+
+#define APP_STATE_MASK(field) (1u << (field))
+#define APP_STATE_MASK_ALL    ((1u << APP_STATE_FIELD_MAX) - 1)
+
+// Bit thông báo của trường trong task notification; bắt đầu từ bit 8 để không trùng SAMPLE_BUS_NOTIFY_BIT
+#define APP_STATE_NOTIFY_SHIFT 8
+
+// Số consumer tối đa
+#define APP_STATE_MAX_SUBSCRIBERS 4
+
+typedef struct {
+    bool synchronized;
+    struct tm timeinfo;     // Giờ địa phương tại lần cập nhật gần nhất
+} app_state_time_t;
+
+// Bộ đếm lần thức dậy của một consumer
+typedef struct {
+    const char *name;
+    uint32_t field_mask;
+    uint32_t change_wakeups;    // Thức dậy vì có trường thay đổi
+    uint32_t deadline_wakeups;  // Thức dậy vì hết hạn của chính consumer
+} app_state_sub_stats_t;
+
+typedef struct app_state_sub *app_state_sub_t;
+
+// Khởi tạo kho trạng thái, gọi một lần trong app_main trước khi tạo các task
+void app_state_init(void);
+
+/**
+ * @brief Ghi trạng thái. Chỉ khi giá trị thực sự khác, phiên bản của trường
+ * tăng lên và các consumer quan tâm được đánh thức.
+ *
+ * Với APP_STATE_SENSOR, mẫu luôn được lưu nhưng chỉ coi là thay đổi khi
+ * nhiệt độ, độ ẩm hoặc cảm biến khác với mẫu trước.
+ */
+void app_state_set_sensor(const sensor_sample_t *sample);
+void app_state_set_wifi(bool connected);
+void app_state_set_time(const struct tm *timeinfo);
+void app_state_set_ota(ota_status_t status);
+void app_state_set_mqtt(bool connected);
+
+// Đọc bản sao nhất quán, không chặn. Trả về phiên bản của trường (0 = chưa từng ghi).
+uint32_t app_state_get_sensor(sensor_sample_t *sample);
+uint32_t app_state_get_wifi(bool *connected);
+uint32_t app_state_get_time(app_state_time_t *time);
+uint32_t app_state_get_ota(ota_status_t *status);
+uint32_t app_state_get_mqtt(bool *connected);
+
+// Phiên bản hiện tại của một trường
+uint32_t app_state_version(app_state_field_t field);
+
+const char *app_state_field_to_string(app_state_field_t field);
+
+// Số lần đọc / đọc lại vì đụng writer / ghi trên seqlock của một trường
+esp_err_t app_state_get_lock_stats(app_state_field_t field, seqlock_stats_t *stats);
+
+/**
+ * @brief Đăng ký task hiện tại nhận thông báo khi các trường trong field_mask thay đổi.
+ * @param name Tên hiển thị (phải tồn tại suốt đời chương trình).
+ */
+app_state_sub_t app_state_subscribe(const char *name, uint32_t field_mask);
+
+/**
+ * @brief Ngủ đến khi có trường được quan tâm thay đổi hoặc hết timeout.
+ * @return Mask APP_STATE_MASK() của các trường đã thay đổi, 0 nếu hết hạn.
+ */
+uint32_t app_state_wait(app_state_sub_t sub, TickType_t timeout);
+
+size_t app_state_subscriber_count(void);
+esp_err_t app_state_get_sub_stats(size_t index, app_state_sub_stats_t *stats);
+
+#endif // APP_STATE_H
@@ -3,7 +3,6 @@
 #define APP_STATUS_H
 
 #include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
 
 // Enum định nghĩa các trạng thái có thể có của quá trình OTA
 typedef enum {
@@ -24,9 +23,7 @@ typedef enum {
     OTA_STATUS_NO_UPDATE_AVAILABLE   // (Tùy chọn) Không có bản cập nhật mới
 } ota_status_t;
 
-// Khai báo biến toàn cục cho trạng thái OTA và mutex bảo vệ
-extern ota_status_t g_ota_status;
-extern SemaphoreHandle_t g_ota_status_mutex;
+// Trạng thái OTA hiện tại được lưu trong kho trạng thái (inc/app_state.h, APP_STATE_OTA)
 
 // Khai báo hàm chuyển đổi enum trạng thái OTA sang chuỗi để hiển thị
 const char* ota_status_to_string(ota_status_t status);
@@ -0,0 +1,62 @@
+// inc/json_writer.h
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <time.h>
+
+// Độ dài chuỗi thời gian "YYYY-MM-DD HH:MM:SS.mmm" (không tính '\0')
+#define JSON_TIME_LEN 23
+
+/**
+ * Bộ ghi JSON tuần tự vào buffer của người gọi: không cấp phát, không printf,
+ * số nguyên và giá trị 0.1 được đổi sang thập phân bằng phép chia nguyên.
+ * Dấu phẩy giữa các phần tử được chèn tự động. Khi buffer đầy, writer đánh dấu
+ * tràn và bỏ qua mọi lệnh ghi sau đó; json_writer_finish() trả về 0.
+ */
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool need_comma;        // Phần tử kế tiếp cần dấu phẩy đứng trước
+    bool overflow;
+} json_writer_t;
+
+// Bộ đệm định dạng thời gian địa phương: localtime_r chỉ được gọi khi sang giờ mới,
+// phút/giây trong giờ được tính bằng số nguyên. Khởi tạo bằng 0.
+typedef struct {
+    time_t hour_start;      // Thời điểm đầu giờ địa phương của prefix (giây kể từ epoch)
+    bool valid;
+    char prefix[14];        // "YYYY-MM-DD HH:"
+} json_time_cache_t;
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size);
+
+void json_writer_begin_object(json_writer_t *w);
+void json_writer_end_object(json_writer_t *w);
+void json_writer_begin_array(json_writer_t *w);
+void json_writer_end_array(json_writer_t *w);
+
+// Tên trường; key là chuỗi hằng không cần escape
+void json_writer_key(json_writer_t *w, const char *key);
+
+void json_writer_int(json_writer_t *w, int32_t value);
+void json_writer_uint(json_writer_t *w, uint32_t value);
+void json_writer_int64(json_writer_t *w, int64_t value);
+void json_writer_bool(json_writer_t *w, bool value);
+
+// Giá trị đơn vị 0.1 dạng số thập phân một chữ số lẻ: 253 -> 25.3, -5 -> -0.5
+void json_writer_tenths(json_writer_t *w, int32_t tenths);
+
+// Chuỗi có escape '"', '\\' và ký tự điều khiển
+void json_writer_string(json_writer_t *w, const char *str);
+
+// Thời gian địa phương "YYYY-MM-DD HH:MM:SS.mmm" (có ngoặc kép) của wall_us (us kể từ epoch)
+void json_writer_local_time(json_writer_t *w, json_time_cache_t *cache, int64_t wall_us);
+
+// Kết thúc chuỗi bằng '\0'; trả về độ dài (không tính '\0'), 0 nếu tràn buffer
+size_t json_writer_finish(json_writer_t *w);
+
+#endif // JSON_WRITER_H
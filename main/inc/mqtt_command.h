@@ -0,0 +1,63 @@
+// inc/mqtt_command.h
+#ifndef MQTT_COMMAND_H
+#define MQTT_COMMAND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Giới hạn tĩnh của bộ điều phối: số lệnh, số nút trie (một nút mỗi cấp topic khác nhau),
+// độ dài tham số (payload) và độ sâu hàng đợi lệnh chạy trong command task
+#define MQTT_COMMAND_MAX        8
+#define MQTT_COMMAND_TRIE_NODES 16
+#define MQTT_COMMAND_ARG_MAX    32
+#define MQTT_COMMAND_QUEUE_LEN  4
+
+// Tham số là payload của message, đã kết thúc bằng '\0' (chuỗi rỗng nếu không có payload)
+typedef esp_err_t (*mqtt_command_handler_t)(const char *arg);
+
+typedef enum {
+    MQTT_COMMAND_INLINE = 0,    // Chạy ngay trong event task của MQTT client: chỉ việc ngắn, không chặn
+    MQTT_COMMAND_DEFERRED,      // Chép vào hàng đợi tĩnh, chạy trong mqtt_command_task
+} mqtt_command_mode_t;
+
+typedef struct {
+    uint32_t received;          // Message trên topic lệnh
+    uint32_t unknown;           // Topic không khớp lệnh nào
+    uint32_t rejected;          // Payload quá dài hoặc hàng đợi lệnh đầy
+    uint32_t deferred;          // Đã chuyển cho command task
+    uint32_t executed;          // Handler trả về ESP_OK
+    uint32_t failed;            // Handler trả về lỗi (tham số không hợp lệ, ...)
+} mqtt_command_stats_t;
+
+// Tạo hàng đợi lệnh (bộ nhớ tĩnh); gọi trước khi tạo mqtt_command_task và các task đăng ký lệnh
+esp_err_t mqtt_command_init(void);
+
+/**
+ * @brief Đăng ký handler cho một lệnh.
+ *
+ * path là phần topic sau MQTT_CMD_TOPIC "/", các cấp cách nhau bởi '/' (ví dụ
+ * "sensor/interval"), phải tồn tại suốt vòng đời chương trình (chuỗi hằng).
+ * Không cấp phát: nút trie và bảng lệnh lấy từ mảng tĩnh.
+ * @return ESP_ERR_NO_MEM nếu hết nút/lệnh, ESP_ERR_INVALID_STATE nếu path đã có handler.
+ */
+esp_err_t mqtt_command_register(const char *path, mqtt_command_handler_t handler, mqtt_command_mode_t mode);
+
+/**
+ * @brief Định tuyến một message đến handler (gọi từ MQTT_EVENT_DATA).
+ *
+ * topic/data không cần kết thúc bằng '\0'. Topic ngoài MQTT_CMD_TOPIC hoặc
+ * không khớp lệnh nào trả về ESP_ERR_NOT_FOUND.
+ */
+esp_err_t mqtt_command_dispatch(const char *topic, size_t topic_len, const char *data, size_t data_len);
+
+// Đọc số nguyên không dấu thập phân; ESP_ERR_INVALID_ARG nếu arg không phải số hoặc tràn
+esp_err_t mqtt_command_parse_u32(const char *arg, uint32_t *value);
+
+// Lấy bản sao thống kê (an toàn khi gọi từ task khác)
+void mqtt_command_get_stats(mqtt_command_stats_t *stats);
+
+// Task chạy các lệnh MQTT_COMMAND_DEFERRED theo thứ tự nhận
+void mqtt_command_task(void *pvParameters);
+
+#endif // MQTT_COMMAND_H
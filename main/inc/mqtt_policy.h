@@ -0,0 +1,68 @@
+// inc/mqtt_policy.h
+#ifndef MQTT_POLICY_H
+#define MQTT_POLICY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Số message QoS > 0 chờ PUBACK được theo dõi cùng lúc (để quy PUBACK / xóa khỏi outbox về đúng loại)
+#define MQTT_POLICY_TRACK_MAX 32
+
+// Loại message, mỗi loại một dòng trong APP_MQTT_POLICIES
+typedef enum {
+    MQTT_CLASS_TELEMETRY = 0,   // Mẫu trực tiếp
+    MQTT_CLASS_REPLAY,          // Mẫu gửi lại từ log flash
+    MQTT_CLASS_ALERT,           // Cảnh báo (mẫu outlier)
+    MQTT_CLASS_STATUS,          // Trạng thái online/offline của thiết bị, cùng topic với LWT
+    MQTT_CLASS_MAX,
+} mqtt_class_t;
+
+typedef struct {
+    uint8_t qos;
+    bool retain;
+    uint32_t ttl_ms;            // Tuổi tối đa của dữ liệu khi giao cho MQTT client; 0: không hết hạn
+    bool use_reserve;           // Được dùng phần outbox dự phòng APP_MQTT_OUTBOX_RESERVE
+} mqtt_policy_t;
+
+typedef struct {
+    uint32_t published;         // Số message đã giao cho MQTT client
+    uint32_t bytes;
+    uint32_t acked;             // Số PUBACK nhận được (QoS > 0)
+    uint32_t expired;           // Quá TTL: trước khi publish (không giao cho client) hoặc khi còn chờ PUBACK
+    uint32_t rejected;          // Outbox chạm hạn mức, không giao; người gọi giữ lại (log flash / hàng chờ cảnh báo)
+    uint32_t deleted;           // Client xóa khỏi outbox vì chờ PUBACK quá lâu (MQTT_EVENT_DELETED)
+    uint32_t in_flight;         // Đang chờ PUBACK
+    uint32_t in_flight_bytes;
+} mqtt_class_stats_t;
+
+const mqtt_policy_t *mqtt_policy_get(mqtt_class_t cls);
+
+const char *mqtt_class_to_string(mqtt_class_t cls);
+
+/**
+ * @brief Quyết định có giao một message cho MQTT client hay không.
+ *
+ * Dữ liệu quá TTL của loại bị loại trước tiên (ESP_ERR_TIMEOUT). Message QoS > 0
+ * chỉ được nhận khi outbox còn chỗ: loại thường dừng ở APP_MQTT_OUTBOX_LIMIT trừ
+ * phần dự phòng, loại use_reserve được dùng đến APP_MQTT_OUTBOX_LIMIT (ESP_ERR_NO_MEM).
+ * Trước khi so hạn mức, các message đang chờ PUBACK đã quá TTL của loại được bỏ
+ * theo dõi và tính vào expired. QoS 0 không nằm lại trong outbox nên không bị giới hạn.
+ *
+ * @param age_ms Tuổi của dữ liệu cũ nhất trong message.
+ * @param outbox_bytes esp_mqtt_client_get_outbox_size() hiện tại.
+ */
+esp_err_t mqtt_policy_admit(mqtt_class_t cls, uint32_t age_ms, size_t outbox_bytes, size_t len);
+
+// Gọi khi esp_mqtt_client_publish thành công; msg_id > 0 được theo dõi đến khi có PUBACK
+void mqtt_policy_on_published(mqtt_class_t cls, int msg_id, size_t len);
+
+// MQTT_EVENT_PUBLISHED / MQTT_EVENT_DELETED (gọi từ event handler của MQTT client)
+void mqtt_policy_on_acked(int msg_id);
+void mqtt_policy_on_deleted(int msg_id);
+
+// Lấy bản sao thống kê của một loại (an toàn khi gọi từ task khác)
+void mqtt_policy_get_stats(mqtt_class_t cls, mqtt_class_stats_t *stats);
+
+#endif // MQTT_POLICY_H
@@ -0,0 +1,71 @@
+// inc/pipeline_stats.h
+#ifndef PIPELINE_STATS_H
+#define PIPELINE_STATS_H
+
+#include <stdint.h>
+
+// Số bucket của histogram: bucket i chứa giá trị trong [2^i, 2^(i+1)) us (bucket 0: 0..1 us),
+// bucket cuối chứa mọi giá trị >= 2^(PIPELINE_HIST_BUCKETS - 1) us (~8.4 s)
+#define PIPELINE_HIST_BUCKETS 24
+
+// Các tầng của đường đi một mẫu, mỗi tầng tính từ mốc kết thúc của tầng trước
+typedef enum {
+    PIPELINE_STAGE_READ = 0,    // Bắt đầu đọc -> driver có kết quả
+    PIPELINE_STAGE_PROCESS,     // Có kết quả -> phát lên sample bus (lọc, kiểm tra, log)
+    PIPELINE_STAGE_QUEUE,       // Phát lên bus -> mqtt_task nhận
+    PIPELINE_STAGE_PUBLISH,     // mqtt_task nhận -> esp_mqtt_client_publish trả về
+    PIPELINE_STAGE_TOTAL,       // Bắt đầu đọc -> esp_mqtt_client_publish trả về
+    PIPELINE_STAGE_MAX,
+} pipeline_stage_t;
+
+// Bộ đếm mẫu không đi hết đường ống
+typedef enum {
+    PIPELINE_DROP_REJECTED = 0, // Ngoài dải hợp lệ, bị sensor_task loại
+    PIPELINE_DROP_BUS,          // sample_bus_publish thất bại
+    PIPELINE_DROP_UNCHANGED,    // Không đổi sau lọc, mqtt_task bỏ qua cho đến heartbeat
+    PIPELINE_DROP_PUBLISH,      // Publish thất bại (lỗi, outbox đầy, quá TTL) và không lưu được vào log flash
+    PIPELINE_DROP_OFFLINE,      // Mất kết nối và không lưu được vào log flash
+    PIPELINE_DROP_MAX,
+} pipeline_drop_t;
+
+// Mức đầy của các hàng đợi phía sau sample bus (mức của từng subscriber bus nằm trong sample_bus_stats_t)
+typedef enum {
+    PIPELINE_GAUGE_MQTT_OUTBOX = 0, // Byte trong outbox của MQTT client
+    PIPELINE_GAUGE_LOG_PENDING,     // Bản ghi chờ gửi lại trong log flash
+    PIPELINE_GAUGE_MAX,
+} pipeline_gauge_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[PIPELINE_HIST_BUCKETS];
+} pipeline_hist_t;
+
+typedef struct {
+    uint32_t last;
+    uint32_t high_water;
+} pipeline_gauge_value_t;
+
+// Ghi nhận thời gian của một tầng, O(1)
+void pipeline_stats_record(pipeline_stage_t stage, uint32_t us);
+
+void pipeline_stats_count_drop(pipeline_drop_t drop);
+
+void pipeline_stats_set_gauge(pipeline_gauge_t gauge, uint32_t value);
+
+// Lấy bản sao histogram / bộ đếm (an toàn khi gọi từ task khác)
+void pipeline_stats_get_hist(pipeline_stage_t stage, pipeline_hist_t *hist);
+uint32_t pipeline_stats_get_drops(pipeline_drop_t drop);
+void pipeline_stats_get_gauge(pipeline_gauge_t gauge, pipeline_gauge_value_t *value);
+
+// Cận trên (us) của bucket chứa phân vị percent (1..100); 0 nếu histogram rỗng
+uint32_t pipeline_hist_percentile(const pipeline_hist_t *hist, uint8_t percent);
+
+const char *pipeline_stage_to_string(pipeline_stage_t stage);
+const char *pipeline_drop_to_string(pipeline_drop_t drop);
+
+// In histogram từng tầng, bộ đếm bỏ mẫu và mức đầy hàng đợi (system_monitor_task)
+void pipeline_stats_print(void);
+
+#endif // PIPELINE_STATS_H
@@ -0,0 +1,75 @@
+// inc/sample_bus.h
+#ifndef SAMPLE_BUS_H
+#define SAMPLE_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "inc/sensor_sample.h"
+
+// Số slot dùng chung; độ sâu của mỗi subscriber không được vượt quá giá trị này
+#define SAMPLE_BUS_SLOTS 16
+
+// Số subscriber tối đa (MQTT, LCD, lưu trữ, phân tích)
+#define SAMPLE_BUS_MAX_SUBSCRIBERS 4
+
+// Bit thông báo (task notification) dùng để đánh thức subscriber khi có mẫu mới
+#define SAMPLE_BUS_NOTIFY_BIT (1u << 0)
+
+// Cách xử lý khi ring của subscriber đầy; producer không bao giờ bị chặn
+typedef enum {
+    SAMPLE_BUS_DROP_NEWEST = 0, // Bỏ mẫu mới
+    SAMPLE_BUS_DROP_OLDEST,     // Ghi đè mẫu cũ nhất chưa đọc (độ sâu 1 = luôn giữ mẫu mới nhất)
+} sample_bus_overflow_t;
+
+// Thống kê của một subscriber
+typedef struct {
+    const char *name;
+    uint8_t depth;
+    uint32_t delivered;     // Số mẫu subscriber đã nhận
+    uint32_t dropped;       // Số mẫu bị bỏ do ring đầy
+    uint32_t overruns;      // Số mẫu bị slot mới ghi đè trước khi subscriber kịp đọc
+    uint32_t high_water;    // Số mẫu chờ lớn nhất từng thấy
+    uint32_t wakeups;       // Số lần nhận được ít nhất một mẫu (delivered / wakeups = mẫu mỗi lần thức)
+} sample_bus_stats_t;
+
+typedef struct sample_bus_sub *sample_bus_sub_t;
+
+// Khởi tạo bus, gọi một lần trong app_main trước khi tạo các task
+void sample_bus_init(void);
+
+/**
+ * @brief Đăng ký một subscriber mới.
+ *
+ * Mỗi subscriber có ring riêng chỉ chứa số thứ tự slot (4 byte), còn mẫu
+ * nằm trong vùng slot dùng chung nên producer chỉ chép mẫu một lần. Task gọi
+ * hàm này là task được đánh thức (SAMPLE_BUS_NOTIFY_BIT) khi có mẫu mới.
+ *
+ * @param name Tên hiển thị (phải tồn tại suốt đời chương trình).
+ * @param depth Độ sâu ring, 1..SAMPLE_BUS_SLOTS.
+ * @return Handle, NULL nếu hết chỗ hoặc tham số sai.
+ */
+sample_bus_sub_t sample_bus_subscribe(const char *name, uint8_t depth, sample_bus_overflow_t policy);
+
+// Phát một mẫu đến mọi subscriber. Chỉ gọi từ một task (task cảm biến).
+esp_err_t sample_bus_publish(const sensor_sample_t *sample);
+
+// Nhận mẫu kế tiếp của subscriber; ESP_ERR_TIMEOUT nếu không có mẫu trong timeout
+esp_err_t sample_bus_receive(sample_bus_sub_t sub, sensor_sample_t *sample, TickType_t timeout);
+
+/**
+ * @brief Lấy một lần tối đa max mẫu đang chờ, theo thứ tự cũ đến mới.
+ *
+ * Chỉ ngủ khi ring rỗng, tối đa timeout tick. Chỉ gọi từ task đã đăng ký.
+ * @return Số mẫu đã chép vào samples, 0 nếu hết thời gian chờ.
+ */
+size_t sample_bus_receive_batch(sample_bus_sub_t sub, sensor_sample_t *samples, size_t max, TickType_t timeout);
+
+// Số subscriber đã đăng ký
+size_t sample_bus_subscriber_count(void);
+
+// Thống kê của subscriber thứ index
+esp_err_t sample_bus_get_stats(size_t index, sample_bus_stats_t *stats);
+
+#endif // SAMPLE_BUS_H
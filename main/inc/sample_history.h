@@ -0,0 +1,108 @@
+// inc/sample_history.h
+#ifndef SAMPLE_HISTORY_H
+#define SAMPLE_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <time.h>
+#include "inc/sensor_sample.h"
+
+// Lọc theo mọi cảm biến trong các hàm truy vấn
+#define SAMPLE_HISTORY_ALL_SENSORS 0xFF
+
+// Đồng hồ hệ thống trước mốc này (2024-01-01 UTC) coi như chưa được NTP đồng bộ
+#define SAMPLE_HISTORY_MIN_VALID_TIME 1704067200
+
+// Độ phân giải của bản tổng hợp
+typedef enum {
+    SAMPLE_HISTORY_MINUTE = 0,
+    SAMPLE_HISTORY_HOUR,
+    SAMPLE_HISTORY_RES_MAX,
+} sample_history_res_t;
+
+// Một mẫu thô đã lưu; thời gian là giây UTC (wall-clock)
+typedef struct {
+    uint32_t time_s;
+    int16_t temperature;    // Độ C * 10
+    int16_t humidity;       // % * 10
+    uint8_t sensor_id;
+    uint8_t flags;          // SENSOR_FLAG_*
+} sample_history_raw_t;
+
+// Min/max/tổng của một cảm biến trong một phút hoặc một giờ; trung bình = sum / count
+typedef struct {
+    uint32_t start_s;       // Đầu khoảng, giây UTC (wall-clock), mốc phút/giờ từ khi đồng hồ đồng bộ
+    int32_t temp_sum;
+    int32_t hum_sum;
+    int16_t temp_min, temp_max;
+    int16_t hum_min, hum_max;
+    uint16_t count;
+    uint8_t sensor_id;
+} sample_history_rollup_t;
+
+typedef struct {
+    uint32_t raw_count, raw_capacity;   // Tổng trên mọi cảm biến
+    uint32_t rollup_count[SAMPLE_HISTORY_RES_MAX];
+    uint32_t rollup_capacity[SAMPLE_HISTORY_RES_MAX];
+    uint32_t raw_span_s;    // Khoảng thời gian mẫu thô còn giữ, ngắn nhất trong các cảm biến có dữ liệu
+    uint32_t added;         // Tổng số mẫu đã nhận
+    uint32_t evicted;       // Số mẫu thô đã bị ghi đè
+    size_t ram_bytes;       // Bộ nhớ tĩnh của toàn bộ kho
+} sample_history_stats_t;
+
+// Khởi tạo kho (gọi một lần trong app_main, trước khi các task chạy)
+void sample_history_init(void);
+
+/**
+ * @brief Thêm một mẫu, O(1).
+ *
+ * Mỗi cảm biến (sensor_id < APP_HISTORY_SENSORS) có ring mẫu thô và ring tổng
+ * hợp phút/giờ riêng, nên một đầu đo đọc dày không đẩy lịch sử của đầu đo
+ * khác ra khỏi ring. Khi sang phút/giờ mới, khoảng đang mở của cảm biến được
+ * đóng và đẩy vào ring tổng hợp tương ứng.
+ */
+void sample_history_add(const sensor_sample_t *sample);
+
+// Thời điểm hiện tại (giây UTC), false nếu đồng hồ chưa được đồng bộ
+bool sample_history_now(time_t *now);
+
+/**
+ * @brief Lấy các mẫu thô có from <= thời điểm <= to (giây UTC).
+ *
+ * Kho lưu thời gian theo esp_timer (đơn điệu) và đổi sang wall-clock bằng độ
+ * lệch hiện tại của đồng hồ hệ thống, nên chỉnh giờ không làm hỏng thứ tự.
+ * Vị trí bắt đầu được tìm bằng tìm kiếm nhị phân trên ring. Kết quả theo từng
+ * cảm biến, trong mỗi cảm biến cũ trước mới sau.
+ *
+ * @param sensor_id Chỉ số cảm biến hoặc SAMPLE_HISTORY_ALL_SENSORS.
+ * @return Số mẫu đã chép vào out (tối đa max); 0 khi đồng hồ chưa đồng bộ.
+ */
+size_t sample_history_query_raw(uint8_t sensor_id, time_t from, time_t to,
+                                sample_history_raw_t *out, size_t max);
+
+/**
+ * @brief Lấy các bản tổng hợp giao với [from, to] (giây UTC).
+ *
+ * Từ khi đồng hồ được đồng bộ, khoảng bắt đầu ở mốc phút/giờ UTC (start_s chia
+ * hết cho 60/3600). Các khoảng đóng trước đó được chia theo thời gian khởi động;
+ * khoảng đang mở lúc đồng bộ kéo dài đến mốc wall-clock đầu tiên cách nó ít nhất
+ * một phút/giờ (dài hơn bình thường, không chồng lên khoảng sau). Khoảng đang mở
+ * (chưa đủ dữ liệu) của mỗi cảm biến nằm sau cùng trong phần của cảm biến đó.
+ * @return Số bản ghi đã chép vào out (tối đa max); 0 khi đồng hồ chưa đồng bộ.
+ */
+size_t sample_history_query_rollup(sample_history_res_t res, uint8_t sensor_id, time_t from, time_t to,
+                                   sample_history_rollup_t *out, size_t max);
+
+/**
+ * @brief Gộp các bản tổng hợp phút giao với [from, to] thành một bản ghi.
+ *
+ * O(số phút trong khoảng), không chép mẫu thô.
+ * @return false nếu không có dữ liệu hoặc đồng hồ chưa đồng bộ.
+ */
+bool sample_history_summarize(uint8_t sensor_id, time_t from, time_t to, sample_history_rollup_t *out);
+
+// Lấy bản sao thống kê kho (an toàn khi gọi từ task khác)
+void sample_history_get_stats(sample_history_stats_t *stats);
+
+#endif // SAMPLE_HISTORY_H
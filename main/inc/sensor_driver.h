@@ -0,0 +1,69 @@
+// inc/sensor_driver.h
+#ifndef SENSOR_DRIVER_H
+#define SENSOR_DRIVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "dht.h"
+
+// Loại cảm biến được hỗ trợ
+typedef enum {
+    SENSOR_KIND_DHT11 = 0,  // 1 dây, zorxx/dht
+    SENSOR_KIND_AM2301,     // 1 dây, zorxx/dht (DHT21/DHT22/AM2302)
+    SENSOR_KIND_SI7021,     // 1 dây, zorxx/dht (module Itead Si7021)
+    SENSOR_KIND_SHT3X,      // I2C, dùng chung bus với LCD
+    SENSOR_KIND_MAX
+} sensor_kind_t;
+
+// Cấu hình một đầu đo
+typedef struct {
+    sensor_kind_t kind;
+    gpio_num_t pin;         // Chân dữ liệu của cảm biến 1 dây, GPIO_NUM_NC với cảm biến I2C
+    uint8_t i2c_address;    // Địa chỉ 7 bit của cảm biến I2C, 0 với cảm biến 1 dây
+} sensor_probe_t;
+
+// Kết quả một phép đo
+typedef struct {
+    esp_err_t result;       // ESP_OK hoặc mã lỗi
+    dht_fault_t fault;      // Loại lỗi khi result != ESP_OK (dùng chung bảng lỗi với DHT)
+    int16_t temperature;    // Nhiệt độ, độ C * 10
+    int16_t humidity;       // Độ ẩm, % * 10
+    int64_t timestamp_us;   // Thời điểm bắt đầu đo (esp_timer), us
+    int64_t done_us;        // Thời điểm có kết quả (esp_timer), us
+} sensor_reading_t;
+
+// Trạng thái riêng của driver cho một đầu đo, do bộ lập lịch giữ
+typedef struct {
+    void *handle;               // Tài nguyên của driver (vd. handle thiết bị I2C)
+    TaskHandle_t notify_task;   // Task được đánh thức khi driver có kết quả sớm
+    volatile bool ready;        // Driver đã điền xong reading
+    sensor_reading_t reading;   // Kết quả do driver điền bất đồng bộ
+} sensor_driver_ctx_t;
+
+/**
+ * @brief Bảng hàm của một driver cảm biến.
+ *
+ * Một lần đọc gồm trigger() rồi read(). trigger() chỉ bắt đầu phép đo và trả
+ * về thời gian chờ tối đa; trong thời gian đó bus được nhả cho thiết bị khác
+ * (LCD). Driver có kết quả sớm (vd. DHT qua RMT) đánh thức notify_task bằng
+ * xTaskNotifyGive(). Sau đó read() lấy kết quả. Mọi hàm chạy trong task quét.
+ */
+typedef struct {
+    const char *name;
+    esp_err_t (*init)(const sensor_probe_t *probe, sensor_driver_ctx_t *ctx);
+    esp_err_t (*trigger)(const sensor_probe_t *probe, sensor_driver_ctx_t *ctx, uint32_t *wait_ms);
+    esp_err_t (*read)(const sensor_probe_t *probe, sensor_driver_ctx_t *ctx, sensor_reading_t *reading);
+    uint32_t (*min_interval_ms)(const sensor_probe_t *probe);
+} sensor_driver_t;
+
+extern const sensor_driver_t sensor_driver_dht;
+extern const sensor_driver_t sensor_driver_sht3x;
+
+// Driver ứng với loại cảm biến, NULL nếu không hỗ trợ
+const sensor_driver_t *sensor_driver_get(sensor_kind_t kind);
+
+#endif // SENSOR_DRIVER_H
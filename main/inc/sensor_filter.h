@@ -0,0 +1,63 @@
+// inc/sensor_filter.h
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/sensor_sample.h"
+
+// Độ dài cửa sổ median trượt (số lẻ)
+#define SENSOR_FILTER_MEDIAN_WINDOW 5
+
+// Tầng làm mượt sau median
+typedef enum {
+    SENSOR_FILTER_NONE = 0,     // Chỉ median
+    SENSOR_FILTER_EWMA,         // Trung bình trượt hàm mũ, alpha = 1 / 2^ewma_shift
+    SENSOR_FILTER_KALMAN,       // Kalman 1-D (mô hình hằng số + nhiễu quá trình)
+} sensor_filter_mode_t;
+
+// Cấu hình bộ lọc, mọi giá trị theo đơn vị 0.1 (độ C * 10, % * 10)
+typedef struct {
+    sensor_filter_mode_t mode;
+    uint8_t ewma_shift;         // 1..8
+    int32_t kalman_q;           // Nhiễu quá trình, (0.1)^2 mỗi mẫu
+    int32_t kalman_r;           // Nhiễu đo, (0.1)^2
+    int16_t temp_outlier;       // Ngưỡng lệch so với median để gắn cờ outlier
+    int16_t hum_outlier;
+    int16_t temp_min, temp_max; // Dải hợp lệ
+    int16_t hum_min, hum_max;
+} sensor_filter_config_t;
+
+// Trạng thái lọc của một kênh (nhiệt độ hoặc độ ẩm)
+typedef struct {
+    int16_t window[SENSOR_FILTER_MEDIAN_WINDOW];
+    uint8_t count;              // Số phần tử hợp lệ trong window
+    uint8_t pos;                // Vị trí ghi kế tiếp
+    bool primed;                // Đã có ước lượng ban đầu
+    int32_t estimate_q8;        // Ước lượng hiện tại, Q8 (đơn vị 0.1 * 256)
+    int32_t variance_q8;        // Phương sai ước lượng của Kalman, Q8
+    int16_t last_output;
+} sensor_filter_channel_t;
+
+// Trạng thái lọc của một cảm biến
+typedef struct {
+    const sensor_filter_config_t *config;
+    sensor_filter_channel_t temperature;
+    sensor_filter_channel_t humidity;
+} sensor_filter_t;
+
+// Khởi tạo trạng thái lọc; config phải tồn tại suốt vòng đời bộ lọc
+void sensor_filter_init(sensor_filter_t *filter, const sensor_filter_config_t *config);
+
+/**
+ * @brief Lọc một mẫu mới của cảm biến.
+ *
+ * Chỉ dùng số nguyên. Giá trị ngoài dải bị loại (không cập nhật trạng thái,
+ * giữ nguyên giá trị vào) và trả về SENSOR_FLAG_OUT_OF_RANGE. Ngược lại
+ * temperature/humidity được thay bằng giá trị đã lọc.
+ *
+ * @return Tổ hợp các cờ SENSOR_FLAG_*.
+ */
+uint8_t sensor_filter_apply(sensor_filter_t *filter, int16_t *temperature, int16_t *humidity);
+
+#endif // SENSOR_FILTER_H
@@ -0,0 +1,70 @@
+// inc/sensor_sample.h
+#ifndef SENSOR_SAMPLE_H
+#define SENSOR_SAMPLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Cờ chất lượng gắn theo từng mẫu
+#define SENSOR_FLAG_FILTERED     (1u << 0) // Giá trị đã qua median + làm mượt
+#define SENSOR_FLAG_OUTLIER      (1u << 1) // Giá trị thô lệch xa median, đã bị median thay thế
+#define SENSOR_FLAG_OUT_OF_RANGE (1u << 2) // Ngoài dải vật lý của cảm biến, bị loại và không được gửi đi
+#define SENSOR_FLAG_WARMUP       (1u << 3) // Cửa sổ median chưa đầy, bộ lọc chưa ổn định
+#define SENSOR_FLAG_UNCHANGED    (1u << 4) // Giá trị sau lọc trùng giá trị trước, có thể bỏ qua khi publish
+
+// Các cờ khiến mẫu không được dùng
+#define SENSOR_FLAG_REJECTED     (SENSOR_FLAG_OUT_OF_RANGE)
+
+// Mẫu cảm biến dùng chung cho mọi task (hàng đợi, MQTT, LCD), giá trị số nguyên đơn vị 0.1
+typedef struct {
+    int16_t temperature;    // Nhiệt độ, độ C * 10
+    int16_t humidity;       // Độ ẩm, % * 10
+    uint8_t sensor_id;      // Chỉ số cảm biến trong bộ
+    uint8_t flags;          // Cờ chất lượng SENSOR_FLAG_*
+    uint32_t seq;           // Số thứ tự mẫu, tăng dần, dùng để phát hiện mẫu bị mất
+    int64_t timestamp_us;   // Thời điểm lấy mẫu (esp_timer), us
+    uint32_t ready_us;      // Mốc từng tầng, tính từ timestamp_us: driver có kết quả
+    uint32_t bus_us;        // ... mẫu được phát lên sample bus (0 với mẫu đọc lại từ log flash)
+} sensor_sample_t;
+
+// Độ trễ từ lúc lấy mẫu đến lúc publish
+typedef struct {
+    uint32_t samples;       // Số mẫu đã publish
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} sensor_latency_stats_t;
+
+// Độ dài tối đa của một giá trị 0.1 khi định dạng ("-3276.8" + '\0')
+#define SENSOR_TENTHS_STR_LEN 8
+
+// In giá trị 0.1 bằng printf mà không dùng float: printf("T=" SENSOR_TENTHS_FMT, SENSOR_TENTHS_ARGS(t))
+#define SENSOR_TENTHS_FMT "%s%d.%d"
+#define SENSOR_TENTHS_ARGS(tenths) ((tenths) < 0 ? "-" : ""), \
+    (int)(((tenths) < 0 ? -(int32_t)(tenths) : (int32_t)(tenths)) / 10), \
+    (int)(((tenths) < 0 ? -(int32_t)(tenths) : (int32_t)(tenths)) % 10)
+
+/**
+ * @brief Định dạng giá trị 0.1 thành chuỗi thập phân một chữ số lẻ ("25.3", "-0.5").
+ *
+ * Chỉ dùng số nguyên, không gọi printf.
+ * @return Số ký tự đã ghi (không tính '\0'), 0 nếu buffer không đủ.
+ */
+size_t sensor_sample_format_tenths(char *buf, size_t size, int16_t tenths);
+
+/**
+ * @brief Đổi thời điểm lấy mẫu (esp_timer) sang thời gian thực (us kể từ epoch).
+ *
+ * Lấy độ lệch giữa đồng hồ hệ thống và esp_timer tại thời điểm gọi, nên mẫu
+ * nằm chờ trong hàng đợi vẫn mang đúng thời điểm đo. Chỉ có nghĩa sau khi SNTP
+ * đã đồng bộ.
+ */
+int64_t sensor_sample_wallclock_us(const sensor_sample_t *sample);
+
+// Ghi nhận độ trễ lấy mẫu -> publish của một mẫu, gọi ngay khi publish thành công
+void sensor_sample_record_latency(const sensor_sample_t *sample);
+
+// Lấy bản sao thống kê độ trễ (an toàn khi gọi từ task khác)
+void sensor_sample_get_latency_stats(sensor_latency_stats_t *stats);
+
+#endif // SENSOR_SAMPLE_H
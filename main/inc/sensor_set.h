@@ -0,0 +1,122 @@
+// inc/sensor_set.h
+#ifndef SENSOR_SET_H
+#define SENSOR_SET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "inc/sensor_driver.h"
+
+// Số cảm biến tối đa trong một bộ (mỗi tủ có 4-8 đầu đo)
+#define SENSOR_SET_MAX_SENSORS 8
+
+// Khoảng cách tối thiểu giữa hai lần đọc liên tiếp (một lần đọc DHT ~30 ms, SHT3x ~16 ms)
+#define SENSOR_SET_MIN_SLOT_MS 50
+
+// Số lần thử lại tối đa trong một lượt quét khi đọc lỗi (mỗi lần cách khoảng nghỉ tối thiểu)
+#define SENSOR_SET_MAX_RETRIES 2
+
+// result của cảm biến bị bỏ qua vì chưa đủ khoảng nghỉ tối thiểu. Mã riêng ngoài dải mã của
+// ESP-IDF, không lẫn với ESP_ERR_INVALID_STATE mà dht_read_async() trả về khi backend RMT còn bận
+// (lỗi driver thật, được đếm vào DHT_FAULT_DRIVER và được thử lại).
+#define SENSOR_SET_ERR_BASE     0x10000
+#define SENSOR_SET_ERR_SKIPPED  (SENSOR_SET_ERR_BASE + 1)
+
+// Kết quả đọc của một cảm biến trong một lượt quét
+typedef struct {
+    uint8_t sensor_id;      // Chỉ số cảm biến trong bộ (0..count-1)
+    esp_err_t result;       // ESP_OK, mã lỗi đọc, hoặc SENSOR_SET_ERR_SKIPPED nếu bỏ qua vì chưa đủ khoảng nghỉ tối thiểu
+    int16_t temperature;    // Nhiệt độ, độ C * 10
+    int16_t humidity;       // Độ ẩm, % * 10
+    int64_t timestamp_us;   // Thời điểm bắt đầu đọc (esp_timer), us
+    uint32_t read_us;       // Từ lúc bắt đầu đọc đến khi driver có kết quả, us
+    dht_fault_t fault;      // Loại lỗi của lần đọc cuối khi result != ESP_OK
+    uint8_t flags;          // Cờ chất lượng SENSOR_FLAG_* (inc/sensor_sample.h), 0 khi chưa lọc
+} sensor_set_sample_t;
+
+// Thống kê của một cảm biến, đọc được khi đang chạy
+typedef struct {
+    uint32_t reads;                 // Số lần đọc thực sự (kể cả thử lại)
+    uint32_t successes;             // Số lần đọc thành công
+    uint32_t retries;               // Số lần thử lại sau lỗi
+    uint32_t skipped;               // Số lần bỏ qua vì chưa đủ khoảng nghỉ tối thiểu
+    uint32_t faults[DHT_FAULT_MAX]; // Số lần lỗi theo từng loại
+    uint32_t last_latency_us;       // Thời gian của lần đọc gần nhất (từ lúc bắt đầu đến khi có kết quả)
+    uint32_t max_latency_us;
+    uint64_t total_latency_us;
+    int64_t last_success_us;        // Thời điểm đọc thành công gần nhất (esp_timer), 0 nếu chưa có
+} sensor_set_stats_t;
+
+// Độ lệch thời điểm thức dậy đầu lượt quét so với lịch (jitter chu kỳ)
+typedef struct {
+    uint32_t sweeps;                // Số khoảng giữa hai lượt quét đã đo
+    uint32_t last_jitter_us;
+    uint32_t max_jitter_us;
+    uint64_t total_jitter_us;
+} sensor_set_timing_stats_t;
+
+// Lô mẫu của một lượt quét, mỗi cảm biến đúng một phần tử
+typedef struct {
+    uint32_t sweep;         // Số thứ tự lượt quét
+    uint8_t count;          // Số phần tử hợp lệ trong samples[]
+    sensor_set_sample_t samples[SENSOR_SET_MAX_SENSORS];
+} sensor_batch_t;
+
+/**
+ * @brief Khởi tạo bộ cảm biến.
+ *
+ * Mỗi cảm biến được gán một pha riêng trong chu kỳ quét (period_ms / count),
+ * nên các lần đọc không bao giờ chồng lên nhau. Cấu hình một chân duy nhất
+ * là trường hợp đặc biệt với count = 1.
+ *
+ * Driver của từng đầu đo (inc/sensor_driver.h) được khởi tạo tại đây.
+ *
+ * @param probes Danh sách đầu đo (được sao chép).
+ * @param count Số đầu đo, 1..SENSOR_SET_MAX_SENSORS.
+ * @param period_ms Chu kỳ quét toàn bộ các cảm biến.
+ */
+esp_err_t sensor_set_init(const sensor_probe_t *probes, size_t count, uint32_t period_ms);
+
+/**
+ * @brief Thực hiện một lượt quét.
+ *
+ * Chờ đến pha của từng cảm biến, đọc nó (không đọc lại trước khoảng nghỉ tối
+ * thiểu của loại cảm biến), thử lại lần đọc lỗi nếu kịp trước pha của cảm biến
+ * kế tiếp, và trả về toàn bộ kết quả trong một lô. Lượt quét
+ * kế tiếp bắt đầu đúng một chu kỳ sau lượt trước, không bị trôi theo thời
+ * gian đọc. Chỉ được gọi từ một task.
+ */
+esp_err_t sensor_set_sweep(sensor_batch_t *batch);
+
+/**
+ * @brief Đổi chu kỳ quét.
+ *
+ * Lượt kế tiếp được lên lịch lại tại (đầu lượt trước + chu kỳ mới), pha của
+ * các cảm biến được chia lại theo chu kỳ mới. Chỉ gọi từ task thực hiện quét.
+ */
+void sensor_set_set_period(uint32_t period_ms);
+
+// Chu kỳ quét hiện tại (ms)
+uint32_t sensor_set_get_period_ms(void);
+
+// Chu kỳ cố định đặt từ xa (lệnh MQTT), được task quét dùng thay chu kỳ thích ứng; 0: bỏ ghi đè.
+// An toàn khi gọi từ task khác.
+void sensor_set_set_period_override(uint32_t period_ms);
+uint32_t sensor_set_get_period_override(void);
+
+// Số cảm biến trong bộ
+size_t sensor_set_count(void);
+
+// Cấu hình đầu đo theo chỉ số, NULL nếu không tồn tại
+const sensor_probe_t *sensor_set_get_probe(uint8_t sensor_id);
+
+// Lấy bản sao thống kê của một cảm biến (an toàn khi gọi từ task khác)
+esp_err_t sensor_set_get_stats(uint8_t sensor_id, sensor_set_stats_t *stats);
+
+// Lấy bản sao thống kê jitter chu kỳ quét (an toàn khi gọi từ task khác)
+esp_err_t sensor_set_get_timing_stats(sensor_set_timing_stats_t *stats);
+
+// Khoảng nghỉ tối thiểu giữa hai lần đọc của một cảm biến (ms), 0 nếu không tồn tại
+uint32_t sensor_set_min_interval_ms(uint8_t sensor_id);
+
+#endif // SENSOR_SET_H
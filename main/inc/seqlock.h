@@ -0,0 +1,47 @@
+// inc/seqlock.h
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+
+/**
+ * Seqlock một writer, nhiều reader cho các bản ghi trạng thái nhỏ (vài chục byte).
+ *
+ * Reader không bao giờ bị chặn: chép dữ liệu rồi kiểm tra số thứ tự, chép lại
+ * nếu writer đã ghi chen vào giữa. Writer giữ một portMUX trong lúc chép (vài
+ * trăm ns), nên không bị task khác chiếm CPU giữa chừng và reader cùng core
+ * không phải chờ một writer đang bị treo.
+ */
+typedef struct {
+    atomic_uint_fast32_t seq;   // Lẻ khi đang ghi
+    portMUX_TYPE writer_mux;
+    atomic_uint_fast32_t reads;
+    atomic_uint_fast32_t retries; // Số lần reader phải chép lại vì đụng writer
+    atomic_uint_fast32_t writes;
+} seqlock_t;
+
+// Thống kê tranh chấp của một seqlock
+typedef struct {
+    uint32_t reads;
+    uint32_t retries;
+    uint32_t writes;
+} seqlock_stats_t;
+
+#define SEQLOCK_INITIALIZER { .seq = 0, .writer_mux = portMUX_INITIALIZER_UNLOCKED, \
+                              .reads = 0, .retries = 0, .writes = 0 }
+
+// Khởi tạo seqlock lúc chạy (tương đương SEQLOCK_INITIALIZER, dùng cho mảng)
+void seqlock_init(seqlock_t *lock);
+
+// Ghi size byte từ src vào dữ liệu được bảo vệ dst
+void seqlock_write(seqlock_t *lock, void *dst, const void *src, size_t size);
+
+// Chép nhất quán size byte của dữ liệu được bảo vệ src vào dst, không chặn
+void seqlock_read(seqlock_t *lock, void *dst, const void *src, size_t size);
+
+void seqlock_get_stats(seqlock_t *lock, seqlock_stats_t *stats);
+
+#endif // SEQLOCK_H
@@ -0,0 +1,63 @@
+// inc/task_placement.h
+#ifndef TASK_PLACEMENT_H
+#define TASK_PLACEMENT_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+// Nhóm task theo yêu cầu thời gian thực; mỗi phương án gán một nhân cho từng nhóm
+typedef enum {
+    TASK_CLASS_NET = 0,     // WiFi, MQTT, NTP, OTA: chung nhân với stack WiFi/lwIP
+    TASK_CLASS_ACQ,         // Lấy mẫu cảm biến, nhạy với jitter
+    TASK_CLASS_UI,          // LCD (chờ I2C, không được chặn việc lấy mẫu)
+    TASK_CLASS_BACKGROUND,  // Giám sát, ưu tiên thấp
+    TASK_CLASS_MAX,
+} task_class_t;
+
+// Phương án phân bổ task lên hai nhân của ESP32 (APP_TASK_PLACEMENT trong app_config.h)
+typedef enum {
+    APP_PLACEMENT_FLOATING = 0, // Không ghim, scheduler tự chọn nhân (như trước)
+    APP_PLACEMENT_SPLIT,        // Mạng ở nhân 0; lấy mẫu + LCD ở nhân 1
+    APP_PLACEMENT_ACQ_ISOLATED, // Chỉ lấy mẫu ở nhân 1; mạng, LCD, giám sát ở nhân 0
+    APP_PLACEMENT_MAX,
+} task_placement_t;
+
+// Kết quả đo của một phương án
+typedef struct {
+    uint32_t sweeps;                // Số khoảng chu kỳ quét đã đo jitter
+    uint32_t avg_jitter_us;
+    uint32_t max_jitter_us;
+    uint32_t publishes;             // Số mẫu đã publish
+    uint32_t avg_latency_us;        // Độ trễ từ lúc đọc đến lúc publish
+    uint32_t max_latency_us;
+} task_placement_result_t;
+
+/**
+ * @brief Phương án dùng cho lần khởi động này.
+ *
+ * Bình thường là APP_TASK_PLACEMENT. Khi APP_PLACEMENT_BENCHMARK_MS > 0,
+ * lần lượt từng phương án được chạy qua các lần khởi động lại; khi đã đo
+ * xong tất cả thì quay về APP_TASK_PLACEMENT. Gọi trước khi tạo task.
+ */
+task_placement_t task_placement_active(void);
+
+// Nhân cho một nhóm task theo phương án đang dùng (0, 1 hoặc tskNO_AFFINITY)
+BaseType_t task_placement_core(task_class_t task_class);
+
+const char *task_placement_to_string(task_placement_t placement);
+
+// Đo jitter chu kỳ quét và độ trễ publish của phương án hiện tại
+void task_placement_measure(task_placement_result_t *result);
+
+/**
+ * @brief Gọi định kỳ (system_monitor_task).
+ *
+ * Ở chế độ benchmark, khi phương án hiện tại đã chạy đủ APP_PLACEMENT_BENCHMARK_MS
+ * thì lưu kết quả vào RTC RAM và khởi động lại với phương án kế tiếp.
+ */
+void task_placement_benchmark_poll(void);
+
+// In kết quả của phương án hiện tại và bảng so sánh benchmark (nếu đã có)
+void task_placement_print_report(void);
+
+#endif // TASK_PLACEMENT_H
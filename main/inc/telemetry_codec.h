@@ -0,0 +1,139 @@
+// inc/telemetry_codec.h
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "inc/sensor_sample.h"
+#include "inc/telemetry_log.h"
+
+// Phiên bản lược đồ lô, trường "v" của payload
+#define TELEMETRY_BATCH_SCHEMA_VERSION 1
+
+// Kích thước buffer đủ cho một lô n mẫu: phần đầu + mỗi hàng tối đa
+// [255,4294967295,-2147483648,-32768,-32768,255], (47 ký tự)
+#define TELEMETRY_CODEC_BATCH_HEADER_MAX 48
+#define TELEMETRY_CODEC_BATCH_ROW_MAX    48
+#define TELEMETRY_CODEC_BATCH_LEN(n)     (TELEMETRY_CODEC_BATCH_HEADER_MAX + (n) * TELEMETRY_CODEC_BATCH_ROW_MAX)
+
+// Kích thước buffer cho payload một mẫu
+#define TELEMETRY_CODEC_SAMPLE_LEN 220
+
+// Định dạng payload telemetry (APP_TELEMETRY_FORMAT)
+typedef enum {
+    TELEMETRY_FORMAT_JSON = 0,  // JSON: mỗi mẫu một object, hoặc mảng gọn khi APP_MQTT_BATCH_SIZE > 1
+    TELEMETRY_FORMAT_PACKED,    // Nhị phân: telemetry_packed_header_t + count * telemetry_packed_record_t
+} telemetry_format_t;
+
+// Byte đầu của payload nhị phân; JSON luôn bắt đầu bằng '{' (0x7B) nên bộ giải mã phân biệt được.
+// Đổi bố cục bản ghi thì tăng schema.
+#define TELEMETRY_PACKED_SCHEMA     0x01
+#define TELEMETRY_PACKED_FLAG_REPLAY (1u << 0) // Mẫu gửi lại từ log flash
+
+// Payload nhị phân, little-endian, không padding (tools/telemetry_decode.py giải mã)
+typedef struct __attribute__((packed)) {
+    uint8_t schema;         // TELEMETRY_PACKED_SCHEMA
+    uint8_t flags;          // TELEMETRY_PACKED_FLAG_*
+    uint8_t count;          // Số bản ghi theo sau
+    uint8_t reserved;
+    int64_t t0_ms;          // Thời gian thực của mẫu đầu, ms kể từ epoch
+} telemetry_packed_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t sensor_id;
+    uint8_t flags;          // SENSOR_FLAG_*
+    int16_t temperature;    // Độ C * 10
+    int16_t humidity;       // % * 10
+    uint32_t seq;
+    int32_t dt_ms;          // Thời điểm lấy mẫu so với t0_ms
+} telemetry_packed_record_t;
+
+_Static_assert(sizeof(telemetry_packed_header_t) == 12, "telemetry_packed_header_t must stay 12 bytes");
+_Static_assert(sizeof(telemetry_packed_record_t) == 14, "telemetry_packed_record_t must stay 14 bytes");
+
+#define TELEMETRY_CODEC_PACKED_LEN(n) (sizeof(telemetry_packed_header_t) + (n) * sizeof(telemetry_packed_record_t))
+
+// Buffer đủ cho n mẫu ở mọi định dạng
+#define TELEMETRY_CODEC_PAYLOAD_LEN(n) \
+    (TELEMETRY_CODEC_BATCH_LEN(n) > TELEMETRY_CODEC_SAMPLE_LEN ? TELEMETRY_CODEC_BATCH_LEN(n) : TELEMETRY_CODEC_SAMPLE_LEN)
+
+// Số mẫu mỗi lô trong benchmark mã hóa
+#define TELEMETRY_CODEC_BENCH_BATCH 8
+
+// Kết quả benchmark mã hóa: số chu kỳ CPU và số byte trung bình trên mỗi mẫu
+// (với JSON một mẫu, đó cũng là mỗi message)
+typedef struct {
+    uint32_t iterations;
+    uint32_t json_snprintf_cycles; // JSON một mẫu, bộ mã hóa cũ snprintf + localtime_r/strftime
+    uint32_t json_snprintf_bytes;
+    uint32_t json_cycles;       // JSON một mẫu, json_writer
+    uint32_t json_bytes;
+    uint32_t json_batch_cycles; // JSON mảng gọn, TELEMETRY_CODEC_BENCH_BATCH mẫu mỗi lô
+    uint32_t json_batch_bytes;
+    uint32_t packed_cycles;     // Nhị phân, TELEMETRY_CODEC_BENCH_BATCH mẫu mỗi lô
+    uint32_t packed_bytes;
+} telemetry_codec_bench_t;
+
+// Thống kê payload đã publish thành công (trực tiếp và gửi lại)
+typedef struct {
+    uint32_t messages;      // Số lần esp_mqtt_client_publish thành công
+    uint32_t samples;       // Số mẫu chứa trong các message đó
+    uint64_t bytes;         // Tổng độ dài payload (không tính header MQTT/TCP)
+} telemetry_codec_stats_t;
+
+/**
+ * @brief Mã hóa một mẫu thành JSON (định dạng gốc, mỗi message một mẫu).
+ *
+ * {"sensor":0,"seq":12,"temperature":25.3,"humidity":55.1,"flags":1,"timestamp":"2024-05-01 10:00:00.123"}
+ * Ghi bằng json_writer: không printf, localtime_r chỉ gọi khi sang giờ mới.
+ * @return Độ dài payload, 0 nếu buffer không đủ.
+ */
+size_t telemetry_codec_encode_sample(const sensor_sample_t *sample, int64_t wall_us, bool replay,
+                                     char *buf, size_t size);
+
+/**
+ * @brief Mã hóa count mẫu thành một payload dạng mảng.
+ *
+ * {"v":1,"t0":1714557600123,"s":[[sensor,seq,dt_ms,temp,hum,flags],...]}
+ * t0 là thời gian thực (ms kể từ epoch) của mẫu đầu, dt_ms tính từ t0;
+ * temp/hum là số nguyên đơn vị 0.1. Mẫu gửi lại từ log flash có thêm "r":1.
+ * @return Độ dài payload, 0 nếu buffer không đủ.
+ */
+size_t telemetry_codec_encode_batch(const telemetry_log_entry_t *records, size_t count, bool replay,
+                                    char *buf, size_t size);
+
+/**
+ * @brief Mã hóa cảnh báo của một mẫu (MQTT_ALERT_TOPIC).
+ *
+ * {"alert":"outlier","sensor":0,"seq":12,"temperature":25.3,"humidity":55.1,"timestamp":"2024-05-01 10:00:00.123"}
+ * @return Độ dài payload, 0 nếu buffer không đủ.
+ */
+size_t telemetry_codec_encode_alert(const char *alert, const sensor_sample_t *sample, int64_t wall_us,
+                                    char *buf, size_t size);
+
+/**
+ * @brief Mã hóa count mẫu (tối đa 255) thành payload nhị phân TELEMETRY_PACKED_SCHEMA.
+ *
+ * Khoảng 14 byte mỗi mẫu + 12 byte phần đầu, không định dạng số hay thời gian.
+ * @return Độ dài payload, 0 nếu buffer không đủ.
+ */
+size_t telemetry_codec_encode_packed(const telemetry_log_entry_t *records, size_t count, bool replay,
+                                     uint8_t *buf, size_t size);
+
+/**
+ * @brief Đo số chu kỳ CPU và kích thước payload của từng định dạng, kể cả bộ mã hóa
+ * JSON cũ (snprintf + strftime) để so sánh với json_writer.
+ *
+ * Chỉ dùng CPU và RAM, không publish; mẫu tổng hợp cố định nên kết quả so sánh
+ * được giữa các lần build. Kết quả được log ra.
+ */
+void telemetry_codec_benchmark(uint32_t iterations, telemetry_codec_bench_t *result);
+
+// Ghi nhận một message đã publish thành công chứa samples mẫu
+void telemetry_codec_record_publish(size_t samples, size_t bytes);
+
+// Lấy bản sao thống kê (an toàn khi gọi từ task khác)
+void telemetry_codec_get_stats(telemetry_codec_stats_t *stats);
+
+#endif // TELEMETRY_CODEC_H
@@ -0,0 +1,97 @@
+// inc/telemetry_log.h
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "inc/sensor_sample.h"
+
+// Phân vùng dữ liệu riêng trong partitions.csv
+#define TELEMETRY_LOG_PARTITION_LABEL   "telemetry"
+#define TELEMETRY_LOG_PARTITION_SUBTYPE 0x40
+
+// Định dạng trên flash: sector 4 KiB = 16 trang 256 byte; mỗi trang gồm header 32 byte
+// và 14 bản ghi 16 byte, mỗi bản ghi có CRC-16 riêng
+#define TELEMETRY_LOG_SECTOR_SIZE   4096
+#define TELEMETRY_LOG_PAGE_SIZE     256
+#define TELEMETRY_LOG_MAX_SECTORS   64   // Phân vùng lớn hơn chỉ dùng phần đầu
+
+// Số bản ghi tối đa một lần telemetry_log_peek()
+#define TELEMETRY_LOG_PEEK_MAX      32
+
+// Một mẫu đọc lại từ log; timestamp_us của sample không còn ý nghĩa sau khi khởi động lại
+typedef struct {
+    sensor_sample_t sample;
+    int64_t wall_us;        // Thời điểm lấy mẫu theo đồng hồ thực (us kể từ epoch, độ phân giải ms)
+} telemetry_log_entry_t;
+
+typedef struct {
+    uint32_t capacity;      // Số bản ghi tối đa của phân vùng
+    uint32_t pending;       // Số bản ghi đang chờ gửi lại (kể cả trong buffer RAM)
+    uint32_t buffered;      // Số bản ghi trong buffer RAM, chưa ghi xuống flash
+    uint32_t appended;      // Tổng số bản ghi đã nhận (từ lúc khởi động)
+    uint32_t replayed;      // Tổng số bản ghi đã gửi lại
+    uint32_t dropped;       // Số bản ghi chưa gửi bị ghi đè khi log đầy
+    uint32_t torn;          // Số bản ghi/trang hỏng (ghi dở do mất điện) bị bỏ qua khi quét
+    uint32_t page_writes;   // Số lần ghi flash (mỗi lần một lô bản ghi)
+    uint32_t erases;        // Số lần xóa sector từ lúc khởi động
+    uint32_t min_sector_erases; // Bộ đếm hao mòn nhỏ nhất / lớn nhất trong các sector
+    uint32_t max_sector_erases;
+} telemetry_log_stats_t;
+
+// Kết quả benchmark log so với NVS (mỗi mẫu một lần nvs_set_blob + nvs_commit)
+typedef struct {
+    uint32_t records;
+    uint32_t log_records_per_s;
+    uint32_t log_erases;
+    uint32_t nvs_records_per_s;
+    int32_t nvs_erases;     // -1 nếu không đo được (cần CONFIG_SPI_FLASH_ENABLE_COUNTERS)
+} telemetry_log_bench_t;
+
+/**
+ * @brief Mở phân vùng telemetry và khôi phục trạng thái bằng cách quét log.
+ *
+ * Bản ghi hoặc trang ghi dở (CRC sai) được bỏ qua; trang cuối cùng không
+ * được ghi tiếp mà bắt đầu trang mới. Các bản ghi chưa gửi từ lần chạy
+ * trước được giữ lại để gửi tiếp.
+ * @return ESP_ERR_NOT_FOUND nếu không có phân vùng.
+ */
+esp_err_t telemetry_log_init(void);
+
+/**
+ * @brief Thêm một mẫu vào log.
+ *
+ * Bản ghi được gom trong RAM và ghi xuống flash theo lô khi đầy trang hoặc
+ * khi bản ghi cũ nhất trong buffer đã chờ quá APP_TELEMETRY_FLUSH_MS. Khi log
+ * đầy, sector cũ nhất bị xóa (bản ghi chưa gửi trong đó được tính vào dropped).
+ */
+esp_err_t telemetry_log_append(const sensor_sample_t *sample, int64_t wall_us);
+
+// Ghi ngay các bản ghi đang gom trong RAM xuống flash
+esp_err_t telemetry_log_flush(void);
+
+// Ghi buffer xuống flash nếu đã đến hạn APP_TELEMETRY_FLUSH_MS; gọi định kỳ
+void telemetry_log_flush_if_due(void);
+
+// Đọc tối đa max (<= TELEMETRY_LOG_PEEK_MAX) bản ghi chờ gửi cũ nhất mà không đánh dấu đã gửi
+size_t telemetry_log_peek(telemetry_log_entry_t *out, size_t max);
+
+// Đánh dấu count bản ghi đầu tiên của lần telemetry_log_peek() gần nhất là đã gửi
+esp_err_t telemetry_log_consume(size_t count);
+
+// Số bản ghi đang chờ gửi, 0 nếu log chưa được khởi tạo
+uint32_t telemetry_log_pending(void);
+
+// Lấy bản sao thống kê (an toàn khi gọi từ task khác)
+void telemetry_log_get_stats(telemetry_log_stats_t *stats);
+
+/**
+ * @brief Đo tốc độ ghi và số lần xóa flash của log so với NVS.
+ *
+ * Xóa toàn bộ log (kể cả bản ghi chưa gửi), chỉ dùng khi phát triển.
+ * Gọi trước khi các task khác dùng log.
+ */
+esp_err_t telemetry_log_benchmark(uint32_t records, telemetry_log_bench_t *result);
+
+#endif // TELEMETRY_LOG_H
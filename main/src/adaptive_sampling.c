@@ -0,0 +1,93 @@
+#include "freertos/FreeRTOS.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+#include "inc/adaptive_sampling.h"
+#include "inc/sensor_filter.h"
+
+static const char *TAG = "ADAPTIVE_SAMPLING";
+
+typedef struct {
+    bool valid;
+    int16_t temperature;
+    int16_t humidity;
+} reference_t;
+
+static adaptive_sampling_config_t s_config;
+static reference_t s_reference[SENSOR_SET_MAX_SENSORS];
+static adaptive_sampling_stats_t s_stats;
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+uint32_t adaptive_sampling_init(const adaptive_sampling_config_t *config) {
+    s_config = *config;
+    if (s_config.max_period_ms < s_config.min_period_ms) {
+        s_config.max_period_ms = s_config.min_period_ms;
+    }
+    memset(s_reference, 0, sizeof(s_reference));
+
+    portENTER_CRITICAL(&s_stats_mux);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.period_ms = s_config.min_period_ms;
+    portEXIT_CRITICAL(&s_stats_mux);
+
+    ESP_LOGI(TAG, "Chu kỳ lấy mẫu %lu..%lu ms, deadband T=%d, H=%d (x0.1).",
+             s_config.min_period_ms, s_config.max_period_ms, s_config.temp_deadband, s_config.hum_deadband);
+    return s_config.min_period_ms;
+}
+
+// Trả về true nếu mẫu vượt deadband so với tham chiếu (và cập nhật tham chiếu)
+static bool sample_changed(const sensor_set_sample_t *sample) {
+    reference_t *ref = &s_reference[sample->sensor_id];
+
+    if (!ref->valid ||
+        abs(sample->temperature - ref->temperature) > s_config.temp_deadband ||
+        abs(sample->humidity - ref->humidity) > s_config.hum_deadband) {
+        ref->valid = true;
+        ref->temperature = sample->temperature;
+        ref->humidity = sample->humidity;
+        return true;
+    }
+    return false;
+}
+
+uint32_t adaptive_sampling_update(const sensor_batch_t *batch) {
+    bool changed = false;
+    bool any_valid = false;
+
+    for (uint8_t i = 0; i < batch->count; i++) {
+        const sensor_set_sample_t *sample = &batch->samples[i];
+        if (sample->result != ESP_OK || (sample->flags & SENSOR_FLAG_REJECTED) ||
+            sample->sensor_id >= SENSOR_SET_MAX_SENSORS) {
+            continue;
+        }
+        any_valid = true;
+        if (sample_changed(sample)) {
+            changed = true;
+        }
+    }
+
+    portENTER_CRITICAL(&s_stats_mux);
+    uint32_t period = s_stats.period_ms;
+    s_stats.sweeps++;
+    s_stats.total_period_ms += period;
+    if (changed) {
+        s_stats.changed_sweeps++;
+        period = s_config.min_period_ms;
+    } else if (any_valid) {
+        // Ổn định: giãn chu kỳ theo cấp số nhân đến heartbeat
+        s_stats.stable_sweeps++;
+        period = period * 2 > s_config.max_period_ms ? s_config.max_period_ms : period * 2;
+    }
+    // Lượt không có mẫu hợp lệ giữ nguyên chu kỳ
+    s_stats.period_ms = period;
+    portEXIT_CRITICAL(&s_stats_mux);
+
+    return period;
+}
+
+void adaptive_sampling_get_stats(adaptive_sampling_stats_t *stats) {
+    portENTER_CRITICAL(&s_stats_mux);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
@@ -0,0 +1,45 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "inc/app_config.h"
+#include "inc/app_i2c_bus.h"
+
+static const char *TAG = "APP_I2C_BUS";
+
+extern SemaphoreHandle_t g_i2c_bus_mutex;
+
+static i2c_master_bus_handle_t s_bus = NULL;
+
+esp_err_t app_i2c_bus_get(i2c_master_bus_handle_t *bus) {
+    esp_err_t err = ESP_OK;
+
+    if (bus == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (g_i2c_bus_mutex == NULL || xSemaphoreTake(g_i2c_bus_mutex, portMAX_DELAY) != pdTRUE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_bus == NULL) {
+        i2c_master_bus_config_t i2c_mst_config = {
+            .i2c_port = APP_I2C_PORT,
+            .sda_io_num = APP_I2C_SDA_PIN,
+            .scl_io_num = APP_I2C_SCL_PIN,
+            .clk_source = I2C_CLK_SRC_DEFAULT,
+            .glitch_ignore_cnt = 7,
+            .intr_priority = 0,
+            .trans_queue_depth = 0,
+            .flags.enable_internal_pullup = true
+        };
+        err = i2c_new_master_bus(&i2c_mst_config, &s_bus);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "I2C bus %d ready (SDA %d, SCL %d).", APP_I2C_PORT, APP_I2C_SDA_PIN, APP_I2C_SCL_PIN);
+        } else {
+            ESP_LOGE(TAG, "Failed to create I2C bus: %s", esp_err_to_name(err));
+            s_bus = NULL;
+        }
+    }
+    *bus = s_bus;
+    xSemaphoreGive(g_i2c_bus_mutex);
+    return err;
+}
@@ -0,0 +1,209 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+#include <stdatomic.h>
+#include "esp_log.h"
+
+#include "inc/app_state.h"
+#include "inc/seqlock.h"
+
+static const char *TAG = "APP_STATE";
+
+struct app_state_sub {
+    TaskHandle_t task;
+    app_state_sub_stats_t stats;
+};
+
+static sensor_sample_t s_sensor;
+static bool s_wifi;
+static app_state_time_t s_time;
+static ota_status_t s_ota = OTA_STATUS_IDLE;
+static bool s_mqtt;
+
+// Vị trí và kích thước dữ liệu của từng trường
+static const struct {
+    void *data;
+    size_t size;
+} s_fields[APP_STATE_FIELD_MAX] = {
+    [APP_STATE_SENSOR] = { &s_sensor, sizeof(s_sensor) },
+    [APP_STATE_WIFI] = { &s_wifi, sizeof(s_wifi) },
+    [APP_STATE_TIME] = { &s_time, sizeof(s_time) },
+    [APP_STATE_OTA] = { &s_ota, sizeof(s_ota) },
+    [APP_STATE_MQTT] = { &s_mqtt, sizeof(s_mqtt) },
+};
+
+static seqlock_t s_locks[APP_STATE_FIELD_MAX];
+static atomic_uint_fast32_t s_versions[APP_STATE_FIELD_MAX];
+
+static struct app_state_sub s_subs[APP_STATE_MAX_SUBSCRIBERS];
+static volatile size_t s_sub_count = 0;
+static portMUX_TYPE s_sub_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void app_state_init(void) {
+    for (int i = 0; i < APP_STATE_FIELD_MAX; i++) {
+        seqlock_init(&s_locks[i]);
+        atomic_init(&s_versions[i], 0);
+    }
+}
+
+// Ghi một trường; changed = false chỉ lưu giá trị mà không đánh thức ai
+static void app_state_write(app_state_field_t field, const void *value, bool changed) {
+    seqlock_write(&s_locks[field], s_fields[field].data, value, s_fields[field].size);
+    if (!changed) {
+        return;
+    }
+    atomic_fetch_add_explicit(&s_versions[field], 1, memory_order_release);
+
+    size_t count = s_sub_count;
+    for (size_t i = 0; i < count; i++) {
+        if (s_subs[i].stats.field_mask & APP_STATE_MASK(field)) {
+            xTaskNotify(s_subs[i].task, APP_STATE_MASK(field) << APP_STATE_NOTIFY_SHIFT, eSetBits);
+        }
+    }
+}
+
+// Ghi nếu khác giá trị hiện tại. Mỗi trường chỉ có một writer nên so sánh không cần khóa.
+static void app_state_update(app_state_field_t field, const void *value) {
+    if (atomic_load_explicit(&s_versions[field], memory_order_relaxed) != 0 &&
+        memcmp(s_fields[field].data, value, s_fields[field].size) == 0) {
+        return;
+    }
+    app_state_write(field, value, true);
+}
+
+static uint32_t app_state_read(app_state_field_t field, void *out) {
+    uint32_t version;
+    uint32_t check;
+
+    // Đọc phiên bản quanh bản sao để phiên bản trả về khớp với dữ liệu
+    do {
+        version = atomic_load_explicit(&s_versions[field], memory_order_acquire);
+        seqlock_read(&s_locks[field], out, s_fields[field].data, s_fields[field].size);
+        check = atomic_load_explicit(&s_versions[field], memory_order_acquire);
+    } while (version != check);
+    return version;
+}
+
+void app_state_set_sensor(const sensor_sample_t *sample) {
+    bool changed = atomic_load_explicit(&s_versions[APP_STATE_SENSOR], memory_order_relaxed) == 0 ||
+                   sample->temperature != s_sensor.temperature ||
+                   sample->humidity != s_sensor.humidity ||
+                   sample->sensor_id != s_sensor.sensor_id;
+    app_state_write(APP_STATE_SENSOR, sample, changed);
+}
+
+void app_state_set_wifi(bool connected) {
+    app_state_update(APP_STATE_WIFI, &connected);
+}
+
+void app_state_set_time(const struct tm *timeinfo) {
+    app_state_time_t time = { .synchronized = true };
+    time.timeinfo = *timeinfo;
+    app_state_update(APP_STATE_TIME, &time);
+}
+
+void app_state_set_ota(ota_status_t status) {
+    app_state_update(APP_STATE_OTA, &status);
+}
+
+void app_state_set_mqtt(bool connected) {
+    app_state_update(APP_STATE_MQTT, &connected);
+}
+
+uint32_t app_state_get_sensor(sensor_sample_t *sample) {
+    return app_state_read(APP_STATE_SENSOR, sample);
+}
+
+uint32_t app_state_get_wifi(bool *connected) {
+    return app_state_read(APP_STATE_WIFI, connected);
+}
+
+uint32_t app_state_get_time(app_state_time_t *time) {
+    return app_state_read(APP_STATE_TIME, time);
+}
+
+uint32_t app_state_get_ota(ota_status_t *status) {
+    return app_state_read(APP_STATE_OTA, status);
+}
+
+uint32_t app_state_get_mqtt(bool *connected) {
+    return app_state_read(APP_STATE_MQTT, connected);
+}
+
+uint32_t app_state_version(app_state_field_t field) {
+    return (unsigned)field < APP_STATE_FIELD_MAX ? atomic_load_explicit(&s_versions[field], memory_order_acquire) : 0;
+}
+
+const char *app_state_field_to_string(app_state_field_t field) {
+    switch (field) {
+        case APP_STATE_SENSOR: return "sensor";
+        case APP_STATE_WIFI: return "wifi";
+        case APP_STATE_TIME: return "time";
+        case APP_STATE_OTA: return "ota";
+        case APP_STATE_MQTT: return "mqtt";
+        default: return "unknown";
+    }
+}
+
+esp_err_t app_state_get_lock_stats(app_state_field_t field, seqlock_stats_t *stats) {
+    if (stats == NULL || (unsigned)field >= APP_STATE_FIELD_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    seqlock_get_stats(&s_locks[field], stats);
+    return ESP_OK;
+}
+
+app_state_sub_t app_state_subscribe(const char *name, uint32_t field_mask) {
+    struct app_state_sub *sub = NULL;
+
+    portENTER_CRITICAL(&s_sub_mux);
+    if (s_sub_count < APP_STATE_MAX_SUBSCRIBERS) {
+        sub = &s_subs[s_sub_count];
+        memset(sub, 0, sizeof(*sub));
+        sub->task = xTaskGetCurrentTaskHandle();
+        sub->stats.name = name;
+        sub->stats.field_mask = field_mask & APP_STATE_MASK_ALL;
+        s_sub_count++;
+    }
+    portEXIT_CRITICAL(&s_sub_mux);
+
+    if (sub == NULL) {
+        ESP_LOGE(TAG, "Hết chỗ cho consumer '%s' (tối đa %d).", name, APP_STATE_MAX_SUBSCRIBERS);
+    }
+    return sub;
+}
+
+uint32_t app_state_wait(app_state_sub_t sub, TickType_t timeout) {
+    uint32_t bits = 0;
+
+    if (sub == NULL) {
+        vTaskDelay(timeout);
+        return 0;
+    }
+    // Chỉ xóa các bit của kho trạng thái, giữ nguyên bit của sample bus
+    xTaskNotifyWait(0, APP_STATE_MASK_ALL << APP_STATE_NOTIFY_SHIFT, &bits, timeout);
+    uint32_t changed = (bits >> APP_STATE_NOTIFY_SHIFT) & sub->stats.field_mask;
+
+    portENTER_CRITICAL(&s_sub_mux);
+    if (changed) {
+        sub->stats.change_wakeups++;
+    } else {
+        sub->stats.deadline_wakeups++;
+    }
+    portEXIT_CRITICAL(&s_sub_mux);
+    return changed;
+}
+
+size_t app_state_subscriber_count(void) {
+    return s_sub_count;
+}
+
+esp_err_t app_state_get_sub_stats(size_t index, app_state_sub_stats_t *stats) {
+    if (stats == NULL || index >= s_sub_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_sub_mux);
+    *stats = s_subs[index].stats;
+    portEXIT_CRITICAL(&s_sub_mux);
+    return ESP_OK;
+}
@@ -0,0 +1,216 @@
+#include <string.h>
+
+#include "inc/json_writer.h"
+
+static void put_char(json_writer_t *w, char c) {
+    // Luôn chừa một byte cho '\0' của json_writer_finish()
+    if (w->len + 1 >= w->size) {
+        w->overflow = true;
+        return;
+    }
+    w->buf[w->len++] = c;
+}
+
+static void put_mem(json_writer_t *w, const char *src, size_t n) {
+    if (w->len + n >= w->size) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, src, n);
+    w->len += n;
+}
+
+// Ghi số không dấu: sinh chữ số từ phải sang trái vào buffer tạm rồi chép một lần
+static void put_u32(json_writer_t *w, uint32_t value) {
+    char digits[10];
+    size_t n = sizeof(digits);
+    do {
+        digits[--n] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    put_mem(w, digits + n, sizeof(digits) - n);
+}
+
+// Hai chữ số có số 0 đứng đầu (phút, giây)
+static void put_2digits(char *out, uint32_t value) {
+    out[0] = (char)('0' + value / 10);
+    out[1] = (char)('0' + value % 10);
+}
+
+// Dấu phẩy trước phần tử thứ hai trở đi của object/mảng
+static void begin_value(json_writer_t *w) {
+    if (w->need_comma) {
+        put_char(w, ',');
+    }
+    w->need_comma = true;
+}
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size) {
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->need_comma = false;
+    w->overflow = buf == NULL || size == 0;
+}
+
+void json_writer_begin_object(json_writer_t *w) {
+    begin_value(w);
+    put_char(w, '{');
+    w->need_comma = false;
+}
+
+void json_writer_end_object(json_writer_t *w) {
+    put_char(w, '}');
+    w->need_comma = true;
+}
+
+void json_writer_begin_array(json_writer_t *w) {
+    begin_value(w);
+    put_char(w, '[');
+    w->need_comma = false;
+}
+
+void json_writer_end_array(json_writer_t *w) {
+    put_char(w, ']');
+    w->need_comma = true;
+}
+
+void json_writer_key(json_writer_t *w, const char *key) {
+    begin_value(w);
+    put_char(w, '"');
+    put_mem(w, key, strlen(key));
+    put_mem(w, "\":", 2);
+    // Giá trị theo sau key không có dấu phẩy
+    w->need_comma = false;
+}
+
+void json_writer_int(json_writer_t *w, int32_t value) {
+    begin_value(w);
+    if (value < 0) {
+        put_char(w, '-');
+        put_u32(w, 0u - (uint32_t)value);
+    } else {
+        put_u32(w, (uint32_t)value);
+    }
+}
+
+void json_writer_uint(json_writer_t *w, uint32_t value) {
+    begin_value(w);
+    put_u32(w, value);
+}
+
+void json_writer_int64(json_writer_t *w, int64_t value) {
+    begin_value(w);
+    uint64_t u = value < 0 ? 0u - (uint64_t)value : (uint64_t)value;
+    if (value < 0) {
+        put_char(w, '-');
+    }
+    // Tách thành các khối 9 chữ số để chỉ chia 64 bit vài lần, phần còn lại dùng phép chia 32 bit
+    if (u <= UINT32_MAX) {
+        put_u32(w, (uint32_t)u);
+        return;
+    }
+    char digits[20];
+    size_t n = sizeof(digits);
+    while (u > UINT32_MAX) {
+        uint32_t chunk = (uint32_t)(u % 1000000000u);
+        u /= 1000000000u;
+        for (int i = 0; i < 9; i++) {
+            digits[--n] = (char)('0' + chunk % 10);
+            chunk /= 10;
+        }
+    }
+    put_u32(w, (uint32_t)u);
+    put_mem(w, digits + n, sizeof(digits) - n);
+}
+
+void json_writer_bool(json_writer_t *w, bool value) {
+    begin_value(w);
+    if (value) {
+        put_mem(w, "true", 4);
+    } else {
+        put_mem(w, "false", 5);
+    }
+}
+
+void json_writer_tenths(json_writer_t *w, int32_t tenths) {
+    begin_value(w);
+    uint32_t value = tenths < 0 ? 0u - (uint32_t)tenths : (uint32_t)tenths;
+    if (tenths < 0) {
+        put_char(w, '-');
+    }
+    put_u32(w, value / 10);
+    put_char(w, '.');
+    put_char(w, (char)('0' + value % 10));
+}
+
+void json_writer_string(json_writer_t *w, const char *str) {
+    static const char hex[] = "0123456789abcdef";
+
+    begin_value(w);
+    put_char(w, '"');
+    for (const char *p = str; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            put_char(w, '\\');
+            put_char(w, (char)c);
+        } else if (c < 0x20) {
+            char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+            put_mem(w, esc, sizeof(esc));
+        } else {
+            put_char(w, (char)c);
+        }
+    }
+    put_char(w, '"');
+}
+
+void json_writer_local_time(json_writer_t *w, json_time_cache_t *cache, int64_t wall_us) {
+    time_t sec = (time_t)(wall_us / 1000000);
+    uint32_t ms = (uint32_t)(wall_us / 1000 % 1000);
+
+    // Giờ địa phương mới (hoặc lần đầu): một lần localtime_r cho cả giờ. Đổi giờ mùa hè
+    // luôn xảy ra ở đầu giờ nên phút/giây trong một giờ không bị ảnh hưởng.
+    if (!cache->valid || sec < cache->hour_start || sec >= cache->hour_start + 3600) {
+        struct tm tm;
+        localtime_r(&sec, &tm);
+        cache->hour_start = sec - tm.tm_min * 60 - tm.tm_sec;
+        uint32_t year = (uint32_t)(tm.tm_year + 1900);
+        char *p = cache->prefix;
+        put_2digits(p, year / 100 % 100);
+        put_2digits(p + 2, year % 100);
+        p[4] = '-';
+        put_2digits(p + 5, (uint32_t)tm.tm_mon + 1);
+        p[7] = '-';
+        put_2digits(p + 8, (uint32_t)tm.tm_mday);
+        p[10] = ' ';
+        put_2digits(p + 11, (uint32_t)tm.tm_hour);
+        p[13] = ':';
+        cache->valid = true;
+    }
+
+    uint32_t in_hour = (uint32_t)(sec - cache->hour_start);
+    char out[JSON_TIME_LEN + 2];
+    out[0] = '"';
+    memcpy(out + 1, cache->prefix, sizeof(cache->prefix));
+    put_2digits(out + 15, in_hour / 60);
+    out[17] = ':';
+    put_2digits(out + 18, in_hour % 60);
+    out[20] = '.';
+    out[21] = (char)('0' + ms / 100);
+    put_2digits(out + 22, ms % 100);
+    out[24] = '"';
+
+    begin_value(w);
+    put_mem(w, out, sizeof(out));
+}
+
+size_t json_writer_finish(json_writer_t *w) {
+    if (w->overflow) {
+        if (w->size) {
+            w->buf[0] = '\0';
+        }
+        return 0;
+    }
+    w->buf[w->len] = '\0';
+    return w->len;
+}
@@ -10,25 +10,14 @@
 #include <time.h>
 
 #include "inc/app_config.h"
-
-typedef struct {
-    float temperature;
-    float humidity;
-} sensor_data_t;
+#include "inc/sensor_sample.h"
+#include "inc/app_i2c_bus.h"
+#include "inc/app_state.h"
 
 static const char *TAG = "LCD_TASK";
 
-extern EventGroupHandle_t wifi_event_group;
-extern sensor_data_t g_display_sensor_data;
-extern SemaphoreHandle_t g_display_sensor_data_mutex;
-extern struct tm g_current_timeinfo;
-extern SemaphoreHandle_t g_current_time_mutex;
-extern bool g_time_synchronized;
 extern SemaphoreHandle_t g_i2c_bus_mutex;
 
-#define LCD_I2C_PORT        I2C_NUM_0
-#define LCD_I2C_SDA_PIN     GPIO_NUM_21
-#define LCD_I2C_SCL_PIN     GPIO_NUM_22
 #define LCD_I2C_MASTER_FREQ_HZ 100000
 #define LCD_I2C_ADDRESS     0x27
 
@@ -79,17 +68,8 @@ static void lcd_send_byte(uint8_t byte, bool is_data_mode) {
 
 void lcd_init_concrete() {
     ESP_LOGI(TAG, "Initializing LCD 1602A via I2C...");
-    i2c_master_bus_config_t i2c_mst_config = {
-        .i2c_port = LCD_I2C_PORT,
-        .sda_io_num = LCD_I2C_SDA_PIN,
-        .scl_io_num = LCD_I2C_SCL_PIN,
-        .clk_source = I2C_CLK_SRC_DEFAULT,
-        .glitch_ignore_cnt = 7,
-        .intr_priority = 0,
-        .trans_queue_depth = 0,
-        .flags.enable_internal_pullup = true
-    };
-    ESP_ERROR_CHECK(i2c_new_master_bus(&i2c_mst_config, &i2c_bus_handle));
+    // Bus dùng chung với các cảm biến I2C (inc/app_i2c_bus.h)
+    ESP_ERROR_CHECK(app_i2c_bus_get(&i2c_bus_handle));
 
     i2c_device_config_t dev_cfg = {
         .dev_addr_length = I2C_ADDR_BIT_LEN_7,
@@ -137,7 +117,13 @@ void lcd_task(void *pvParameters) {
     ESP_LOGI(TAG, "LCD Task Started");
     lcd_init_concrete();
 
-    sensor_data_t local_sensor_data = {0.0f, 0.0f};
+    sensor_sample_t local_sensor_data = {0};
+    // LCD chỉ cần giá trị mới nhất nên đọc kho trạng thái thay vì nhận luồng mẫu
+    app_state_sub_t sub = app_state_subscribe("lcd", APP_STATE_MASK(APP_STATE_SENSOR) |
+                                                     APP_STATE_MASK(APP_STATE_WIFI) |
+                                                     APP_STATE_MASK(APP_STATE_TIME));
+    char temp_str[SENSOR_TENTHS_STR_LEN];
+    char hum_str[SENSOR_TENTHS_STR_LEN];
     char line1_buffer[17]; 
     char line2_buffer[17];
     char content_buffer[17]; 
@@ -155,44 +141,72 @@ void lcd_task(void *pvParameters) {
         xSemaphoreGive(g_i2c_bus_mutex);
     }
 
+    // Chỉ vẽ lại khi trạng thái thay đổi; hạn riêng của LCD là lúc đổi trang WiFi/Time
+    TickType_t flip_interval = pdMS_TO_TICKS(APP_LCD_UPDATE_INTERVAL_MS);
+    TickType_t next_flip = xTaskGetTickCount() + flip_interval;
+    uint32_t changed = APP_STATE_MASK_ALL; // Lần đầu vẽ toàn bộ
+
     while (1) {
-        if (xSemaphoreTake(g_display_sensor_data_mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-            local_sensor_data = g_display_sensor_data;
-            xSemaphoreGive(g_display_sensor_data_mutex);
-        }
-        snprintf(line1_buffer, sizeof(line1_buffer), "T:%.1fC H:%.1f%%",
-                 local_sensor_data.temperature, local_sensor_data.humidity);
-
-        if (display_mode_is_wifi) {
-            bool wifi_is_connected = (wifi_event_group && (xEventGroupGetBits(wifi_event_group) & WIFI_CONNECTED_BIT));
-            snprintf(content_buffer, sizeof(content_buffer), "WiFi: %s",
-                     wifi_is_connected ? "Online" : "Offline");
-        } else {
-            if (g_time_synchronized) {
-                struct tm time_snapshot;
-                if (xSemaphoreTake(g_current_time_mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-                    time_snapshot = g_current_timeinfo;
-                    xSemaphoreGive(g_current_time_mutex);
-                }
-                snprintf(content_buffer, sizeof(content_buffer), "Time: %02d:%02d:%02d",
-                         time_snapshot.tm_hour, time_snapshot.tm_min, time_snapshot.tm_sec);
+        // Dòng không vẽ được vì bus I2C bận: giữ lại bit của nó để vẽ lại ở lần thức dậy kế tiếp
+        uint32_t unrendered = 0;
+
+        if (changed & APP_STATE_MASK(APP_STATE_SENSOR)) {
+            app_state_get_sensor(&local_sensor_data);
+            sensor_sample_format_tenths(temp_str, sizeof(temp_str), local_sensor_data.temperature);
+            sensor_sample_format_tenths(hum_str, sizeof(hum_str), local_sensor_data.humidity);
+            snprintf(content_buffer, sizeof(content_buffer), "T:%sC H:%s%%", temp_str, hum_str);
+            snprintf(line1_buffer, sizeof(line1_buffer), "%-16s", content_buffer);
+
+            // Giữ bus theo từng dòng thay vì cả màn hình, để giao dịch của cảm biến I2C chen vào giữa
+            if (xSemaphoreTake(g_i2c_bus_mutex, pdMS_TO_TICKS(100))) {
+                lcd_set_cursor_concrete(0, 0);
+                lcd_print_string_concrete(line1_buffer);
+                xSemaphoreGive(g_i2c_bus_mutex);
             } else {
-                snprintf(content_buffer, sizeof(content_buffer), "Time: Not Sync");
+                unrendered |= APP_STATE_MASK(APP_STATE_SENSOR);
             }
         }
 
-        snprintf(line2_buffer, sizeof(line2_buffer), "%-16s", content_buffer);
+        bool flip_due = (int32_t)(xTaskGetTickCount() - next_flip) >= 0;
+        if (flip_due) {
+            display_mode_is_wifi = !display_mode_is_wifi;
+            next_flip += flip_interval;
+        }
 
-        if (xSemaphoreTake(g_i2c_bus_mutex, pdMS_TO_TICKS(100))) {
-            lcd_set_cursor_concrete(0, 0);
-            lcd_print_string_concrete(line1_buffer);
+        uint32_t line2_field = display_mode_is_wifi ? APP_STATE_MASK(APP_STATE_WIFI) : APP_STATE_MASK(APP_STATE_TIME);
+        if (flip_due || (changed & line2_field)) {
+            if (display_mode_is_wifi) {
+                bool wifi_is_connected = false;
+                app_state_get_wifi(&wifi_is_connected);
+                snprintf(content_buffer, sizeof(content_buffer), "WiFi: %s",
+                         wifi_is_connected ? "Online" : "Offline");
+            } else {
+                app_state_time_t time_snapshot;
+                app_state_get_time(&time_snapshot);
+                if (time_snapshot.synchronized) {
+                    snprintf(content_buffer, sizeof(content_buffer), "Time: %02d:%02d:%02d",
+                             time_snapshot.timeinfo.tm_hour, time_snapshot.timeinfo.tm_min, time_snapshot.timeinfo.tm_sec);
+                } else {
+                    snprintf(content_buffer, sizeof(content_buffer), "Time: Not Sync");
+                }
+            }
+
+            snprintf(line2_buffer, sizeof(line2_buffer), "%-16s", content_buffer);
 
-            lcd_set_cursor_concrete(1, 0);
-            lcd_print_string_concrete(line2_buffer);
-            xSemaphoreGive(g_i2c_bus_mutex);
+            if (xSemaphoreTake(g_i2c_bus_mutex, pdMS_TO_TICKS(100))) {
+                lcd_set_cursor_concrete(1, 0);
+                lcd_print_string_concrete(line2_buffer);
+                xSemaphoreGive(g_i2c_bus_mutex);
+            } else {
+                unrendered |= line2_field;
+            }
         }
 
-        display_mode_is_wifi = !display_mode_is_wifi;
-        vTaskDelay(pdMS_TO_TICKS(APP_LCD_UPDATE_INTERVAL_MS));
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = (int32_t)(next_flip - now) > 0 ? next_flip - now : 0;
+        if (unrendered && wait > pdMS_TO_TICKS(APP_LCD_RETRY_MS)) {
+            wait = pdMS_TO_TICKS(APP_LCD_RETRY_MS);
+        }
+        changed = app_state_wait(sub, wait) | unrendered;
     }
 }
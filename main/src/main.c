@@ -11,17 +11,25 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_wifi.h"
+#include "esp_heap_caps.h"
+#include "dht.h"
 
 // Include các file cấu hình và module của project
 #include "inc/app_config.h"   // Chứa FIRMWARE_UPGRADE_URL, WIFI_SSID, WIFI_PASSWORD, etc.
 #include "inc/ota_client.h"   // Để gọi start_ota_firmware_update
 #include "inc/app_status.h"   // << QUAN TRỌNG: Chứa định nghĩa ota_status_t và các khai báo liên quan
-
-// Định nghĩa cấu trúc dữ liệu cảm biến (đã có trong các file task)
-typedef struct {
-    float temperature;
-    float humidity;
-} sensor_data_t;
+#include "inc/adaptive_sampling.h"
+#include "inc/sensor_set.h"
+#include "inc/sensor_sample.h"
+#include "inc/app_state.h"
+#include "inc/sample_bus.h"
+#include "inc/task_placement.h"
+#include "inc/sample_history.h"
+#include "inc/telemetry_log.h"
+#include "inc/pipeline_stats.h"
+#include "inc/telemetry_codec.h"
+#include "inc/mqtt_policy.h"
+#include "inc/mqtt_command.h"
 
 
 // Khai báo các TaskHandle_t để giám sát
@@ -31,29 +39,21 @@ TaskHandle_t h_mqtt_task = NULL;
 TaskHandle_t h_ntp_task = NULL;
 TaskHandle_t h_lcd_task = NULL;
 TaskHandle_t h_ota_task = NULL; // Sẽ được cập nhật từ trong ota_client.c nếu cần
+static TaskHandle_t h_monitor_task = NULL;
+static TaskHandle_t h_command_task = NULL;
 
 
 
-// Khai báo QueueHandle_t toàn cục
-QueueHandle_t sensor_data_queue;
-
 // Khai báo EventGroupHandle_t toàn cục (sẽ được tạo trong wifi_task)
 extern EventGroupHandle_t wifi_event_group;
 
-// Biến toàn cục để lưu dữ liệu cảm biến cho LCD/OLED và Mutex bảo vệ
-sensor_data_t g_display_sensor_data = {0.0f, 0.0f}; // Khởi tạo giá trị ban đầu
-SemaphoreHandle_t g_display_sensor_data_mutex;
-
-// Biến toàn cục cho trạng thái OTA và Mutex bảo vệ (định nghĩa)
-ota_status_t g_ota_status = OTA_STATUS_IDLE; 
-SemaphoreHandle_t g_ota_status_mutex;      
-
-// Bien toan cuc luu thoi gian
-struct tm g_current_timeinfo;
-SemaphoreHandle_t g_current_time_mutex;
+// Cờ đồng bộ SNTP (ntp_task); thời gian hiển thị được lưu trong kho trạng thái
 bool g_time_synchronized = false; 
 
 SemaphoreHandle_t g_i2c_bus_mutex; 
+#if APP_STATIC_ALLOCATION
+static StaticSemaphore_t s_i2c_bus_mutex_buf;
+#endif
 
 
 
@@ -69,6 +69,115 @@ void system_monitor_task(void *pvParameters);
 
 static const char *TAG_MAIN = "app_main"; // Tag riêng cho main
 
+// Giai đoạn tạo task: BOOT ngay khi khởi động, NETWORK sau khi WiFi đã kết nối
+typedef enum {
+    APP_TASK_PHASE_BOOT = 0,
+    APP_TASK_PHASE_NETWORK,
+} app_task_phase_t;
+
+// Bảng task duy nhất, cố định lúc biên dịch:
+// X(id, hàm, tên, stack (byte), độ ưu tiên, nhóm nhân, giai đoạn, con trỏ handle)
+// Nhân thực tế của mỗi nhóm do APP_TASK_PLACEMENT quyết định (inc/task_placement.h).
+// Sensor_Task (lọc, lịch sử, bus, log SENSOR_TENTHS) và Monitor_Task (các bảng thống kê) ước lượng
+// đỉnh ~2.3 KB và ~3.3 KB: frame theo -fstack-usage của chuỗi gọi sâu nhất cộng ~1.6 KB cho vprintf
+// của ESP_LOG/printf. Khi đổi hai task này, đối chiếu với "Task Stack High Water Mark" mà monitor
+// in ra trên thiết bị và giữ ít nhất APP_TASK_STACK_MIN_FREE còn trống.
+#define APP_TASK_TABLE(X) \
+    X(wifi,    wifi_task,           "WiFi_Task",    4096, 6, TASK_CLASS_NET,        APP_TASK_PHASE_BOOT,    &h_wifi_task)    \
+    X(sensor,  sensor_task,         "Sensor_Task",  3584, 5, TASK_CLASS_ACQ,        APP_TASK_PHASE_NETWORK, &h_sensor_task)  \
+    X(mqtt,    mqtt_task,           "MQTT_Task",    4096, 4, TASK_CLASS_NET,        APP_TASK_PHASE_NETWORK, &h_mqtt_task)    \
+    X(ntp,     ntp_task,            "NTP_Task",     3072, 3, TASK_CLASS_NET,        APP_TASK_PHASE_NETWORK, &h_ntp_task)     \
+    X(lcd,     lcd_task,            "LCD_Task",     2560, 4, TASK_CLASS_UI,         APP_TASK_PHASE_NETWORK, &h_lcd_task)     \
+    X(monitor, system_monitor_task, "Monitor_Task", 4608, 1, TASK_CLASS_BACKGROUND, APP_TASK_PHASE_NETWORK, &h_monitor_task) \
+    X(command, mqtt_command_task,   "Command_Task", 3072, 2, TASK_CLASS_BACKGROUND, APP_TASK_PHASE_NETWORK, &h_command_task)
+
+typedef struct {
+    TaskFunction_t fn;
+    const char *name;
+    uint32_t stack_size;        // byte (ESP-IDF tính stack theo byte)
+    UBaseType_t priority;
+    task_class_t task_class;
+    app_task_phase_t phase;
+    TaskHandle_t *handle;
+#if APP_STATIC_ALLOCATION
+    StackType_t *stack;
+    StaticTask_t *tcb;
+#endif
+} app_task_def_t;
+
+#if APP_STATIC_ALLOCATION
+#define APP_TASK_STORAGE(id, fn, name, stack, prio, cls, phase, handle) \
+    static StackType_t s_stack_##id[(stack) / sizeof(StackType_t)]; \
+    static StaticTask_t s_tcb_##id;
+APP_TASK_TABLE(APP_TASK_STORAGE)
+#define APP_TASK_ENTRY(id, fn, name, stack, prio, cls, phase, handle) \
+    { fn, name, stack, prio, cls, phase, handle, s_stack_##id, &s_tcb_##id },
+#else
+#define APP_TASK_ENTRY(id, fn, name, stack, prio, cls, phase, handle) \
+    { fn, name, stack, prio, cls, phase, handle },
+#endif
+
+static const app_task_def_t s_app_tasks[] = {
+    APP_TASK_TABLE(APP_TASK_ENTRY)
+};
+#define APP_TASK_COUNT (sizeof(s_app_tasks) / sizeof(s_app_tasks[0]))
+
+// Tạo mọi task thuộc một giai đoạn theo bảng; ESP_ERR_NO_MEM nếu có task không tạo được
+static esp_err_t app_tasks_create(app_task_phase_t phase) {
+    esp_err_t result = ESP_OK;
+
+    for (size_t i = 0; i < APP_TASK_COUNT; i++) {
+        const app_task_def_t *def = &s_app_tasks[i];
+        if (def->phase != phase) {
+            continue;
+        }
+        BaseType_t core = task_placement_core(def->task_class);
+#if APP_STATIC_ALLOCATION
+        *def->handle = xTaskCreateStaticPinnedToCore(def->fn, def->name, def->stack_size, NULL, def->priority,
+                                                     def->stack, def->tcb, core);
+#else
+        if (xTaskCreatePinnedToCore(def->fn, def->name, def->stack_size, NULL, def->priority,
+                                    def->handle, core) != pdPASS) {
+            *def->handle = NULL;
+        }
+#endif
+        if (*def->handle == NULL) {
+            ESP_LOGE(TAG_MAIN, "Failed to create %s (%lu bytes stack)", def->name, def->stack_size);
+            result = ESP_ERR_NO_MEM;
+        }
+    }
+    return result;
+}
+
+// Bản đồ RAM lúc khởi động: stack + TCB từng task, các đối tượng đồng bộ và trạng thái heap
+static void app_print_ram_map(void) {
+    size_t total = 0;
+
+    printf("RAM map (%s, placement %s):\n", APP_STATIC_ALLOCATION ? "static" : "heap",
+           task_placement_to_string(task_placement_active()));
+    for (size_t i = 0; i < APP_TASK_COUNT; i++) {
+        const app_task_def_t *def = &s_app_tasks[i];
+        BaseType_t core = task_placement_core(def->task_class);
+        char core_str[4];
+        if (core == tskNO_AFFINITY) {
+            snprintf(core_str, sizeof(core_str), "any");
+        } else {
+            snprintf(core_str, sizeof(core_str), "%d", (int)core);
+        }
+        printf("  %-13s stack %5lu B + TCB %u B, prio %u, core %s\n", def->name, def->stack_size,
+               (unsigned)sizeof(StaticTask_t), (unsigned)def->priority, core_str);
+        total += def->stack_size + sizeof(StaticTask_t);
+    }
+    printf("  %-13s %u B\n", "i2c mutex", (unsigned)sizeof(StaticSemaphore_t));
+    printf("  %-13s %u B\n", "wifi events", (unsigned)sizeof(StaticEventGroup_t));
+    total += sizeof(StaticSemaphore_t) + sizeof(StaticEventGroup_t);
+    printf("  Total: %u B\n", (unsigned)total);
+    printf("  Heap: free %u B, largest block %u B, min free %u B\n",
+           (unsigned)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+           (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+           (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+}
+
 // Hàm chuyển đổi enum trạng thái OTA sang chuỗi (triển khai)
 const char* ota_status_to_string(ota_status_t status) { // << QUAN TRỌNG
     switch (status) {
@@ -91,6 +200,68 @@ const char* ota_status_to_string(ota_status_t status) { // << QUAN TRỌNG
     }
 }
 
+// Lệnh "ota/start": tạo task OTA (tải firmware qua HTTP) nên chạy trong Command_Task, không trong
+// event task của MQTT client. Chỉ dùng FIRMWARE_UPGRADE_URL cố định, không nhận URL từ payload.
+static esp_err_t cmd_ota_start(const char *arg) {
+    start_ota_firmware_update(FIRMWARE_UPGRADE_URL);
+    return ESP_OK;
+}
+
+// Lệnh "stats/dump": đánh thức system_monitor_task để in bảng trạng thái ngay
+static esp_err_t cmd_stats_dump(const char *arg) {
+    if (h_monitor_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xTaskNotifyGive(h_monitor_task);
+    return ESP_OK;
+}
+
+// Số bản tổng hợp in mỗi cảm biến cho lệnh "history/dump"; quyết định chọn phút hay giờ
+#define HISTORY_DUMP_ROLLUPS 16
+
+// Lệnh "history/dump [giây]": in tổng hợp của khoảng gần nhất (mặc định 1 giờ) và các mẫu thô
+// của phút cuối cho từng cảm biến. Chạy trong command task; bộ đệm tĩnh để không tốn stack.
+static esp_err_t cmd_history_dump(const char *arg) {
+    static sample_history_rollup_t rollups[HISTORY_DUMP_ROLLUPS];
+    static sample_history_raw_t raw[60 * 1000 / APP_SENSOR_MIN_INTERVAL_MS];
+    uint32_t span_s = 3600;
+    if (arg[0] != '\0' && mqtt_command_parse_u32(arg, &span_s) != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (span_s == 0 || span_s > HISTORY_DUMP_ROLLUPS * 3600) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    time_t now;
+    if (!sample_history_now(&now)) {
+        return ESP_ERR_INVALID_STATE;   // Chưa đồng bộ NTP, chưa có mốc wall-clock
+    }
+    // Khoảng ngắn xem theo phút, dài hơn xem theo giờ (đều tối đa HISTORY_DUMP_ROLLUPS bản ghi)
+    sample_history_res_t res = span_s <= HISTORY_DUMP_ROLLUPS * 60 ? SAMPLE_HISTORY_MINUTE : SAMPLE_HISTORY_HOUR;
+
+    for (uint8_t id = 0; id < APP_HISTORY_SENSORS; id++) {
+        size_t n = sample_history_query_rollup(res, id, now - (time_t)span_s, now, rollups, HISTORY_DUMP_ROLLUPS);
+        ESP_LOGI(TAG_MAIN, "History sensor %u, last %lus by %s: %u rollups", id, span_s,
+                 res == SAMPLE_HISTORY_MINUTE ? "minute" : "hour", (unsigned)n);
+        for (size_t i = 0; i < n; i++) {
+            const sample_history_rollup_t *r = &rollups[i];
+            int16_t temp_avg = (int16_t)(r->temp_sum / r->count);
+            int16_t hum_avg = (int16_t)(r->hum_sum / r->count);
+            ESP_LOGI(TAG_MAIN, "  %lu: %u samples, T " SENSOR_TENTHS_FMT ".." SENSOR_TENTHS_FMT " avg " SENSOR_TENTHS_FMT
+                     ", H " SENSOR_TENTHS_FMT ".." SENSOR_TENTHS_FMT " avg " SENSOR_TENTHS_FMT,
+                     r->start_s, r->count,
+                     SENSOR_TENTHS_ARGS(r->temp_min), SENSOR_TENTHS_ARGS(r->temp_max), SENSOR_TENTHS_ARGS(temp_avg),
+                     SENSOR_TENTHS_ARGS(r->hum_min), SENSOR_TENTHS_ARGS(r->hum_max), SENSOR_TENTHS_ARGS(hum_avg));
+        }
+        n = sample_history_query_raw(id, now - 60, now, raw, sizeof(raw) / sizeof(raw[0]));
+        for (size_t i = 0; i < n; i++) {
+            ESP_LOGI(TAG_MAIN, "  raw %lu: T " SENSOR_TENTHS_FMT ", H " SENSOR_TENTHS_FMT "%s", raw[i].time_s,
+                     SENSOR_TENTHS_ARGS(raw[i].temperature), SENSOR_TENTHS_ARGS(raw[i].humidity),
+                     (raw[i].flags & SENSOR_FLAG_UNCHANGED) ? " (unchanged)" : "");
+        }
+    }
+    return ESP_OK;
+}
+
 void app_main() {
     // Khởi tạo NVS (cần cho WiFi)
     esp_err_t ret = nvs_flash_init();
@@ -104,45 +275,51 @@ void app_main() {
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 
-    // Tạo Mutex để bảo vệ dữ liệu hiển thị cảm biến
-    g_display_sensor_data_mutex = xSemaphoreCreateMutex();
-    if (g_display_sensor_data_mutex == NULL) {
-        ESP_LOGE(TAG_MAIN, "Failed to create g_display_sensor_data_mutex. Halting.");
-        while(1); // Dừng ở đây nếu không tạo được mutex
+#if APP_STATIC_ALLOCATION
+    g_i2c_bus_mutex = xSemaphoreCreateMutexStatic(&s_i2c_bus_mutex_buf);
+#else
+    g_i2c_bus_mutex = xSemaphoreCreateMutex();
+    if (g_i2c_bus_mutex == NULL) {
+        ESP_LOGE(TAG_MAIN, "Failed to create g_i2c_bus_mutex.");
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM); // Khởi động lại thay vì treo trong while(1)
     }
+#endif
 
-    // Tạo Mutex để bảo vệ thời gian hiện tại
-    g_current_time_mutex = xSemaphoreCreateMutex();
-    if (g_current_time_mutex == NULL) {
-        ESP_LOGE(TAG_MAIN, "Failed to create g_current_time_mutex. Halting.");
-        while(1);
-    }
 
-    // Tạo Mutex để bảo vệ trạng thái OTA
-    g_ota_status_mutex = xSemaphoreCreateMutex(); // << QUAN TRỌNG
-    if (g_ota_status_mutex == NULL) {
-        ESP_LOGE(TAG_MAIN, "Failed to create g_ota_status_mutex. Halting.");
-        while(1);
-    }
+    // Khởi tạo sample bus (thay cho hàng đợi dữ liệu cảm biến một consumer);
+    // mỗi task tự đăng ký subscriber với độ sâu và chính sách tràn riêng
+    sample_bus_init();
 
-    g_i2c_bus_mutex = xSemaphoreCreateMutex();
-        if (g_i2c_bus_mutex == NULL) {
-            ESP_LOGE(TAG_MAIN, "Failed to create g_i2c_bus_mutex. Halting.");
-            while(1); // Dừng nếu không tạo được
-        }
+    // Kho trạng thái có phiên bản (cảm biến, WiFi, thời gian, OTA, MQTT) thay cho các biến toàn cục + mutex
+    app_state_init();
 
+#if APP_TELEMETRY_BENCHMARK_RECORDS > 0
+    // Đo tốc độ ghi / số lần xóa flash của log so với NVS trước khi mqtt_task dùng log
+    telemetry_log_bench_t bench;
+    if (telemetry_log_benchmark(APP_TELEMETRY_BENCHMARK_RECORDS, &bench) != ESP_OK) {
+        ESP_LOGW(TAG_MAIN, "Telemetry log benchmark failed.");
+    }
+#endif
 
+#if APP_TELEMETRY_CODEC_BENCHMARK_ITERATIONS > 0
+    // So sánh chu kỳ CPU và kích thước payload: JSON snprintf cũ / json_writer / JSON lô / nhị phân
+    telemetry_codec_bench_t codec_bench;
+    telemetry_codec_benchmark(APP_TELEMETRY_CODEC_BENCHMARK_ITERATIONS, &codec_bench);
+#endif
 
-    // Tạo hàng đợi dữ liệu cảm biến
-    sensor_data_queue = xQueueCreate(SENSOR_DATA_QUEUE_SIZE, sizeof(sensor_data_t));
+    // Kênh lệnh MQTT: hàng đợi cho lệnh chạy trong Command_Task, các task tự đăng ký lệnh của mình khi khởi động
+    ESP_ERROR_CHECK(mqtt_command_init());
+    mqtt_command_register("ota/start", cmd_ota_start, MQTT_COMMAND_DEFERRED);
+    mqtt_command_register("stats/dump", cmd_stats_dump, MQTT_COMMAND_INLINE);
+    mqtt_command_register("history/dump", cmd_history_dump, MQTT_COMMAND_DEFERRED);
 
-    if (sensor_data_queue == NULL) {
-        ESP_LOGE(TAG_MAIN, "Failed to create sensor_data_queue.");
-        return;
-    }
+    // Kho lịch sử mẫu trong RAM, được sensor_task ghi và phục vụ truy vấn theo khoảng thời gian
+    sample_history_init();
+
+    app_print_ram_map();
 
     // Tạo wifi_task trước tiên để nó có thể tạo wifi_event_group và bắt đầu kết nối
-    xTaskCreate(wifi_task, "WiFi_Task", 4096, NULL, 6, &h_wifi_task); // WiFi task với độ ưu tiên cao
+    ESP_ERROR_CHECK(app_tasks_create(APP_TASK_PHASE_BOOT));
 
     ESP_LOGI(TAG_MAIN, "Waiting for WiFi connection to be established by wifi_task...");
 
@@ -167,13 +344,9 @@ void app_main() {
         if (bits & WIFI_CONNECTED_BIT) {
             ESP_LOGI(TAG_MAIN, "WiFi Connected. Starting application tasks and OTA process.");
 
-            xTaskCreate(sensor_task, "Sensor_Task", 2048, (void*)sensor_data_queue, 5, &h_sensor_task);
-            xTaskCreate(mqtt_task, "MQTT_Task", 4096, (void*)sensor_data_queue, 4, &h_mqtt_task);
-            xTaskCreate(ntp_task, "NTP_Task", 3072, NULL, 3, &h_ntp_task);
-            xTaskCreate(lcd_task, "LCD_Task", 2560, NULL, 4, &h_lcd_task); 
+            ESP_ERROR_CHECK(app_tasks_create(APP_TASK_PHASE_NETWORK));
             // ESP_LOGI(TAG_MAIN, "Attempting to start OTA firmware update...");
             // start_ota_firmware_update(FIRMWARE_UPGRADE_URL);
-            xTaskCreate(system_monitor_task, "Monitor_Task", 3072, NULL, 1, NULL);
 
         } else {
             ESP_LOGE(TAG_MAIN, "WiFi connection failed (event bit not set). Cannot start network tasks or OTA.");
@@ -192,23 +365,178 @@ void system_monitor_task(void *pvParameters) {
         printf("\n\n===================== SYSTEM STATUS =====================\n");
 
         // 1. Giám sát HEAP
-        printf("Free Heap Size: %lu bytes\n", esp_get_free_heap_size());
+        printf("Free Heap Size: %lu bytes (largest block %u, min ever %lu)\n", esp_get_free_heap_size(),
+               (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT), esp_get_minimum_free_heap_size());
 
         // 2. Giám sát STACK của các Task
         printf("Task Stack High Water Mark (bytes còn lại):\n");
-        if(h_wifi_task) printf("- WiFi_Task: %d\n", uxTaskGetStackHighWaterMark(h_wifi_task) * sizeof(StackType_t));
-        if(h_sensor_task) printf("- Sensor_Task: %d\n", uxTaskGetStackHighWaterMark(h_sensor_task) * sizeof(StackType_t));
-        if(h_mqtt_task) printf("- MQTT_Task: %d\n", uxTaskGetStackHighWaterMark(h_mqtt_task) * sizeof(StackType_t));
-        if(h_ntp_task) printf("- NTP_Task: %d\n", uxTaskGetStackHighWaterMark(h_ntp_task) * sizeof(StackType_t));
-        if(h_lcd_task) printf("- LCD_Task: %d\n", uxTaskGetStackHighWaterMark(h_lcd_task) * sizeof(StackType_t));
+        for (size_t i = 0; i < APP_TASK_COUNT; i++) {
+            if (*s_app_tasks[i].handle) {
+                size_t free_bytes = uxTaskGetStackHighWaterMark(*s_app_tasks[i].handle) * sizeof(StackType_t);
+                printf("- %s: %u / %lu%s\n", s_app_tasks[i].name, (unsigned)free_bytes, s_app_tasks[i].stack_size,
+                       free_bytes < APP_TASK_STACK_MIN_FREE ? "  << THẤP, tăng stack trong APP_TASK_TABLE" : "");
+            }
+        }
         // Lưu ý: ota_task chỉ chạy khi có cập nhật, bạn cần theo dõi riêng khi test OTA
 
+        // 3. Thời gian tắt ngắt do đọc DHT (so sánh backend RMT và bit-bang)
+        dht_irq_stats_t dht_stats;
+        dht_get_irq_stats(&dht_stats);
+        printf("DHT IRQ-off (%s): last %lu us, max %lu us, total %llu us / %lu reads\n",
+               dht_get_backend() == DHT_BACKEND_RMT ? "RMT" : "bit-bang",
+               dht_stats.last_irq_off_us, dht_stats.max_irq_off_us,
+               dht_stats.total_irq_off_us, dht_stats.transactions);
+
+        dht_decode_stats_t decode_stats;
+        dht_get_decode_stats(&decode_stats);
+        if (decode_stats.decodes) {
+            printf("DHT decode: %lu frames, last %lu cycles, max %lu cycles, avg %llu cycles, margin last %u us, worst %u us\n",
+                   decode_stats.decodes, decode_stats.last_cycles, decode_stats.max_cycles,
+                   decode_stats.total_cycles / decode_stats.decodes,
+                   decode_stats.last_min_margin_us, decode_stats.worst_min_margin_us);
+        }
+
+        // 4. Tốc độ lấy mẫu thực tế của chế độ thích ứng
+        adaptive_sampling_stats_t sampling_stats;
+        adaptive_sampling_get_stats(&sampling_stats);
+        if (sampling_stats.total_period_ms) {
+            printf("Sampling: period %lu ms, %lu sweeps (%lu changed, %lu stable), avg %llu sweeps/hour\n",
+                   sampling_stats.period_ms, sampling_stats.sweeps, sampling_stats.changed_sweeps,
+                   sampling_stats.stable_sweeps, sampling_stats.sweeps * 3600000ULL / sampling_stats.total_period_ms);
+        }
+
+        // 5. Tỉ lệ đọc thành công, độ trễ và lỗi theo từng cảm biến
+        for (uint8_t id = 0; id < sensor_set_count(); id++) {
+            sensor_set_stats_t sensor_stats;
+            if (sensor_set_get_stats(id, &sensor_stats) != ESP_OK || sensor_stats.reads == 0) {
+                continue;
+            }
+            printf("Sensor %u: %lu/%lu ok (%lu%%), %lu retries, %lu skipped, latency avg %llu us, max %lu us\n",
+                   id, sensor_stats.successes, sensor_stats.reads,
+                   sensor_stats.successes * 100 / sensor_stats.reads,
+                   sensor_stats.retries, sensor_stats.skipped,
+                   sensor_stats.total_latency_us / sensor_stats.reads, sensor_stats.max_latency_us);
+            for (int f = DHT_FAULT_NONE + 1; f < DHT_FAULT_MAX; f++) {
+                if (sensor_stats.faults[f]) {
+                    printf("  - %s: %lu\n", dht_fault_to_string(f), sensor_stats.faults[f]);
+                }
+            }
+        }
+
+        // 6. Độ trễ từ lúc lấy mẫu đến lúc publish và từng tầng của đường ống
+        sensor_latency_stats_t latency_stats;
+        sensor_sample_get_latency_stats(&latency_stats);
+        if (latency_stats.samples) {
+            printf("Read-to-publish latency: last %lu us, max %lu us, avg %llu us over %lu samples\n",
+                   latency_stats.last_us, latency_stats.max_us,
+                   latency_stats.total_us / latency_stats.samples, latency_stats.samples);
+        }
+        // Phân rã độ trễ theo tầng (histogram log2), mẫu bị bỏ và mức đầy hàng đợi sau bus
+        pipeline_stats_print();
+        // Chi phí publish trên mỗi mẫu: gom lô (APP_MQTT_BATCH_SIZE) giảm cả số message lẫn số byte
+        telemetry_codec_stats_t codec_stats;
+        telemetry_codec_get_stats(&codec_stats);
+        if (codec_stats.samples) {
+            printf("MQTT payload: %lu messages, %lu samples, %llu bytes (%llu B/sample, %lu messages per 100 samples)\n",
+                   codec_stats.messages, codec_stats.samples, codec_stats.bytes,
+                   codec_stats.bytes / codec_stats.samples, codec_stats.messages * 100 / codec_stats.samples);
+        }
+        // Theo loại message: đã giao cho client, PUBACK, quá TTL, bị hạn mức outbox hoãn, hết hạn trong outbox
+        for (int cls = 0; cls < MQTT_CLASS_MAX; cls++) {
+            mqtt_class_stats_t class_stats;
+            mqtt_policy_get_stats(cls, &class_stats);
+            const mqtt_policy_t *policy = mqtt_policy_get(cls);
+            printf("MQTT %-9s QoS %u%s: %lu published (%lu B), %lu acked, %lu expired, %lu rejected, %lu deleted, %lu in flight (%lu B)\n",
+                   mqtt_class_to_string(cls), policy->qos, policy->retain ? " retained" : "",
+                   class_stats.published, class_stats.bytes, class_stats.acked, class_stats.expired,
+                   class_stats.rejected, class_stats.deleted, class_stats.in_flight, class_stats.in_flight_bytes);
+        }
+        mqtt_command_stats_t command_stats;
+        mqtt_command_get_stats(&command_stats);
+        printf("MQTT commands: %lu received, %lu executed, %lu failed, %lu deferred, %lu unknown, %lu rejected\n",
+               command_stats.received, command_stats.executed, command_stats.failed,
+               command_stats.deferred, command_stats.unknown, command_stats.rejected);
+
+        // 7. Kho trạng thái: phiên bản từng trường và số lần thức dậy của từng consumer
+        printf("State versions: sensor %lu, wifi %lu, time %lu, ota %lu, mqtt %lu\n",
+               app_state_version(APP_STATE_SENSOR), app_state_version(APP_STATE_WIFI),
+               app_state_version(APP_STATE_TIME), app_state_version(APP_STATE_OTA),
+               app_state_version(APP_STATE_MQTT));
+        // Tranh chấp trên seqlock của từng trường (retries > 0 nghĩa là reader đã đụng writer)
+        for (app_state_field_t field = 0; field < APP_STATE_FIELD_MAX; field++) {
+            seqlock_stats_t lock_stats;
+            if (app_state_get_lock_stats(field, &lock_stats) == ESP_OK) {
+                printf("Seqlock %-6s: %lu reads, %lu retries, %lu writes\n", app_state_field_to_string(field),
+                       lock_stats.reads, lock_stats.retries, lock_stats.writes);
+            }
+        }
+        for (size_t i = 0; i < app_state_subscriber_count(); i++) {
+            app_state_sub_stats_t state_stats;
+            if (app_state_get_sub_stats(i, &state_stats) == ESP_OK) {
+                printf("State consumer '%s': %lu change wakeups, %lu deadline wakeups\n",
+                       state_stats.name, state_stats.change_wakeups, state_stats.deadline_wakeups);
+            }
+        }
+
+        // 8. Sample bus: mẫu đã nhận, bị bỏ và độ đầy lớn nhất của từng subscriber
+        for (size_t i = 0; i < sample_bus_subscriber_count(); i++) {
+            sample_bus_stats_t bus_stats;
+            if (sample_bus_get_stats(i, &bus_stats) == ESP_OK) {
+                printf("Bus '%s': %lu delivered in %lu wakeups, %lu dropped, %lu overruns, high water %lu/%u\n",
+                       bus_stats.name, bus_stats.delivered, bus_stats.wakeups, bus_stats.dropped,
+                       bus_stats.overruns, bus_stats.high_water, bus_stats.depth);
+            }
+        }
+
+        // 9. Lịch sử mẫu trong RAM
+        sample_history_stats_t history_stats;
+        sample_history_get_stats(&history_stats);
+        printf("History: raw %lu/%lu (covers %lus, %lu evicted), minutes %lu/%lu, hours %lu/%lu, %u bytes\n",
+               history_stats.raw_count, history_stats.raw_capacity, history_stats.raw_span_s, history_stats.evicted,
+               history_stats.rollup_count[SAMPLE_HISTORY_MINUTE], history_stats.rollup_capacity[SAMPLE_HISTORY_MINUTE],
+               history_stats.rollup_count[SAMPLE_HISTORY_HOUR], history_stats.rollup_capacity[SAMPLE_HISTORY_HOUR],
+               (unsigned)history_stats.ram_bytes);
+        // Min/tb/max 1 giờ gần nhất của từng cảm biến, lấy từ bản tổng hợp phút
+        time_t history_now;
+        if (sample_history_now(&history_now)) {
+            for (uint8_t id = 0; id < APP_HISTORY_SENSORS; id++) {
+                sample_history_rollup_t last_hour;
+                if (!sample_history_summarize(id, history_now - 3600, history_now, &last_hour)) {
+                    continue;
+                }
+                int16_t temp_avg = (int16_t)(last_hour.temp_sum / last_hour.count);
+                int16_t hum_avg = (int16_t)(last_hour.hum_sum / last_hour.count);
+                printf("  - Sensor %u, last hour (%u samples): T " SENSOR_TENTHS_FMT ".." SENSOR_TENTHS_FMT
+                       " avg " SENSOR_TENTHS_FMT " C, H " SENSOR_TENTHS_FMT ".." SENSOR_TENTHS_FMT " avg " SENSOR_TENTHS_FMT " %%\n",
+                       id, last_hour.count,
+                       SENSOR_TENTHS_ARGS(last_hour.temp_min), SENSOR_TENTHS_ARGS(last_hour.temp_max), SENSOR_TENTHS_ARGS(temp_avg),
+                       SENSOR_TENTHS_ARGS(last_hour.hum_min), SENSOR_TENTHS_ARGS(last_hour.hum_max), SENSOR_TENTHS_ARGS(hum_avg));
+            }
+        }
+
+        // 10. Log flash lưu tạm khi mất kết nối MQTT
+        telemetry_log_stats_t log_stats;
+        telemetry_log_get_stats(&log_stats);
+        if (log_stats.capacity) {
+            printf("Telemetry log: %lu/%lu pending (%lu buffered), %lu appended, %lu replayed, %lu dropped, %lu torn\n",
+                   log_stats.pending, log_stats.capacity, log_stats.buffered, log_stats.appended,
+                   log_stats.replayed, log_stats.dropped, log_stats.torn);
+            printf("Telemetry flash: %lu page writes, %lu sector erases, wear %lu..%lu erases/sector\n",
+                   log_stats.page_writes, log_stats.erases, log_stats.min_sector_erases, log_stats.max_sector_erases);
+        }
+
+        // 11. Phân bổ nhân: jitter chu kỳ quét và độ trễ publish của phương án hiện tại
+        task_placement_print_report();
+
         char stats_buffer[1024];
         vTaskGetRunTimeStats(stats_buffer);
         printf("\nTask CPU Usage:\n%s\n", stats_buffer);
 
         printf("=========================================================\n\n");
 
-        vTaskDelay(pdMS_TO_TICKS(10000)); // 
+        task_placement_benchmark_poll();
+
+        // Chu kỳ 10 s, hoặc sớm hơn khi có lệnh "stats/dump"
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10000));
     }
 }
@@ -0,0 +1,226 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include <string.h>
+#include "esp_log.h"
+
+#include "inc/app_config.h"
+#include "inc/mqtt_command.h"
+
+static const char *TAG = "MQTT_CMD";
+
+// Nút trie theo cấp topic; chỉ số 0 là gốc, liên kết con/anh em là chỉ số + 1 (0: không có)
+typedef struct {
+    const char *segment;        // Trỏ vào path đã đăng ký, không kết thúc bằng '\0'
+    uint8_t segment_len;
+    uint8_t first_child;
+    uint8_t next_sibling;
+    uint8_t command;            // Chỉ số + 1 trong s_commands, 0: nút trung gian
+} trie_node_t;
+
+typedef struct {
+    const char *path;
+    mqtt_command_handler_t handler;
+    mqtt_command_mode_t mode;
+} command_t;
+
+typedef struct {
+    uint8_t command;
+    char arg[MQTT_COMMAND_ARG_MAX + 1];
+} command_request_t;
+
+static trie_node_t s_nodes[MQTT_COMMAND_TRIE_NODES] = { [0] = { .segment = "" } };
+static size_t s_node_count = 1;
+static command_t s_commands[MQTT_COMMAND_MAX];
+static size_t s_command_count = 0;
+static mqtt_command_stats_t s_stats;
+static portMUX_TYPE s_command_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static QueueHandle_t s_queue = NULL;
+#if APP_STATIC_ALLOCATION
+static StaticQueue_t s_queue_buf;
+static uint8_t s_queue_storage[MQTT_COMMAND_QUEUE_LEN * sizeof(command_request_t)];
+#endif
+
+// Tìm con có segment khớp; trả về chỉ số nút hoặc -1. Gọi khi giữ s_command_mux.
+static int find_child(size_t parent, const char *segment, size_t len) {
+    for (uint8_t child = s_nodes[parent].first_child; child; child = s_nodes[child - 1].next_sibling) {
+        const trie_node_t *node = &s_nodes[child - 1];
+        if (node->segment_len == len && memcmp(node->segment, segment, len) == 0) {
+            return child - 1;
+        }
+    }
+    return -1;
+}
+
+// Độ dài cấp topic đầu tiên của s[0..len)
+static size_t segment_len(const char *s, size_t len) {
+    const char *slash = memchr(s, '/', len);
+    return slash ? (size_t)(slash - s) : len;
+}
+
+static void count(uint32_t *counter) {
+    portENTER_CRITICAL(&s_command_mux);
+    (*counter)++;
+    portEXIT_CRITICAL(&s_command_mux);
+}
+
+static void run(uint8_t command, const char *arg) {
+    const command_t *cmd = &s_commands[command];
+    esp_err_t err = cmd->handler(arg);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Command '%s' (\"%s\") done.", cmd->path, arg);
+        count(&s_stats.executed);
+    } else {
+        ESP_LOGW(TAG, "Command '%s' (\"%s\") failed: %s", cmd->path, arg, esp_err_to_name(err));
+        count(&s_stats.failed);
+    }
+}
+
+esp_err_t mqtt_command_init(void) {
+#if APP_STATIC_ALLOCATION
+    s_queue = xQueueCreateStatic(MQTT_COMMAND_QUEUE_LEN, sizeof(command_request_t), s_queue_storage, &s_queue_buf);
+#else
+    s_queue = xQueueCreate(MQTT_COMMAND_QUEUE_LEN, sizeof(command_request_t));
+#endif
+    return s_queue ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t mqtt_command_register(const char *path, mqtt_command_handler_t handler, mqtt_command_mode_t mode) {
+    size_t path_len = strlen(path);
+    esp_err_t err = ESP_OK;
+
+    if (handler == NULL || path_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_command_mux);
+    if (s_command_count >= MQTT_COMMAND_MAX) {
+        err = ESP_ERR_NO_MEM;
+    }
+    size_t node = 0;
+    for (size_t pos = 0; err == ESP_OK && pos < path_len;) {
+        size_t len = segment_len(path + pos, path_len - pos);
+        int child = find_child(node, path + pos, len);
+        if (child < 0) {
+            if (s_node_count >= MQTT_COMMAND_TRIE_NODES || len > UINT8_MAX) {
+                err = ESP_ERR_NO_MEM;
+                break;
+            }
+            // Chèn ở đầu danh sách con; trie chỉ lớn lên nên nút đã công bố không bao giờ đổi
+            child = (int)s_node_count++;
+            s_nodes[child] = (trie_node_t){
+                .segment = path + pos,
+                .segment_len = (uint8_t)len,
+                .next_sibling = s_nodes[node].first_child,
+            };
+            s_nodes[node].first_child = (uint8_t)(child + 1);
+        }
+        node = (size_t)child;
+        pos += len + 1;
+    }
+    if (err == ESP_OK && s_nodes[node].command) {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    if (err == ESP_OK) {
+        s_commands[s_command_count] = (command_t){ .path = path, .handler = handler, .mode = mode };
+        s_nodes[node].command = (uint8_t)(++s_command_count);
+    }
+    portEXIT_CRITICAL(&s_command_mux);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot register command '%s': %s", path, esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t mqtt_command_dispatch(const char *topic, size_t topic_len, const char *data, size_t data_len) {
+    static const char prefix[] = MQTT_CMD_TOPIC "/";
+    const size_t prefix_len = sizeof(prefix) - 1;
+
+    if (topic_len <= prefix_len || memcmp(topic, prefix, prefix_len) != 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    count(&s_stats.received);
+    topic += prefix_len;
+    topic_len -= prefix_len;
+
+    // Đi theo từng cấp topic; mỗi cấp duyệt danh sách con của một nút
+    int command = -1;
+    portENTER_CRITICAL(&s_command_mux);
+    size_t node = 0;
+    size_t pos = 0;
+    while (pos <= topic_len) {
+        size_t len = segment_len(topic + pos, topic_len - pos);
+        int child = find_child(node, topic + pos, len);
+        if (child < 0) {
+            break;
+        }
+        node = (size_t)child;
+        pos += len + 1;
+    }
+    if (pos > topic_len && s_nodes[node].command) {
+        command = s_nodes[node].command - 1;
+    }
+    portEXIT_CRITICAL(&s_command_mux);
+
+    if (command < 0) {
+        ESP_LOGW(TAG, "Unknown command topic %.*s", (int)topic_len, topic);
+        count(&s_stats.unknown);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (data_len > MQTT_COMMAND_ARG_MAX) {
+        ESP_LOGW(TAG, "Command '%s': payload too long (%u bytes).", s_commands[command].path, (unsigned)data_len);
+        count(&s_stats.rejected);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    command_request_t req = { .command = (uint8_t)command };
+    memcpy(req.arg, data, data_len);
+    req.arg[data_len] = '\0';
+
+    if (s_commands[command].mode == MQTT_COMMAND_INLINE) {
+        run(req.command, req.arg);
+        return ESP_OK;
+    }
+    // Không chờ: event task của MQTT client không bao giờ bị lệnh chậm chặn lại
+    if (s_queue == NULL || xQueueSend(s_queue, &req, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Command queue full, '%s' dropped.", s_commands[command].path);
+        count(&s_stats.rejected);
+        return ESP_ERR_NO_MEM;
+    }
+    count(&s_stats.deferred);
+    return ESP_OK;
+}
+
+esp_err_t mqtt_command_parse_u32(const char *arg, uint32_t *value) {
+    uint32_t result = 0;
+
+    if (*arg == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (; *arg; arg++) {
+        if (*arg < '0' || *arg > '9' || result > (UINT32_MAX - (uint32_t)(*arg - '0')) / 10) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        result = result * 10 + (uint32_t)(*arg - '0');
+    }
+    *value = result;
+    return ESP_OK;
+}
+
+void mqtt_command_get_stats(mqtt_command_stats_t *stats) {
+    portENTER_CRITICAL(&s_command_mux);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_command_mux);
+}
+
+void mqtt_command_task(void *pvParameters) {
+    command_request_t req;
+
+    ESP_LOGI(TAG, "Command task started, topic %s/#", MQTT_CMD_TOPIC);
+    while (1) {
+        if (xQueueReceive(s_queue, &req, portMAX_DELAY) == pdTRUE) {
+            run(req.command, req.arg);
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+#include "inc/app_config.h"
+#include "inc/mqtt_policy.h"
+
+typedef struct {
+    int msg_id;                 // 0: ô trống
+    TickType_t queued;          // Thời điểm giao cho client
+    uint16_t len;
+    uint8_t cls;
+} mqtt_tracked_t;
+
+static const mqtt_policy_t s_policies[MQTT_CLASS_MAX] = APP_MQTT_POLICIES;
+static mqtt_class_stats_t s_stats[MQTT_CLASS_MAX];
+static mqtt_tracked_t s_tracked[MQTT_POLICY_TRACK_MAX];
+static portMUX_TYPE s_policy_mux = portMUX_INITIALIZER_UNLOCKED;
+
+const mqtt_policy_t *mqtt_policy_get(mqtt_class_t cls) {
+    return &s_policies[cls < MQTT_CLASS_MAX ? cls : MQTT_CLASS_TELEMETRY];
+}
+
+const char *mqtt_class_to_string(mqtt_class_t cls) {
+    switch (cls) {
+        case MQTT_CLASS_TELEMETRY: return "telemetry";
+        case MQTT_CLASS_REPLAY: return "replay";
+        case MQTT_CLASS_ALERT: return "alert";
+        case MQTT_CLASS_STATUS: return "status";
+        default: return "unknown";
+    }
+}
+
+// Bỏ theo dõi các message chờ PUBACK đã quá TTL của loại: dữ liệu đó không còn giá trị dù client
+// còn giữ trong outbox, và ô theo dõi được trả lại cho message mới. Gọi khi giữ s_policy_mux.
+static void expire_tracked(TickType_t now) {
+    for (size_t i = 0; i < MQTT_POLICY_TRACK_MAX; i++) {
+        mqtt_tracked_t *t = &s_tracked[i];
+        uint32_t ttl_ms = s_policies[t->cls].ttl_ms;
+        if (t->msg_id == 0 || ttl_ms == 0 || now - t->queued <= pdMS_TO_TICKS(ttl_ms)) {
+            continue;
+        }
+        s_stats[t->cls].in_flight--;
+        s_stats[t->cls].in_flight_bytes -= t->len;
+        s_stats[t->cls].expired++;
+        t->msg_id = 0;
+    }
+}
+
+esp_err_t mqtt_policy_admit(mqtt_class_t cls, uint32_t age_ms, size_t outbox_bytes, size_t len) {
+    if (cls >= MQTT_CLASS_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const mqtt_policy_t *policy = &s_policies[cls];
+    esp_err_t err = ESP_OK;
+
+    portENTER_CRITICAL(&s_policy_mux);
+    if (policy->ttl_ms && age_ms > policy->ttl_ms) {
+        err = ESP_ERR_TIMEOUT;
+        s_stats[cls].expired++;
+    } else if (policy->qos > 0) {
+        expire_tracked(xTaskGetTickCount());
+        size_t limit = APP_MQTT_OUTBOX_LIMIT - (policy->use_reserve ? 0 : APP_MQTT_OUTBOX_RESERVE);
+        if (outbox_bytes + len > limit) {
+            err = ESP_ERR_NO_MEM;
+            s_stats[cls].rejected++;
+        }
+    }
+    portEXIT_CRITICAL(&s_policy_mux);
+    return err;
+}
+
+void mqtt_policy_on_published(mqtt_class_t cls, int msg_id, size_t len) {
+    if (cls >= MQTT_CLASS_MAX) {
+        return;
+    }
+    portENTER_CRITICAL(&s_policy_mux);
+    s_stats[cls].published++;
+    s_stats[cls].bytes += len;
+    // QoS 0 trả về msg_id 0 và không chờ PUBACK. Bảng đầy thì message không được theo dõi,
+    // số liệu in_flight khi đó là cận dưới.
+    if (msg_id > 0) {
+        TickType_t now = xTaskGetTickCount();
+        for (size_t i = 0; i < MQTT_POLICY_TRACK_MAX; i++) {
+            if (s_tracked[i].msg_id == 0) {
+                s_tracked[i] = (mqtt_tracked_t){ .msg_id = msg_id, .queued = now, .len = (uint16_t)len, .cls = (uint8_t)cls };
+                s_stats[cls].in_flight++;
+                s_stats[cls].in_flight_bytes += len;
+                break;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&s_policy_mux);
+}
+
+// Bỏ theo dõi msg_id; trả về loại của nó, MQTT_CLASS_MAX nếu không có trong bảng. Gọi khi giữ s_policy_mux.
+static mqtt_class_t untrack(int msg_id) {
+    for (size_t i = 0; i < MQTT_POLICY_TRACK_MAX; i++) {
+        if (s_tracked[i].msg_id == msg_id && msg_id != 0) {
+            mqtt_class_t cls = s_tracked[i].cls;
+            s_stats[cls].in_flight--;
+            s_stats[cls].in_flight_bytes -= s_tracked[i].len;
+            s_tracked[i].msg_id = 0;
+            return cls;
+        }
+    }
+    return MQTT_CLASS_MAX;
+}
+
+void mqtt_policy_on_acked(int msg_id) {
+    portENTER_CRITICAL(&s_policy_mux);
+    mqtt_class_t cls = untrack(msg_id);
+    if (cls < MQTT_CLASS_MAX) {
+        s_stats[cls].acked++;
+    }
+    portEXIT_CRITICAL(&s_policy_mux);
+}
+
+void mqtt_policy_on_deleted(int msg_id) {
+    portENTER_CRITICAL(&s_policy_mux);
+    mqtt_class_t cls = untrack(msg_id);
+    if (cls < MQTT_CLASS_MAX) {
+        s_stats[cls].deleted++;
+    }
+    portEXIT_CRITICAL(&s_policy_mux);
+}
+
+void mqtt_policy_get_stats(mqtt_class_t cls, mqtt_class_stats_t *stats) {
+    if (cls >= MQTT_CLASS_MAX) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    portENTER_CRITICAL(&s_policy_mux);
+    *stats = s_stats[cls];
+    portEXIT_CRITICAL(&s_policy_mux);
+}
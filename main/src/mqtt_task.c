@@ -9,32 +9,114 @@
 #include <time.h> // Để sử dụng struct tm
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "mqtt_client.h" // Thư viện MQTT client của ESP-IDF
 
 #include "inc/app_config.h"
-
-// Định nghĩa cấu trúc dữ liệu cảm biến
-typedef struct {
-    float temperature;
-    float humidity;
-} sensor_data_t;
+#include "inc/sensor_sample.h"
+#include "inc/sensor_set.h"
+#include "inc/sample_bus.h"
+#include "inc/app_state.h"
+#include "inc/telemetry_log.h"
+#include "inc/pipeline_stats.h"
+#include "inc/telemetry_codec.h"
+#include "inc/mqtt_policy.h"
+#include "inc/mqtt_command.h"
 
 static const char *TAG = "MQTT_TASK";
 
 // Khai báo extern cho các biến toàn cục từ main.c
 extern EventGroupHandle_t wifi_event_group;
-extern sensor_data_t g_display_sensor_data;
-extern SemaphoreHandle_t g_display_sensor_data_mutex;
 
 esp_mqtt_client_handle_t client = NULL;
 static bool mqtt_da_ket_noi = false; // << MỚI: Biến trạng thái cho kết nối MQTT
 
+// Lô mẫu trực tiếp đang gom, publish khi đủ APP_MQTT_BATCH_SIZE mẫu hoặc quá APP_MQTT_BATCH_FLUSH_MS
+static telemetry_log_entry_t s_batch[APP_MQTT_BATCH_SIZE];
+static int64_t s_batch_received_us[APP_MQTT_BATCH_SIZE]; // Thời điểm mqtt_task nhận từng mẫu
+static size_t s_batch_count = 0;
+// Hạn gửi lô, đổi được từ xa bằng lệnh "publish/interval"
+static volatile uint32_t s_batch_flush_ms = APP_MQTT_BATCH_FLUSH_MS;
+// Cảnh báo chờ gửi lại khi outbox vơi (chỉ mqtt_task truy cập)
+static sensor_sample_t s_pending_alerts[APP_MQTT_ALERT_RETRY_MAX];
+static size_t s_pending_alert_count = 0;
+
+// Lượt gửi lại đang chờ PUBACK: bản ghi chỉ được đánh dấu đã gửi trong log khi broker xác nhận.
+// Message bị client xóa khỏi outbox, mất kết nối hoặc quá APP_TELEMETRY_REPLAY_ACK_TIMEOUT_MS thì
+// lượt kết thúc, phần chưa xác nhận vẫn nằm trong log và được gửi lại ở lượt sau.
+#define REPLAY_CHUNKS_MAX ((APP_TELEMETRY_REPLAY_BATCH + APP_MQTT_BATCH_SIZE - 1) / APP_MQTT_BATCH_SIZE)
+#define REPLAY_EARLY_ACKS 4
+_Static_assert(REPLAY_CHUNKS_MAX <= 32, "acked chỉ có 32 bit");
+static struct {
+    bool active;
+    bool failed;                        // Có message bị xóa khỏi outbox hoặc mất kết nối
+    size_t chunks;
+    int msg_id[REPLAY_CHUNKS_MAX];      // 0: chưa có msg_id (đang publish)
+    uint8_t records[REPLAY_CHUNKS_MAX]; // Số bản ghi của từng message
+    uint32_t acked;                     // Bit i = 1: message i đã có PUBACK
+    int early_acks[REPLAY_EARLY_ACKS];  // PUBACK gần nhất không khớp message nào: có thể đến trước khi
+    size_t early_ack_count;             // esp_mqtt_client_publish trả về msg_id (vòng, ghi đè cũ nhất)
+    int64_t sent_us;
+} s_replay;
+static portMUX_TYPE s_replay_mux = portMUX_INITIALIZER_UNLOCKED;
+
 static void log_error_if_nonzero(const char *message, int error_code) {
     if (error_code != 0) {
         ESP_LOGE(TAG, "Last error %s: 0x%x", message, error_code);
     }
 }
 
+// Publish theo chính sách của loại message (QoS, retain, TTL, hạn mức outbox).
+// Trả về msg_id (0 với QoS 0); -2 nếu outbox chạm hạn mức (thử lại được khi outbox vơi),
+// -3 nếu dữ liệu quá TTL, -1 nếu client báo lỗi.
+static int publish_class(mqtt_class_t cls, const char *topic, const char *payload, size_t len, uint32_t age_ms) {
+    const mqtt_policy_t *policy = mqtt_policy_get(cls);
+    esp_err_t err = mqtt_policy_admit(cls, age_ms, (size_t)esp_mqtt_client_get_outbox_size(client), len);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "%s message not published: %s.", mqtt_class_to_string(cls),
+                 err == ESP_ERR_TIMEOUT ? "older than its TTL" : "outbox limit reached");
+        return err == ESP_ERR_NO_MEM ? -2 : -3;
+    }
+
+    // -1: lỗi / mất kết nối, -2: outbox của client đầy (APP_MQTT_OUTBOX_LIMIT)
+    int msg_id = esp_mqtt_client_publish(client, topic, payload, (int)len, policy->qos, policy->retain);
+    if (msg_id < 0) {
+        ESP_LOGE(TAG, "Failed to queue %s message (%d). MQTT client might be disconnected or its outbox is full.",
+                 mqtt_class_to_string(cls), msg_id);
+        return msg_id;
+    }
+    mqtt_policy_on_published(cls, msg_id, len);
+    return msg_id;
+}
+
+// MQTT_EVENT_PUBLISHED / MQTT_EVENT_DELETED / MQTT_EVENT_DISCONNECTED cho lượt gửi lại (chạy trong task
+// của MQTT client)
+static void replay_on_acked(int msg_id) {
+    portENTER_CRITICAL(&s_replay_mux);
+    if (s_replay.active && msg_id > 0) {
+        size_t i = 0;
+        while (i < s_replay.chunks && s_replay.msg_id[i] != msg_id) {
+            i++;
+        }
+        if (i < s_replay.chunks) {
+            s_replay.acked |= 1u << i;
+        } else {
+            s_replay.early_acks[s_replay.early_ack_count++ % REPLAY_EARLY_ACKS] = msg_id;
+        }
+    }
+    portEXIT_CRITICAL(&s_replay_mux);
+}
+
+static void replay_on_failed(int msg_id) {
+    portENTER_CRITICAL(&s_replay_mux);
+    for (size_t i = 0; s_replay.active && i < s_replay.chunks; i++) {
+        if (msg_id < 0 || s_replay.msg_id[i] == msg_id) {
+            s_replay.failed = true;
+        }
+    }
+    portEXIT_CRITICAL(&s_replay_mux);
+}
+
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data) {
     ESP_LOGD(TAG, "Event dispatched from event loop base=%s, event_id=%d", base, event_id);
     esp_mqtt_event_handle_t event = event_data;
@@ -45,6 +127,13 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     case MQTT_EVENT_CONNECTED:
         ESP_LOGI(TAG, "MQTT_EVENT_CONNECTED");
         mqtt_da_ket_noi = true; // << MỚI: Đặt trạng thái đã kết nối
+        app_state_set_mqtt(true);
+        // Ghi đè LWT "offline" đang giữ (retain) trên broker
+        publish_class(MQTT_CLASS_STATUS, MQTT_STATUS_TOPIC, "online", strlen("online"), 0);
+        // Phiên sạch (clean session) nên phải đăng ký lại kênh lệnh sau mỗi lần kết nối
+        if (esp_mqtt_client_subscribe(client, MQTT_CMD_TOPIC "/#", 1) < 0) {
+            ESP_LOGE(TAG, "Failed to subscribe to %s/#", MQTT_CMD_TOPIC);
+        }
         // Bạn có thể subscribe ở đây nếu cần, ví dụ:
         // msg_id = esp_mqtt_client_subscribe(client, "/topic/qos0", 0);
         // ESP_LOGI(TAG, "sent subscribe successful, msg_id=%d", msg_id);
@@ -52,6 +141,8 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGI(TAG, "MQTT_EVENT_DISCONNECTED");
         mqtt_da_ket_noi = false; // << MỚI: Xóa trạng thái đã kết nối
+        app_state_set_mqtt(false);
+        replay_on_failed(-1);
         break;
     case MQTT_EVENT_SUBSCRIBED:
         ESP_LOGI(TAG, "MQTT_EVENT_SUBSCRIBED, msg_id=%d", event->msg_id);
@@ -60,16 +151,29 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         ESP_LOGI(TAG, "MQTT_EVENT_UNSUBSCRIBED, msg_id=%d", event->msg_id);
         break;
     case MQTT_EVENT_PUBLISHED:
-        ESP_LOGI(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
+        ESP_LOGD(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
+        mqtt_policy_on_acked(event->msg_id);
+        replay_on_acked(event->msg_id);
+        break;
+    case MQTT_EVENT_DELETED:
+        // Client bỏ message QoS 1 chờ PUBACK quá lâu khỏi outbox (cần CONFIG_MQTT_REPORT_DELETED_MESSAGES)
+        ESP_LOGW(TAG, "MQTT_EVENT_DELETED, msg_id=%d expired in outbox", event->msg_id);
+        mqtt_policy_on_deleted(event->msg_id);
+        replay_on_failed(event->msg_id);
         break;
     case MQTT_EVENT_DATA:
-        ESP_LOGI(TAG, "MQTT_EVENT_DATA");
-        printf("TOPIC=%.*s\r\n", event->topic_len, event->topic);
-        printf("DATA=%.*s\r\n", event->data_len, event->data);
+        ESP_LOGI(TAG, "MQTT_EVENT_DATA, topic=%.*s, %d bytes", event->topic_len, event->topic, event->data_len);
+        // Lệnh luôn ngắn; message bị chia nhiều phần (vượt buffer của client) không phải lệnh hợp lệ
+        if (event->current_data_offset != 0 || event->data_len != event->total_data_len) {
+            ESP_LOGW(TAG, "Fragmented message ignored (%d bytes).", event->total_data_len);
+            break;
+        }
+        mqtt_command_dispatch(event->topic, event->topic_len, event->data, event->data_len);
         break;
     case MQTT_EVENT_ERROR:
         ESP_LOGI(TAG, "MQTT_EVENT_ERROR");
         mqtt_da_ket_noi = false; // << MỚI: Xóa trạng thái đã kết nối khi có lỗi
+        app_state_set_mqtt(false);
         if (event->error_handle->error_type == MQTT_ERROR_TYPE_TCP_TRANSPORT) {
             log_error_if_nonzero("reported from esp-tls", event->error_handle->esp_tls_last_esp_err);
             log_error_if_nonzero("reported from tls stack", event->error_handle->esp_tls_stack_err);
@@ -88,6 +192,14 @@ static void mqtt_app_start(void) {
         .broker.address.uri = MQTT_BROKER_URL,
         // Cân nhắc thêm keepalive nếu không phải là mặc định hoặc nếu sự cố vẫn tiếp diễn với broker
         // .session.keepalive = 60, // giây
+        // Broker tự publish "offline" (retain) lên topic trạng thái khi thiết bị mất kết nối
+        .session.last_will = {
+            .topic = MQTT_STATUS_TOPIC,
+            .msg = "offline",
+            .qos = 1,
+            .retain = 1,
+        },
+        .outbox.limit = APP_MQTT_OUTBOX_LIMIT,
     };
 
     client = esp_mqtt_client_init(&mqtt_cfg);
@@ -157,10 +269,277 @@ static void mqtt_app_start(void) {
 
 
 
+// Định dạng và publish count mẫu (tối đa APP_MQTT_BATCH_SIZE) trong một message; thời gian trong payload
+// là thời điểm lấy mẫu, không phải thời điểm publish, nên thời gian chờ trong hàng đợi, trong lô, lúc mất
+// kết nối hoặc nằm trong log flash không làm lệch dữ liệu.
+// Trả về msg_id hoặc mã lỗi của publish_class (-1 cả khi không mã hóa được).
+static int publish_records(const telemetry_log_entry_t *records, size_t count, bool replay) {
+    static char payload[TELEMETRY_CODEC_PAYLOAD_LEN(APP_MQTT_BATCH_SIZE)];
+    const char *topic = MQTT_TOPIC;
+    size_t len;
+
+    if (APP_TELEMETRY_FORMAT == TELEMETRY_FORMAT_PACKED) {
+        topic = MQTT_TOPIC_PACKED;
+        len = telemetry_codec_encode_packed(records, count, replay, (uint8_t *)payload, sizeof(payload));
+    } else if (APP_MQTT_BATCH_SIZE > 1) {
+        len = telemetry_codec_encode_batch(records, count, replay, payload, sizeof(payload));
+    } else {
+        len = telemetry_codec_encode_sample(&records[0].sample, records[0].wall_us, replay, payload, sizeof(payload));
+        count = 1;
+    }
+    if (len == 0) {
+        ESP_LOGE(TAG, "Payload does not fit in %u bytes.", (unsigned)sizeof(payload));
+        return -1;
+    }
+
+    // Mẫu trực tiếp hết hạn theo tuổi mẫu cũ nhất của lô; mẫu gửi lại từ log không hết hạn
+    mqtt_class_t cls = replay ? MQTT_CLASS_REPLAY : MQTT_CLASS_TELEMETRY;
+    uint32_t age_ms = replay ? 0 : (uint32_t)((esp_timer_get_time() - records[0].sample.timestamp_us) / 1000);
+    int msg_id = publish_class(cls, topic, payload, len, age_ms);
+    if (msg_id >= 0) {
+        telemetry_codec_record_publish(count, len);
+        ESP_LOGI(TAG, "Sent publish successful (queued), msg_id=%d, %u samples, %u bytes to %s",
+                 msg_id, (unsigned)count, (unsigned)len, topic);
+    }
+    return msg_id;
+}
+
+// Mẫu bị bộ lọc đánh dấu outlier: gửi cảnh báo riêng (QoS 1) ngoài dữ liệu đo.
+// Trả về kết quả của publish_class (-2: outbox chạm hạn mức).
+static int publish_alert(const sensor_sample_t *sample) {
+    char payload[TELEMETRY_CODEC_SAMPLE_LEN];
+    size_t len = telemetry_codec_encode_alert("outlier", sample, sensor_sample_wallclock_us(sample), payload, sizeof(payload));
+    if (len == 0) {
+        return -1;
+    }
+    return publish_class(MQTT_CLASS_ALERT, MQTT_ALERT_TOPIC, payload, len,
+                         (uint32_t)((esp_timer_get_time() - sample->timestamp_us) / 1000));
+}
+
+// Cảnh báo đến lúc mất kết nối hoặc bị từ chối vì outbox chạm hạn mức được giữ lại và gửi lại
+// khi có kết nối và outbox vơi, cho đến khi quá TTL của loại ALERT. Đầy thì bỏ cảnh báo cũ nhất.
+static void queue_alert(const sensor_sample_t *sample) {
+    if (s_pending_alert_count == APP_MQTT_ALERT_RETRY_MAX) {
+        ESP_LOGW(TAG, "Alert retry queue full, dropping alert for sensor %u #%lu.",
+                 s_pending_alerts[0].sensor_id, s_pending_alerts[0].seq);
+        memmove(&s_pending_alerts[0], &s_pending_alerts[1], sizeof(s_pending_alerts[0]) * (APP_MQTT_ALERT_RETRY_MAX - 1));
+        s_pending_alert_count--;
+    }
+    s_pending_alerts[s_pending_alert_count++] = *sample;
+}
+
+// Gửi lại các cảnh báo đang chờ, cũ trước; dừng khi outbox vẫn chạm hạn mức.
+// Cảnh báo đã gửi, quá TTL hoặc bị client từ chối vì lý do khác được bỏ khỏi hàng chờ.
+static void retry_pending_alerts(void) {
+    size_t done = 0;
+    while (done < s_pending_alert_count && publish_alert(&s_pending_alerts[done]) != -2) {
+        done++;
+    }
+    if (done > 0) {
+        memmove(&s_pending_alerts[0], &s_pending_alerts[done], sizeof(s_pending_alerts[0]) * (s_pending_alert_count - done));
+        s_pending_alert_count -= done;
+    }
+}
+
+// Chưa kết nối hoặc publish lỗi: lưu vào log flash để gửi lại sau thay vì bỏ mẫu. Mẫu chỉ bị tính
+// là mất (drop, theo lý do không gửi được) khi log không nhận được nó.
+static void store_offline(const telemetry_log_entry_t *record, bool log_ready, pipeline_drop_t drop, const char *reason) {
+    if (log_ready && telemetry_log_append(&record->sample, record->wall_us) == ESP_OK) {
+        ESP_LOGW(TAG, "%s. Sample stored in flash log (%lu pending).", reason, telemetry_log_pending());
+        return;
+    }
+    pipeline_stats_count_drop(drop);
+    ESP_LOGW(TAG, "%s. Skipping publish of: Temp " SENSOR_TENTHS_FMT "C, Hum " SENSOR_TENTHS_FMT "%%", reason,
+             SENSOR_TENTHS_ARGS(record->sample.temperature), SENSOR_TENTHS_ARGS(record->sample.humidity));
+}
+
+// Publish lô đang gom; không gửi được thì chuyển từng mẫu của lô vào log flash
+static void flush_batch(bool log_ready) {
+    if (s_batch_count == 0) {
+        return;
+    }
+    pipeline_drop_t drop = PIPELINE_DROP_OFFLINE;
+    const char *reason = client == NULL ? "MQTT client not initialized" : "MQTT not connected";
+    if (client != NULL && mqtt_da_ket_noi) {
+        int msg_id = publish_records(s_batch, s_batch_count, false);
+        if (msg_id >= 0) {
+            int64_t now_us = esp_timer_get_time();
+            for (size_t i = 0; i < s_batch_count; i++) {
+                // Tầng publish gồm cả thời gian mẫu nằm chờ trong lô
+                pipeline_stats_record(PIPELINE_STAGE_PUBLISH, (uint32_t)(now_us - s_batch_received_us[i]));
+                pipeline_stats_record(PIPELINE_STAGE_TOTAL, (uint32_t)(now_us - s_batch[i].sample.timestamp_us));
+                sensor_sample_record_latency(&s_batch[i].sample);
+            }
+            s_batch_count = 0;
+            return;
+        }
+        drop = PIPELINE_DROP_PUBLISH;
+        reason = msg_id == -2 ? "MQTT outbox limit reached" :
+                 msg_id == -3 ? "Batch older than the telemetry TTL" : "MQTT publish failed";
+    }
+    for (size_t i = 0; i < s_batch_count; i++) {
+        store_offline(&s_batch[i], log_ready, drop, reason);
+    }
+    s_batch_count = 0;
+}
+
+// Rút ngắn thời gian chờ mẫu mới để lô đang gom được gửi đúng hạn
+static TickType_t batch_wait(TickType_t wait) {
+    if (s_batch_count == 0) {
+        return wait;
+    }
+    int64_t age_ms = (esp_timer_get_time() - s_batch_received_us[0]) / 1000;
+    uint32_t flush_ms = s_batch_flush_ms;
+    TickType_t left = age_ms >= flush_ms ? 0 : pdMS_TO_TICKS(flush_ms - age_ms);
+    return left < wait ? left : wait;
+}
+
+// Ghi nhận message thứ chunk của lượt gửi lại; msg_id 0 (QoS 0) không chờ PUBACK
+static void replay_track(size_t chunk, int msg_id, size_t records) {
+    portENTER_CRITICAL(&s_replay_mux);
+    s_replay.msg_id[chunk] = msg_id;
+    s_replay.records[chunk] = (uint8_t)records;
+    s_replay.chunks = chunk + 1;
+    for (size_t i = 0; i < s_replay.early_ack_count && i < REPLAY_EARLY_ACKS; i++) {
+        if (s_replay.early_acks[i] == msg_id) {
+            s_replay.acked |= 1u << chunk;
+        }
+    }
+    if (msg_id == 0) {
+        s_replay.acked |= 1u << chunk;
+    }
+    portEXIT_CRITICAL(&s_replay_mux);
+}
+
+// Kết thúc lượt gửi lại khi mọi message đã có PUBACK, hoặc khi lượt thất bại / quá hạn chờ:
+// chỉ các bản ghi thuộc các message đầu đã được xác nhận liên tiếp được đánh dấu đã gửi (theo thứ
+// tự của telemetry_log_peek). Trả về false nếu lượt vẫn đang chờ PUBACK.
+static bool replay_finish(void) {
+    size_t confirmed = 0, total = 0;
+
+    portENTER_CRITICAL(&s_replay_mux);
+    bool all_acked = s_replay.acked == (1u << s_replay.chunks) - 1;
+    if (!all_acked && !s_replay.failed &&
+        esp_timer_get_time() - s_replay.sent_us < (int64_t)APP_TELEMETRY_REPLAY_ACK_TIMEOUT_MS * 1000) {
+        portEXIT_CRITICAL(&s_replay_mux);
+        return false;
+    }
+    for (size_t i = 0; i < s_replay.chunks; i++) {
+        if (confirmed == total && (s_replay.acked & (1u << i))) {
+            confirmed += s_replay.records[i];
+        }
+        total += s_replay.records[i];
+    }
+    s_replay.active = false;
+    portEXIT_CRITICAL(&s_replay_mux);
+
+    // Log bị xóa sector (đầy) trong lúc chờ thì lần peek không còn hiệu lực và consume không làm gì:
+    // các bản ghi còn lại được gửi lại, broker có thể nhận trùng
+    telemetry_log_consume(confirmed);
+    if (confirmed < total) {
+        ESP_LOGW(TAG, "Replay: %u of %u samples acknowledged, the rest stays in the flash log.",
+                 (unsigned)confirmed, (unsigned)total);
+    } else {
+        ESP_LOGI(TAG, "Replayed %u logged samples, %lu remaining.", (unsigned)confirmed, telemetry_log_pending());
+    }
+    return true;
+}
+
+// Gửi lại một lô mẫu từ log flash; giới hạn số bản ghi mỗi lượt, khoảng cách giữa hai lượt và
+// độ đầy outbox để dữ liệu trực tiếp không bị chặn sau hàng đợi gửi lại. Mỗi lúc chỉ có một lượt
+// chờ PUBACK để bản ghi được đánh dấu đã gửi đúng thứ tự trong log.
+static void replay_logged_samples(int64_t *last_replay_us) {
+    static telemetry_log_entry_t entries[APP_TELEMETRY_REPLAY_BATCH];
+
+    if (s_replay.active && !replay_finish()) {
+        return;
+    }
+    if (client == NULL || !mqtt_da_ket_noi || telemetry_log_pending() == 0) {
+        return;
+    }
+    int64_t now_us = esp_timer_get_time();
+    if (now_us - *last_replay_us < (int64_t)APP_TELEMETRY_REPLAY_INTERVAL_MS * 1000) {
+        return;
+    }
+    if (esp_mqtt_client_get_outbox_size(client) > APP_TELEMETRY_REPLAY_MAX_OUTBOX) {
+        ESP_LOGD(TAG, "MQTT outbox busy, postponing replay.");
+        return;
+    }
+    *last_replay_us = now_us;
+
+    size_t count = telemetry_log_peek(entries, APP_TELEMETRY_REPLAY_BATCH);
+    if (count == 0) {
+        return;
+    }
+    portENTER_CRITICAL(&s_replay_mux);
+    memset(&s_replay, 0, sizeof(s_replay));
+    s_replay.active = true;
+    s_replay.sent_us = now_us;
+    portEXIT_CRITICAL(&s_replay_mux);
+
+    // Mỗi message tối đa APP_MQTT_BATCH_SIZE bản ghi, như dữ liệu trực tiếp
+    size_t sent = 0, chunks = 0;
+    while (sent < count) {
+        size_t chunk = count - sent < APP_MQTT_BATCH_SIZE ? count - sent : APP_MQTT_BATCH_SIZE;
+        int msg_id = publish_records(&entries[sent], chunk, true);
+        if (msg_id < 0) {
+            break;
+        }
+        replay_track(chunks++, msg_id, chunk);
+        sent += chunk;
+    }
+    if (chunks == 0) {
+        portENTER_CRITICAL(&s_replay_mux);
+        s_replay.active = false;
+        portEXIT_CRITICAL(&s_replay_mux);
+        return;
+    }
+    ESP_LOGI(TAG, "Replaying %u logged samples, waiting for PUBACK.", (unsigned)sent);
+}
+
+// Lệnh "publish/interval <ms>": hạn gửi lô, áp dụng từ lần chờ kế tiếp của mqtt_task.
+// Mẫu đầu lô đã cũ bằng hạn gửi lô cộng độ trễ thu thập lúc được publish, nên hạn gửi lô không
+// được vượt nửa TTL của telemetry: gần TTL thì cả lô bị mqtt_policy_admit loại vì quá hạn.
+static esp_err_t cmd_publish_interval(const char *arg) {
+    uint32_t flush_ms;
+    esp_err_t err = mqtt_command_parse_u32(arg, &flush_ms);
+    if (err != ESP_OK) {
+        return err;
+    }
+    uint32_t ttl_ms = mqtt_policy_get(MQTT_CLASS_TELEMETRY)->ttl_ms;
+    uint32_t max_ms = ttl_ms ? ttl_ms / 2 : APP_SENSOR_MAX_INTERVAL_MS;
+    if (flush_ms == 0 || flush_ms > max_ms) {
+        ESP_LOGW(TAG, "publish/interval %lu ms rejected, allowed 1..%lu ms.", flush_ms, max_ms);
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_batch_flush_ms = flush_ms;
+    return ESP_OK;
+}
+
 void mqtt_task(void *pvParameters) {
-    QueueHandle_t data_queue = (QueueHandle_t)pvParameters;
-    sensor_data_t received_data;
-    char json_payload[200]; 
+    sensor_sample_t received_data;
+    static sensor_sample_t batch[SENSOR_DATA_QUEUE_SIZE];
+    // Thời điểm publish gần nhất của từng cảm biến, dùng cho heartbeat. Tính riêng từng cảm biến, nếu
+    // không một đầu đo thay đổi liên tục sẽ làm mẫu "không đổi" của các đầu đo ổn định bị chặn mãi.
+    static int64_t last_publish_us[SENSOR_SET_MAX_SENSORS];
+    int64_t last_replay_us = 0;  // Thời điểm gửi lại gần nhất, dùng giới hạn tốc độ gửi lại
+
+    // Đăng ký trước khi chờ WiFi để các mẫu đến trong lúc chờ được giữ lại (ghi đè mẫu cũ nhất khi đầy)
+    sample_bus_sub_t sub = sample_bus_subscribe("mqtt", SENSOR_DATA_QUEUE_SIZE, SAMPLE_BUS_DROP_OLDEST);
+    if (sub == NULL) {
+        ESP_LOGE(TAG, "Cannot subscribe to sample bus. MQTT task cannot start.");
+        vTaskDelete(NULL);
+        return;
+    }
+
+#if APP_TELEMETRY_LOG
+    // Log flash lưu mẫu khi mất kết nối; các mẫu chưa gửi của lần chạy trước được gửi lại sau khi kết nối
+    bool log_ready = telemetry_log_init() == ESP_OK;
+#else
+    bool log_ready = false;
+#endif
+
+    mqtt_command_register("publish/interval", cmd_publish_interval, MQTT_COMMAND_INLINE);
 
     ESP_LOGI(TAG, "MQTT Task Started. Waiting for WiFi connection...");
 
@@ -180,45 +559,71 @@ void mqtt_task(void *pvParameters) {
     }
 
     while (1) {
-        if (xQueueReceive(data_queue, &received_data, portMAX_DELAY) == pdPASS) {
-            ESP_LOGI(TAG, "MQTT Task: Received Temp = %.1f C, Humidity = %.1f %%",
-                     received_data.temperature, received_data.humidity);
-
-            if (g_display_sensor_data_mutex != NULL && xSemaphoreTake(g_display_sensor_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                g_display_sensor_data = received_data;
-                xSemaphoreGive(g_display_sensor_data_mutex);
-                ESP_LOGD(TAG, "Updated global display_sensor_data for LCD.");
-            } else {
-                ESP_LOGW(TAG, "Failed to take g_display_sensor_data_mutex in MQTT task.");
-            }
+        // Còn mẫu trong log thì thức dậy định kỳ để gửi lại, kể cả khi không có mẫu mới
+        TickType_t wait = telemetry_log_pending() ? pdMS_TO_TICKS(APP_TELEMETRY_REPLAY_INTERVAL_MS) : portMAX_DELAY;
+        if (s_pending_alert_count && pdMS_TO_TICKS(APP_MQTT_ALERT_RETRY_MS) < wait) {
+            wait = pdMS_TO_TICKS(APP_MQTT_ALERT_RETRY_MS);
+        }
+        wait = batch_wait(wait);
 
-            if (client != NULL && mqtt_da_ket_noi) {
-                // Thêm thời gian vào payload
-                time_t now;
-                struct tm timeinfo;
-                char time_str[64];
-
-                time(&now);
-                localtime_r(&now, &timeinfo);
-                strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &timeinfo);
-
-                snprintf(json_payload, sizeof(json_payload),
-                         "{\"temperature\":%.1f, \"humidity\":%.1f, \"timestamp\":\"%s\"}",
-                         received_data.temperature, received_data.humidity, time_str);
-
-                int msg_id = esp_mqtt_client_publish(client, MQTT_TOPIC, json_payload, 0, 1, 0);
-                if (msg_id != -1) {
-                    ESP_LOGI(TAG, "Sent publish successful (queued), msg_id=%d, data: %s", msg_id, json_payload);
-                } else {
-                    ESP_LOGE(TAG, "Failed to queue publish message. MQTT client might be disconnected or an error occurred.");
-                }
-            } else {
-                if (client == NULL) {
-                    ESP_LOGE(TAG, "MQTT client not initialized! Cannot publish.");
-                } else {
-                    ESP_LOGW(TAG, "MQTT not connected. Skipping publish of: Temp %.1fC, Hum %.1f%%", received_data.temperature, received_data.humidity);
+        // Mỗi lần thức dậy lấy hết các mẫu đang chờ (ví dụ khi vừa kết nối lại)
+        size_t batch_count = sample_bus_receive_batch(sub, batch, SENSOR_DATA_QUEUE_SIZE, wait);
+        // Mốc nhận chung cho cả lô: thời gian chờ trên bus tính đến lúc task thức dậy
+        int64_t received_us = esp_timer_get_time();
+        for (size_t i = 0; i < batch_count; i++) {
+            received_data = batch[i];
+            pipeline_stats_record(PIPELINE_STAGE_QUEUE,
+                                  (uint32_t)(received_us - received_data.timestamp_us - received_data.bus_us));
+            ESP_LOGI(TAG, "MQTT Task: Received sensor %u #%lu: Temp = " SENSOR_TENTHS_FMT " C, Humidity = " SENSOR_TENTHS_FMT " %%",
+                     received_data.sensor_id, received_data.seq,
+                     SENSOR_TENTHS_ARGS(received_data.temperature), SENSOR_TENTHS_ARGS(received_data.humidity));
+
+            if (received_data.flags & SENSOR_FLAG_OUTLIER) {
+                // Cảnh báo mới xếp sau các cảnh báo đang chờ để giữ thứ tự; chưa kết nối thì chờ đến khi
+                // kết nối lại, cảnh báo đã quá TTL lúc đó bị mqtt_policy_admit bỏ
+                if (client == NULL || !mqtt_da_ket_noi || s_pending_alert_count ||
+                    publish_alert(&received_data) == -2) {
+                    queue_alert(&received_data);
                 }
             }
+
+            // Mẫu không đổi sau lọc chỉ được publish khi cảm biến đó đến hạn heartbeat
+            uint8_t id = received_data.sensor_id;
+            if ((received_data.flags & SENSOR_FLAG_UNCHANGED) && id < SENSOR_SET_MAX_SENSORS &&
+                last_publish_us[id] != 0 &&
+                esp_timer_get_time() - last_publish_us[id] < (int64_t)APP_SENSOR_MAX_INTERVAL_MS * 1000) {
+                ESP_LOGD(TAG, "Sample unchanged after filtering, skipping publish.");
+                pipeline_stats_count_drop(PIPELINE_DROP_UNCHANGED);
+                continue;
+            }
+
+            // Vào lô; lô đầy thì publish ngay
+            s_batch[s_batch_count].sample = received_data;
+            s_batch[s_batch_count].wall_us = sensor_sample_wallclock_us(&received_data);
+            s_batch_received_us[s_batch_count] = received_us;
+            s_batch_count++;
+            if (id < SENSOR_SET_MAX_SENSORS) {
+                last_publish_us[id] = received_us;
+            }
+            if (s_batch_count == APP_MQTT_BATCH_SIZE) {
+                flush_batch(log_ready);
+            }
+        }
+        // Lô chưa đầy nhưng mẫu đầu tiên đã chờ đủ lâu
+        if (s_batch_count && esp_timer_get_time() - s_batch_received_us[0] >= (int64_t)s_batch_flush_ms * 1000) {
+            flush_batch(log_ready);
+        }
+
+        if (s_pending_alert_count && client != NULL && mqtt_da_ket_noi) {
+            retry_pending_alerts();
+        }
+        telemetry_log_flush_if_due();
+        replay_logged_samples(&last_replay_us);
+
+        // Mức đầy phía sau bus: outbox của MQTT client và số bản ghi chờ gửi lại trong log flash
+        if (client != NULL) {
+            pipeline_stats_set_gauge(PIPELINE_GAUGE_MQTT_OUTBOX, (uint32_t)esp_mqtt_client_get_outbox_size(client));
         }
+        pipeline_stats_set_gauge(PIPELINE_GAUGE_LOG_PENDING, telemetry_log_pending());
     }
 }
@@ -11,13 +11,12 @@
 #include "esp_sntp.h"
 
 #include "inc/app_config.h"
+#include "inc/app_state.h"
 
 static const char *TAG = "NTP_TASK";
 
 // Khai báo extern cho các tài nguyên toàn cục
 extern EventGroupHandle_t wifi_event_group;
-extern struct tm g_current_timeinfo;
-extern SemaphoreHandle_t g_current_time_mutex;
 extern bool g_time_synchronized;
 
 // Callback được gọi khi thời gian đồng bộ thành công
@@ -70,11 +69,8 @@ void ntp_task(void *pvParameters) {
             time(&now);
             localtime_r(&now, &timeinfo);
 
-            // >> MỚI: Cập nhật thời gian vào biến toàn cục, bảo vệ bằng mutex
-            if (xSemaphoreTake(g_current_time_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                g_current_timeinfo = timeinfo; // Sao chép thời gian
-                xSemaphoreGive(g_current_time_mutex);
-            }
+            // Cập nhật thời gian vào kho trạng thái, LCD được đánh thức khi giá trị đổi
+            app_state_set_time(&timeinfo);
             
             strftime(strftime_buf, sizeof(strftime_buf), "%c", &timeinfo);
             ESP_LOGI(TAG, "Thoi gian hien tai: %s", strftime_buf);
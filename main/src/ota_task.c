@@ -15,7 +15,9 @@
 // Include các header của project
 #include "inc/app_config.h" // Để sử dụng OTA_BUFF_SIZE
 #include "inc/ota_client.h"
-#include "inc/app_status.h" // Chứa định nghĩa ota_status_t và khai báo extern
+#include "inc/app_status.h" // Chứa định nghĩa ota_status_t
+#include "inc/app_state.h"
+#include "inc/task_placement.h"
 
 static const char *TAG = "ota_client"; // Tag riêng cho file này
 
@@ -24,12 +26,7 @@ static char ota_write_data[OTA_BUFF_SIZE + 1] = {0};
 
 // Hàm helper để cập nhật trạng thái OTA một cách an toàn
 static void set_ota_status(ota_status_t new_status) {
-    if (g_ota_status_mutex != NULL && xSemaphoreTake(g_ota_status_mutex, portMAX_DELAY) == pdTRUE) {
-        g_ota_status = new_status;
-        xSemaphoreGive(g_ota_status_mutex);
-    } else {
-        ESP_LOGE(TAG, "Failed to take OTA status mutex in ota_client!");
-    }
+    app_state_set_ota(new_status);
 }
 
 // Hàm xử lý sự kiện HTTP (static, chỉ dùng nội bộ trong file này)
@@ -64,9 +61,8 @@ static esp_err_t _http_event_handler(esp_http_client_event_t *evt) {
     return ESP_OK;
 }
 
-// Task thực hiện OTA
-static void ota_task(void *pvParameter) {
-    char *firmware_url = (char *)pvParameter;
+// Một lần OTA; chỉ trả về khi thất bại (thành công thì khởi động lại)
+static void ota_run(const char *firmware_url) {
     ESP_LOGI(TAG, "Starting OTA task with URL: %s", firmware_url);
     set_ota_status(OTA_STATUS_STARTING);
 
@@ -81,7 +77,6 @@ static void ota_task(void *pvParameter) {
     if (update_partition == NULL) {
         ESP_LOGE(TAG, "Valid OTA partition not found.");
         set_ota_status(OTA_STATUS_FAILED_PARTITION);
-        vTaskDelete(NULL);
         return;
     }
     ESP_LOGI(TAG, "Found partition: type %d, subtype %d, offset 0x%x, size 0x%x",
@@ -98,7 +93,6 @@ static void ota_task(void *pvParameter) {
     if (client == NULL) {
         ESP_LOGE(TAG, "Failed to initialize HTTP client");
         set_ota_status(OTA_STATUS_FAILED_HTTP_CONN);
-        vTaskDelete(NULL);
         return;
     }
 
@@ -107,7 +101,6 @@ static void ota_task(void *pvParameter) {
         ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
         set_ota_status(OTA_STATUS_FAILED_HTTP_CONN);
         esp_http_client_cleanup(client);
-        vTaskDelete(NULL);
         return;
     }
 
@@ -117,7 +110,6 @@ static void ota_task(void *pvParameter) {
         set_ota_status(OTA_STATUS_FAILED_HTTP_CONN);
         esp_http_client_close(client);
         esp_http_client_cleanup(client);
-        vTaskDelete(NULL);
         return;
     }
     ESP_LOGI(TAG, "Estimated firmware size (Content-Length): %d bytes", content_length);
@@ -129,7 +121,6 @@ static void ota_task(void *pvParameter) {
         set_ota_status(OTA_STATUS_FAILED_BEGIN);
         esp_http_client_close(client);
         esp_http_client_cleanup(client);
-        vTaskDelete(NULL);
         return;
     }
     ESP_LOGI(TAG, "esp_ota_begin succeeded. Writing firmware...");
@@ -151,7 +142,6 @@ static void ota_task(void *pvParameter) {
             esp_ota_abort(update_handle);
             esp_http_client_close(client);
             esp_http_client_cleanup(client);
-            vTaskDelete(NULL);
             return;
         } else if (data_read > 0) {
             err = esp_ota_write(update_handle, (const void *)ota_write_data, data_read);
@@ -161,7 +151,6 @@ static void ota_task(void *pvParameter) {
                 esp_ota_abort(update_handle);
                 esp_http_client_close(client);
                 esp_http_client_cleanup(client);
-                vTaskDelete(NULL);
                 return;
             }
             binary_file_length += data_read;
@@ -188,7 +177,6 @@ static void ota_task(void *pvParameter) {
         set_ota_status(OTA_STATUS_FAILED_END_VALIDATE);
         esp_http_client_close(client);
         esp_http_client_cleanup(client);
-        vTaskDelete(NULL);
         return;
     }
 
@@ -198,7 +186,6 @@ static void ota_task(void *pvParameter) {
         set_ota_status(OTA_STATUS_FAILED_SET_BOOT);
         esp_http_client_close(client);
         esp_http_client_cleanup(client);
-        vTaskDelete(NULL);
         return;
     }
 
@@ -209,13 +196,83 @@ static void ota_task(void *pvParameter) {
 
     vTaskDelay(pdMS_TO_TICKS(2000)); // Đợi một chút để log được ghi
     esp_restart();
+}
+
+#define OTA_TASK_STACK_SIZE 8192
+
+extern TaskHandle_t h_ota_task;
 
-    vTaskDelete(NULL); // Sẽ không bao giờ tới đây
+// Đang có một lần OTA; chỉ ota_task xóa cờ này, không hỏi trạng thái của task đã bị xóa
+static bool s_ota_busy = false;
+static const char *s_ota_url = NULL;
+static portMUX_TYPE s_ota_mux = portMUX_INITIALIZER_UNLOCKED;
+
+#if APP_STATIC_ALLOCATION
+// Stack OTA giữ sẵn từ lúc build: TLS + OTA không phải tranh heap với phần còn lại
+static StackType_t s_ota_stack[OTA_TASK_STACK_SIZE / sizeof(StackType_t)];
+static StaticTask_t s_ota_tcb;
+#endif
+
+// Task thực hiện OTA
+static void ota_task(void *pvParameter) {
+#if APP_STATIC_ALLOCATION
+    // Task tĩnh không tự xóa: TCB của task đã xóa còn nằm trong danh sách chờ dọn của idle task,
+    // tạo lại task trên cùng s_ota_tcb trước lúc đó sẽ làm hỏng danh sách của kernel. Sau một lần
+    // thất bại, task chờ yêu cầu kế tiếp từ start_ota_firmware_update().
+    while (1) {
+        ota_run(s_ota_url);
+        portENTER_CRITICAL(&s_ota_mux);
+        s_ota_busy = false;
+        portEXIT_CRITICAL(&s_ota_mux);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+#else
+    ota_run(s_ota_url);
+    // Xóa handle trước vTaskDelete: TCB được idle task giải phóng, không ai được dùng handle cũ nữa
+    portENTER_CRITICAL(&s_ota_mux);
+    h_ota_task = NULL;
+    s_ota_busy = false;
+    portEXIT_CRITICAL(&s_ota_mux);
+    vTaskDelete(NULL);
+#endif
 }
 
 // Hàm public để khởi tạo task OTA
 void start_ota_firmware_update(const char *firmware_url_param) {
+    // Chỉ một lần OTA tại một thời điểm
+    portENTER_CRITICAL(&s_ota_mux);
+    bool busy = s_ota_busy;
+    s_ota_busy = true;
+    portEXIT_CRITICAL(&s_ota_mux);
+    if (busy) {
+        ESP_LOGW(TAG, "OTA task already running, request ignored.");
+        return;
+    }
+
     set_ota_status(OTA_STATUS_IDLE); // Đặt lại trạng thái khi bắt đầu một lần OTA mới
-    xTaskCreate(&ota_task, "ota_task", 8192, (void *)firmware_url_param, 5, NULL);
+    s_ota_url = firmware_url_param;
+#if APP_STATIC_ALLOCATION
+    if (h_ota_task != NULL) {
+        // Task đã được tạo ở lần OTA trước và đang chờ
+        xTaskNotifyGive(h_ota_task);
+        ESP_LOGI(TAG, "OTA task woken up.");
+        return;
+    }
+    h_ota_task = xTaskCreateStaticPinnedToCore(&ota_task, "ota_task", OTA_TASK_STACK_SIZE, NULL, 5,
+                                               s_ota_stack, &s_ota_tcb, task_placement_core(TASK_CLASS_NET));
+#else
+    if (xTaskCreatePinnedToCore(&ota_task, "ota_task", OTA_TASK_STACK_SIZE, NULL, 5,
+                                &h_ota_task, task_placement_core(TASK_CLASS_NET)) != pdPASS) {
+        h_ota_task = NULL;
+    }
+#endif
+    if (h_ota_task == NULL) {
+        ESP_LOGE(TAG, "Failed to create OTA task.");
+        set_ota_status(OTA_STATUS_FAILED_BEGIN);
+        portENTER_CRITICAL(&s_ota_mux);
+        s_ota_busy = false;
+        portEXIT_CRITICAL(&s_ota_mux);
+        return;
+    }
     ESP_LOGI(TAG, "OTA task created.");
 }
\ No newline at end of file
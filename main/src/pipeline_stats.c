@@ -0,0 +1,153 @@
+#include "freertos/FreeRTOS.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "inc/pipeline_stats.h"
+
+static pipeline_hist_t s_hists[PIPELINE_STAGE_MAX];
+static uint32_t s_drops[PIPELINE_DROP_MAX];
+static pipeline_gauge_value_t s_gauges[PIPELINE_GAUGE_MAX];
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Bucket = vị trí bit cao nhất, một lệnh clz
+static uint32_t bucket_of(uint32_t us) {
+    uint32_t bucket = 31 - __builtin_clz(us | 1);
+    return bucket < PIPELINE_HIST_BUCKETS ? bucket : PIPELINE_HIST_BUCKETS - 1;
+}
+
+void pipeline_stats_record(pipeline_stage_t stage, uint32_t us) {
+    if (stage >= PIPELINE_STAGE_MAX) {
+        return;
+    }
+    uint32_t bucket = bucket_of(us);
+
+    portENTER_CRITICAL(&s_stats_mux);
+    pipeline_hist_t *hist = &s_hists[stage];
+    hist->count++;
+    hist->total_us += us;
+    if (us > hist->max_us) {
+        hist->max_us = us;
+    }
+    hist->buckets[bucket]++;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+void pipeline_stats_count_drop(pipeline_drop_t drop) {
+    if (drop >= PIPELINE_DROP_MAX) {
+        return;
+    }
+    portENTER_CRITICAL(&s_stats_mux);
+    s_drops[drop]++;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+void pipeline_stats_set_gauge(pipeline_gauge_t gauge, uint32_t value) {
+    if (gauge >= PIPELINE_GAUGE_MAX) {
+        return;
+    }
+    portENTER_CRITICAL(&s_stats_mux);
+    s_gauges[gauge].last = value;
+    if (value > s_gauges[gauge].high_water) {
+        s_gauges[gauge].high_water = value;
+    }
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+void pipeline_stats_get_hist(pipeline_stage_t stage, pipeline_hist_t *hist) {
+    if (stage >= PIPELINE_STAGE_MAX) {
+        memset(hist, 0, sizeof(*hist));
+        return;
+    }
+    portENTER_CRITICAL(&s_stats_mux);
+    *hist = s_hists[stage];
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+uint32_t pipeline_stats_get_drops(pipeline_drop_t drop) {
+    uint32_t count = 0;
+    if (drop < PIPELINE_DROP_MAX) {
+        portENTER_CRITICAL(&s_stats_mux);
+        count = s_drops[drop];
+        portEXIT_CRITICAL(&s_stats_mux);
+    }
+    return count;
+}
+
+void pipeline_stats_get_gauge(pipeline_gauge_t gauge, pipeline_gauge_value_t *value) {
+    if (gauge >= PIPELINE_GAUGE_MAX) {
+        memset(value, 0, sizeof(*value));
+        return;
+    }
+    portENTER_CRITICAL(&s_stats_mux);
+    *value = s_gauges[gauge];
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+uint32_t pipeline_hist_percentile(const pipeline_hist_t *hist, uint8_t percent) {
+    if (hist->count == 0) {
+        return 0;
+    }
+    // Số mẫu cần vượt qua, làm tròn lên để p100 rơi vào bucket cao nhất có dữ liệu
+    uint64_t target = ((uint64_t)hist->count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < PIPELINE_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target && hist->buckets[i]) {
+            return i == PIPELINE_HIST_BUCKETS - 1 ? hist->max_us : (2u << i) - 1;
+        }
+    }
+    return hist->max_us;
+}
+
+const char *pipeline_stage_to_string(pipeline_stage_t stage) {
+    switch (stage) {
+        case PIPELINE_STAGE_READ: return "read";
+        case PIPELINE_STAGE_PROCESS: return "process";
+        case PIPELINE_STAGE_QUEUE: return "queue";
+        case PIPELINE_STAGE_PUBLISH: return "publish";
+        case PIPELINE_STAGE_TOTAL: return "total";
+        default: return "unknown";
+    }
+}
+
+const char *pipeline_drop_to_string(pipeline_drop_t drop) {
+    switch (drop) {
+        case PIPELINE_DROP_REJECTED: return "rejected";
+        case PIPELINE_DROP_BUS: return "bus";
+        case PIPELINE_DROP_UNCHANGED: return "unchanged";
+        case PIPELINE_DROP_PUBLISH: return "publish-failed";
+        case PIPELINE_DROP_OFFLINE: return "offline";
+        default: return "unknown";
+    }
+}
+
+void pipeline_stats_print(void) {
+    pipeline_hist_t hist;
+
+    for (int stage = 0; stage < PIPELINE_STAGE_MAX; stage++) {
+        pipeline_stats_get_hist(stage, &hist);
+        if (hist.count == 0) {
+            continue;
+        }
+        printf("Pipeline %-8s n=%lu avg %llu us, p50 <%lu us, p99 <%lu us, max %lu us |",
+               pipeline_stage_to_string(stage), hist.count, hist.total_us / hist.count,
+               pipeline_hist_percentile(&hist, 50), pipeline_hist_percentile(&hist, 99), hist.max_us);
+        // Chỉ in các bucket có dữ liệu: "2^i:số mẫu"
+        for (int i = 0; i < PIPELINE_HIST_BUCKETS; i++) {
+            if (hist.buckets[i]) {
+                printf(" 2^%d:%lu", i, hist.buckets[i]);
+            }
+        }
+        printf("\n");
+    }
+
+    printf("Pipeline drops:");
+    for (int drop = 0; drop < PIPELINE_DROP_MAX; drop++) {
+        printf(" %s %lu", pipeline_drop_to_string(drop), pipeline_stats_get_drops(drop));
+    }
+    pipeline_gauge_value_t outbox, log_pending;
+    pipeline_stats_get_gauge(PIPELINE_GAUGE_MQTT_OUTBOX, &outbox);
+    pipeline_stats_get_gauge(PIPELINE_GAUGE_LOG_PENDING, &log_pending);
+    printf(" | outbox %lu B (high %lu), log %lu (high %lu)\n",
+           outbox.last, outbox.high_water, log_pending.last, log_pending.high_water);
+}
@@ -0,0 +1,193 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+#include "esp_log.h"
+
+#include "inc/sample_bus.h"
+#include "inc/seqlock.h"
+
+static const char *TAG = "SAMPLE_BUS";
+
+// Slot dùng chung: mẫu kèm số thứ tự của bus để subscriber phát hiện slot đã bị ghi đè
+typedef struct {
+    uint32_t bus_seq;
+    sensor_sample_t sample;
+} sample_bus_slot_t;
+
+// Ring của một subscriber, chứa bus_seq của các mẫu chưa đọc.
+// Không dùng queue/stream buffer của FreeRTOS vì producer không thể bỏ phần tử cũ nhất của chúng.
+struct sample_bus_sub {
+    portMUX_TYPE mux;
+    TaskHandle_t task;      // Task được đánh thức khi có mẫu mới
+    sample_bus_overflow_t policy;
+    uint8_t head;           // Vị trí phần tử cũ nhất
+    uint8_t count;          // Số phần tử đang chờ
+    uint32_t ring[SAMPLE_BUS_SLOTS];
+    sample_bus_stats_t stats;
+};
+
+static sample_bus_slot_t s_slots[SAMPLE_BUS_SLOTS];
+static seqlock_t s_slot_locks[SAMPLE_BUS_SLOTS];
+static struct sample_bus_sub s_subs[SAMPLE_BUS_MAX_SUBSCRIBERS];
+static volatile size_t s_sub_count = 0;
+static uint32_t s_next_seq = 0;
+static portMUX_TYPE s_bus_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void sample_bus_init(void) {
+    for (size_t i = 0; i < SAMPLE_BUS_SLOTS; i++) {
+        seqlock_init(&s_slot_locks[i]);
+    }
+}
+
+sample_bus_sub_t sample_bus_subscribe(const char *name, uint8_t depth, sample_bus_overflow_t policy) {
+    if (depth == 0 || depth > SAMPLE_BUS_SLOTS) {
+        ESP_LOGE(TAG, "Độ sâu %u của subscriber '%s' không hợp lệ (1..%d).", depth, name, SAMPLE_BUS_SLOTS);
+        return NULL;
+    }
+
+    struct sample_bus_sub *sub = NULL;
+    portENTER_CRITICAL(&s_bus_mux);
+    if (s_sub_count < SAMPLE_BUS_MAX_SUBSCRIBERS) {
+        sub = &s_subs[s_sub_count];
+        memset(sub, 0, sizeof(*sub));
+        portMUX_INITIALIZE(&sub->mux);
+        sub->task = xTaskGetCurrentTaskHandle();
+        sub->policy = policy;
+        sub->stats.name = name;
+        sub->stats.depth = depth;
+        // Tăng số lượng sau cùng để producer chỉ thấy subscriber đã khởi tạo xong
+        s_sub_count++;
+    }
+    portEXIT_CRITICAL(&s_bus_mux);
+
+    if (sub == NULL) {
+        ESP_LOGE(TAG, "Hết chỗ cho subscriber '%s' (tối đa %d).", name, SAMPLE_BUS_MAX_SUBSCRIBERS);
+        return NULL;
+    }
+    ESP_LOGI(TAG, "Subscriber '%s': độ sâu %u, chính sách %d.", name, depth, policy);
+    return sub;
+}
+
+// Đưa số thứ tự slot vào ring của một subscriber theo chính sách tràn của nó, không chặn
+static void sample_bus_deliver(struct sample_bus_sub *sub, uint32_t bus_seq) {
+    bool pushed = true;
+
+    portENTER_CRITICAL(&sub->mux);
+    if (sub->count == sub->stats.depth) {
+        sub->stats.dropped++;
+        if (sub->policy == SAMPLE_BUS_DROP_OLDEST) {
+            sub->head = (sub->head + 1) % sub->stats.depth;
+            sub->count--;
+        } else {
+            pushed = false;
+        }
+    }
+    if (pushed) {
+        sub->ring[(sub->head + sub->count) % sub->stats.depth] = bus_seq;
+        sub->count++;
+        if (sub->count > sub->stats.high_water) {
+            sub->stats.high_water = sub->count;
+        }
+    }
+    portEXIT_CRITICAL(&sub->mux);
+
+    if (pushed) {
+        xTaskNotify(sub->task, SAMPLE_BUS_NOTIFY_BIT, eSetBits);
+    }
+}
+
+esp_err_t sample_bus_publish(const sensor_sample_t *sample) {
+    if (sample == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Một lần chép duy nhất vào slot dùng chung, các subscriber chỉ nhận số thứ tự
+    sample_bus_slot_t slot = { .bus_seq = s_next_seq++, .sample = *sample };
+    uint32_t index = slot.bus_seq % SAMPLE_BUS_SLOTS;
+    seqlock_write(&s_slot_locks[index], &s_slots[index], &slot, sizeof(slot));
+
+    size_t count = s_sub_count;
+    for (size_t i = 0; i < count; i++) {
+        sample_bus_deliver(&s_subs[i], slot.bus_seq);
+    }
+    return ESP_OK;
+}
+
+// Lấy phần tử cũ nhất khỏi ring, false nếu ring rỗng
+static bool sample_bus_pop(struct sample_bus_sub *sub, uint32_t *bus_seq) {
+    bool popped = false;
+
+    portENTER_CRITICAL(&sub->mux);
+    if (sub->count > 0) {
+        *bus_seq = sub->ring[sub->head];
+        sub->head = (sub->head + 1) % sub->stats.depth;
+        sub->count--;
+        popped = true;
+    }
+    portEXIT_CRITICAL(&sub->mux);
+    return popped;
+}
+
+size_t sample_bus_receive_batch(sample_bus_sub_t sub, sensor_sample_t *samples, size_t max, TickType_t timeout) {
+    TimeOut_t timeout_state;
+    size_t received = 0;
+    uint32_t bus_seq;
+    sample_bus_slot_t slot;
+
+    if (sub == NULL || samples == NULL || max == 0) {
+        return 0;
+    }
+
+    vTaskSetTimeOutState(&timeout_state);
+    while (1) {
+        uint32_t overruns = 0;
+        while (received < max && sample_bus_pop(sub, &bus_seq)) {
+            uint32_t index = bus_seq % SAMPLE_BUS_SLOTS;
+            seqlock_read(&s_slot_locks[index], &slot, &s_slots[index], sizeof(slot));
+            if (slot.bus_seq == bus_seq) {
+                samples[received++] = slot.sample;
+            } else {
+                // Subscriber chậm hơn SAMPLE_BUS_SLOTS mẫu: slot đã chứa mẫu mới hơn
+                overruns++;
+            }
+        }
+
+        if (received > 0 || overruns > 0) {
+            portENTER_CRITICAL(&sub->mux);
+            sub->stats.delivered += received;
+            sub->stats.overruns += overruns;
+            if (received > 0) {
+                sub->stats.wakeups++;
+            }
+            portEXIT_CRITICAL(&sub->mux);
+        }
+        if (received > 0 || xTaskCheckForTimeOut(&timeout_state, &timeout) == pdTRUE) {
+            return received;
+        }
+        // Ring rỗng: ngủ đến khi producer đặt bit thông báo. Bit có thể còn sót từ mẫu đã
+        // được lấy ở lần trước, khi đó vòng lặp kiểm tra lại và ngủ tiếp phần thời gian còn lại.
+        xTaskNotifyWait(0, SAMPLE_BUS_NOTIFY_BIT, NULL, timeout);
+    }
+}
+
+esp_err_t sample_bus_receive(sample_bus_sub_t sub, sensor_sample_t *sample, TickType_t timeout) {
+    if (sub == NULL || sample == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return sample_bus_receive_batch(sub, sample, 1, timeout) == 1 ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+size_t sample_bus_subscriber_count(void) {
+    return s_sub_count;
+}
+
+esp_err_t sample_bus_get_stats(size_t index, sample_bus_stats_t *stats) {
+    if (stats == NULL || index >= s_sub_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct sample_bus_sub *sub = &s_subs[index];
+    portENTER_CRITICAL(&sub->mux);
+    *stats = sub->stats;
+    portEXIT_CRITICAL(&sub->mux);
+    return ESP_OK;
+}
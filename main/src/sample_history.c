@@ -0,0 +1,383 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <sys/time.h>
+#include "esp_timer.h"
+
+#include "inc/app_config.h"
+#include "inc/sample_history.h"
+
+// Chỉ số nội bộ cho ring mẫu thô, đặt sau các độ phân giải tổng hợp
+#define HISTORY_RAW SAMPLE_HISTORY_RES_MAX
+
+// Ring chỉ giữ chỉ số; dữ liệu nằm trong các mảng tĩnh của từng cảm biến
+typedef struct {
+    uint32_t head;      // Vị trí ghi kế tiếp
+    uint32_t count;
+    uint32_t capacity;
+} history_ring_t;
+
+// Mẫu thô trong kho: thời gian là giây kể từ khởi động (esp_timer), cờ nằm ở mảng riêng để
+// mỗi mẫu chỉ tốn 9 byte
+typedef struct {
+    uint32_t time_s;
+    int16_t temperature;
+    int16_t humidity;
+} history_raw_entry_t;
+
+// Lịch sử của một cảm biến; thời gian bên trong đều là giây kể từ khởi động
+typedef struct {
+    history_raw_entry_t raw[APP_HISTORY_RAW_SAMPLES];
+    uint8_t raw_flags[APP_HISTORY_RAW_SAMPLES];
+    sample_history_rollup_t minutes[APP_HISTORY_MINUTE_ROLLUPS];
+    sample_history_rollup_t hours[APP_HISTORY_HOUR_ROLLUPS];
+    // Khoảng đang mở, count == 0 nếu chưa có mẫu
+    sample_history_rollup_t open[SAMPLE_HISTORY_RES_MAX];
+    history_ring_t rings[SAMPLE_HISTORY_RES_MAX + 1];
+} history_sensor_t;
+
+typedef struct {
+    history_sensor_t sensors[APP_HISTORY_SENSORS];
+    uint32_t added;
+    uint32_t evicted;
+} history_store_t;
+
+static history_store_t s_store;
+_Static_assert(sizeof(history_store_t) <= APP_HISTORY_RAM_BUDGET,
+               "sample_history vượt APP_HISTORY_RAM_BUDGET, giảm APP_HISTORY_* trong app_config.h");
+
+static const uint32_t s_res_seconds[SAMPLE_HISTORY_RES_MAX] = { 60, 3600 };
+
+static SemaphoreHandle_t s_mutex;
+static StaticSemaphore_t s_mutex_buf;
+// Độ lệch wall-clock - thời gian khởi động (giây) đang dùng; chỉ đổi khi đồng hồ nhảy quá 1 s
+// (lần đồng bộ NTP đầu, chỉnh giờ) để mốc phút/giờ của các khoảng tổng hợp không dao động
+static int64_t s_offset_s;
+static bool s_offset_valid;
+
+static sample_history_rollup_t *rollup_buf(history_sensor_t *sensor, sample_history_res_t res) {
+    return res == SAMPLE_HISTORY_MINUTE ? sensor->minutes : sensor->hours;
+}
+
+// Chỉ số vật lý của phần tử thứ logical (0 = cũ nhất)
+static uint32_t ring_at(const history_ring_t *ring, uint32_t logical) {
+    return (ring->head + ring->capacity - ring->count + logical) % ring->capacity;
+}
+
+// Cấp chỗ cho phần tử mới, trả về true nếu phải đè phần tử cũ nhất
+static bool ring_push(history_ring_t *ring, uint32_t *slot) {
+    bool evicted = ring->count == ring->capacity;
+    *slot = ring->head;
+    ring->head = (ring->head + 1) % ring->capacity;
+    if (!evicted) {
+        ring->count++;
+    }
+    return evicted;
+}
+
+static uint32_t entry_time(history_sensor_t *sensor, int kind, uint32_t slot) {
+    return kind == HISTORY_RAW ? sensor->raw[slot].time_s : rollup_buf(sensor, kind)[slot].start_s;
+}
+
+// Phần tử đầu tiên có thời gian >= t; ring luôn tăng dần theo thời gian nên tìm nhị phân được
+static uint32_t ring_lower_bound(history_sensor_t *sensor, int kind, uint32_t t) {
+    const history_ring_t *ring = &sensor->rings[kind];
+    uint32_t lo = 0, hi = ring->count;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (entry_time(sensor, kind, ring_at(ring, mid)) < t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Khoảng được căn theo mốc phút/giờ của wall-clock khi đồng hồ đã đồng bộ (synced), trước đó theo
+// thời gian khởi động. Khoảng chỉ đóng khi mốc mới cách đầu khoảng ít nhất một độ dài, nên khoảng đang
+// mở lúc đồng bộ (hoặc lúc đồng hồ bị chỉnh) kéo dài đến mốc wall-clock kế tiếp và không chồng lên khoảng sau.
+static void rollup_update(history_sensor_t *sensor, sample_history_res_t res, const sensor_sample_t *sample,
+                          uint32_t time_s, bool synced, int64_t offset_s) {
+    uint32_t len = s_res_seconds[res];
+    uint32_t phase = synced ? (uint32_t)(((int64_t)time_s + offset_s) % len) : time_s % len;
+    uint32_t start_s = phase <= time_s ? time_s - phase : 0;
+    sample_history_rollup_t *bucket = &sensor->open[res];
+
+    // Sang khoảng mới: đóng khoảng cũ, đẩy vào ring tổng hợp của cảm biến
+    if (bucket->count && start_s >= bucket->start_s + len) {
+        uint32_t slot;
+        ring_push(&sensor->rings[res], &slot);
+        rollup_buf(sensor, res)[slot] = *bucket;
+        bucket->count = 0;
+    }
+
+    if (bucket->count == 0) {
+        bucket->start_s = start_s;
+        bucket->sensor_id = sample->sensor_id;
+        bucket->temp_sum = 0;
+        bucket->hum_sum = 0;
+        bucket->temp_min = bucket->temp_max = sample->temperature;
+        bucket->hum_min = bucket->hum_max = sample->humidity;
+    } else if (bucket->count == UINT16_MAX) {
+        return;
+    }
+    if (sample->temperature < bucket->temp_min) bucket->temp_min = sample->temperature;
+    if (sample->temperature > bucket->temp_max) bucket->temp_max = sample->temperature;
+    if (sample->humidity < bucket->hum_min) bucket->hum_min = sample->humidity;
+    if (sample->humidity > bucket->hum_max) bucket->hum_max = sample->humidity;
+    bucket->temp_sum += sample->temperature;
+    bucket->hum_sum += sample->humidity;
+    bucket->count++;
+}
+
+static uint32_t boot_now_s(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+// Độ lệch wall-clock - thời gian khởi động (giây); false nếu đồng hồ chưa đồng bộ. Gọi khi giữ s_mutex.
+static bool wall_offset_s(int64_t *offset_s) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    int64_t boot_us = esp_timer_get_time();
+    if (now.tv_sec < SAMPLE_HISTORY_MIN_VALID_TIME) {
+        return false;
+    }
+    // Tính theo us rồi làm tròn để độ lệch không nhảy ±1 s do cắt phần lẻ của hai đồng hồ
+    int64_t offset = ((int64_t)now.tv_sec * 1000000 + now.tv_usec - boot_us + 500000) / 1000000;
+    if (!s_offset_valid || offset > s_offset_s + 1 || offset < s_offset_s - 1) {
+        s_offset_s = offset;
+        s_offset_valid = true;
+    }
+    *offset_s = s_offset_s;
+    return true;
+}
+
+// Đổi mốc wall-clock sang giây kể từ khởi động, kẹp vào dải uint32_t
+static uint32_t to_boot_s(time_t wall_s, int64_t offset_s) {
+    int64_t t = (int64_t)wall_s - offset_s;
+    return t < 0 ? 0 : t > UINT32_MAX ? UINT32_MAX : (uint32_t)t;
+}
+
+// Đổi [from, to] wall-clock sang thời gian khởi động; false nếu khoảng rỗng hoặc chưa đồng bộ.
+// Gọi khi giữ s_mutex.
+static bool to_boot_range(time_t from, time_t to, int64_t *offset_s, uint32_t *from_s, uint32_t *to_s) {
+    if (from > to || !wall_offset_s(offset_s)) {
+        return false;
+    }
+    *from_s = to_boot_s(from, *offset_s);
+    *to_s = to_boot_s(to, *offset_s);
+    return true;
+}
+
+// Khoảng [start, start + độ dài) giao với [from_s, to_s] khi start > from_s - độ dài
+static uint32_t rollup_min_start(sample_history_res_t res, uint32_t from_s) {
+    return from_s >= s_res_seconds[res] ? from_s - s_res_seconds[res] + 1 : 0;
+}
+
+void sample_history_init(void) {
+    memset(&s_store, 0, sizeof(s_store));
+    for (int id = 0; id < APP_HISTORY_SENSORS; id++) {
+        history_sensor_t *sensor = &s_store.sensors[id];
+        sensor->rings[HISTORY_RAW].capacity = APP_HISTORY_RAW_SAMPLES;
+        sensor->rings[SAMPLE_HISTORY_MINUTE].capacity = APP_HISTORY_MINUTE_ROLLUPS;
+        sensor->rings[SAMPLE_HISTORY_HOUR].capacity = APP_HISTORY_HOUR_ROLLUPS;
+    }
+    s_offset_valid = false;
+    s_mutex = xSemaphoreCreateMutexStatic(&s_mutex_buf);
+}
+
+bool sample_history_now(time_t *now) {
+    int64_t offset_s;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool synced = wall_offset_s(&offset_s);
+    xSemaphoreGive(s_mutex);
+    if (!synced) {
+        return false;
+    }
+    *now = (time_t)(boot_now_s() + offset_s);
+    return true;
+}
+
+void sample_history_add(const sensor_sample_t *sample) {
+    if (sample == NULL || sample->sensor_id >= APP_HISTORY_SENSORS) {
+        return;
+    }
+    history_sensor_t *sensor = &s_store.sensors[sample->sensor_id];
+    uint32_t time_s = (uint32_t)(sample->timestamp_us / 1000000);
+    uint32_t slot;
+    int64_t offset_s = 0;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool synced = wall_offset_s(&offset_s);
+    if (ring_push(&sensor->rings[HISTORY_RAW], &slot)) {
+        s_store.evicted++;
+    }
+    sensor->raw[slot] = (history_raw_entry_t){
+        .time_s = time_s,
+        .temperature = sample->temperature,
+        .humidity = sample->humidity,
+    };
+    sensor->raw_flags[slot] = sample->flags;
+    s_store.added++;
+    rollup_update(sensor, SAMPLE_HISTORY_MINUTE, sample, time_s, synced, offset_s);
+    rollup_update(sensor, SAMPLE_HISTORY_HOUR, sample, time_s, synced, offset_s);
+    xSemaphoreGive(s_mutex);
+}
+
+size_t sample_history_query_raw(uint8_t sensor_id, time_t from, time_t to,
+                                sample_history_raw_t *out, size_t max) {
+    size_t n = 0;
+    int64_t offset_s;
+    uint32_t from_s, to_s;
+
+    if (out == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (!to_boot_range(from, to, &offset_s, &from_s, &to_s)) {
+        xSemaphoreGive(s_mutex);
+        return 0;
+    }
+    for (uint8_t id = 0; id < APP_HISTORY_SENSORS && n < max; id++) {
+        if (sensor_id != SAMPLE_HISTORY_ALL_SENSORS && id != sensor_id) {
+            continue;
+        }
+        history_sensor_t *sensor = &s_store.sensors[id];
+        const history_ring_t *ring = &sensor->rings[HISTORY_RAW];
+        for (uint32_t i = ring_lower_bound(sensor, HISTORY_RAW, from_s); i < ring->count && n < max; i++) {
+            uint32_t slot = ring_at(ring, i);
+            const history_raw_entry_t *entry = &sensor->raw[slot];
+            if (entry->time_s > to_s) {
+                break;
+            }
+            out[n++] = (sample_history_raw_t){
+                .time_s = (uint32_t)(entry->time_s + offset_s),
+                .temperature = entry->temperature,
+                .humidity = entry->humidity,
+                .sensor_id = id,
+                .flags = sensor->raw_flags[slot],
+            };
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return n;
+}
+
+size_t sample_history_query_rollup(sample_history_res_t res, uint8_t sensor_id, time_t from, time_t to,
+                                   sample_history_rollup_t *out, size_t max) {
+    size_t n = 0;
+    int64_t offset_s;
+    uint32_t from_s, to_s;
+
+    if (out == NULL || res >= SAMPLE_HISTORY_RES_MAX) {
+        return 0;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (!to_boot_range(from, to, &offset_s, &from_s, &to_s)) {
+        xSemaphoreGive(s_mutex);
+        return 0;
+    }
+    uint32_t min_start = rollup_min_start(res, from_s);
+    for (uint8_t id = 0; id < APP_HISTORY_SENSORS && n < max; id++) {
+        if (sensor_id != SAMPLE_HISTORY_ALL_SENSORS && id != sensor_id) {
+            continue;
+        }
+        history_sensor_t *sensor = &s_store.sensors[id];
+        const history_ring_t *ring = &sensor->rings[res];
+        const sample_history_rollup_t *buf = rollup_buf(sensor, res);
+        for (uint32_t i = ring_lower_bound(sensor, res, min_start); i < ring->count && n < max; i++) {
+            const sample_history_rollup_t *entry = &buf[ring_at(ring, i)];
+            if (entry->start_s > to_s) {
+                break;
+            }
+            out[n] = *entry;
+            out[n++].start_s = (uint32_t)(entry->start_s + offset_s);
+        }
+        const sample_history_rollup_t *open = &sensor->open[res];
+        if (n < max && open->count && open->start_s >= min_start && open->start_s <= to_s) {
+            out[n] = *open;
+            out[n++].start_s = (uint32_t)(open->start_s + offset_s);
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return n;
+}
+
+// Gộp một bản tổng hợp vào kết quả
+static void rollup_merge(sample_history_rollup_t *acc, const sample_history_rollup_t *entry) {
+    if (acc->count == 0) {
+        *acc = *entry;
+        return;
+    }
+    if (entry->temp_min < acc->temp_min) acc->temp_min = entry->temp_min;
+    if (entry->temp_max > acc->temp_max) acc->temp_max = entry->temp_max;
+    if (entry->hum_min < acc->hum_min) acc->hum_min = entry->hum_min;
+    if (entry->hum_max > acc->hum_max) acc->hum_max = entry->hum_max;
+    acc->temp_sum += entry->temp_sum;
+    acc->hum_sum += entry->hum_sum;
+    acc->count = (uint32_t)acc->count + entry->count > UINT16_MAX ? UINT16_MAX : acc->count + entry->count;
+}
+
+bool sample_history_summarize(uint8_t sensor_id, time_t from, time_t to, sample_history_rollup_t *out) {
+    int64_t offset_s;
+    uint32_t from_s, to_s;
+
+    if (out == NULL || sensor_id >= APP_HISTORY_SENSORS) {
+        return false;
+    }
+    history_sensor_t *sensor = &s_store.sensors[sensor_id];
+
+    memset(out, 0, sizeof(*out));
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (!to_boot_range(from, to, &offset_s, &from_s, &to_s)) {
+        xSemaphoreGive(s_mutex);
+        return false;
+    }
+    uint32_t min_start = rollup_min_start(SAMPLE_HISTORY_MINUTE, from_s);
+    const history_ring_t *ring = &sensor->rings[SAMPLE_HISTORY_MINUTE];
+    for (uint32_t i = ring_lower_bound(sensor, SAMPLE_HISTORY_MINUTE, min_start); i < ring->count; i++) {
+        const sample_history_rollup_t *entry = &sensor->minutes[ring_at(ring, i)];
+        if (entry->start_s > to_s) {
+            break;
+        }
+        rollup_merge(out, entry);
+    }
+    const sample_history_rollup_t *open = &sensor->open[SAMPLE_HISTORY_MINUTE];
+    if (open->count && open->start_s >= min_start && open->start_s <= to_s) {
+        rollup_merge(out, open);
+    }
+    xSemaphoreGive(s_mutex);
+
+    out->start_s = (uint32_t)(out->start_s + offset_s);
+    return out->count != 0;
+}
+
+void sample_history_get_stats(sample_history_stats_t *stats) {
+    uint32_t now_s = boot_now_s();
+
+    memset(stats, 0, sizeof(*stats));
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int id = 0; id < APP_HISTORY_SENSORS; id++) {
+        history_sensor_t *sensor = &s_store.sensors[id];
+        const history_ring_t *raw = &sensor->rings[HISTORY_RAW];
+        stats->raw_count += raw->count;
+        stats->raw_capacity += raw->capacity;
+        if (raw->count) {
+            uint32_t span_s = now_s - sensor->raw[ring_at(raw, 0)].time_s;
+            if (stats->raw_span_s == 0 || span_s < stats->raw_span_s) {
+                stats->raw_span_s = span_s;
+            }
+        }
+        for (int res = 0; res < SAMPLE_HISTORY_RES_MAX; res++) {
+            stats->rollup_count[res] += sensor->rings[res].count;
+            stats->rollup_capacity[res] += sensor->rings[res].capacity;
+        }
+    }
+    stats->added = s_store.added;
+    stats->evicted = s_store.evicted;
+    xSemaphoreGive(s_mutex);
+    stats->ram_bytes = sizeof(s_store);
+}
@@ -0,0 +1,15 @@
+#include <stddef.h>
+
+#include "inc/sensor_driver.h"
+
+// Bảng tra driver theo loại cảm biến; thêm cảm biến mới chỉ cần một driver và một dòng ở đây
+static const sensor_driver_t *const s_drivers[SENSOR_KIND_MAX] = {
+    [SENSOR_KIND_DHT11] = &sensor_driver_dht,
+    [SENSOR_KIND_AM2301] = &sensor_driver_dht,
+    [SENSOR_KIND_SI7021] = &sensor_driver_dht,
+    [SENSOR_KIND_SHT3X] = &sensor_driver_sht3x,
+};
+
+const sensor_driver_t *sensor_driver_get(sensor_kind_t kind) {
+    return (unsigned)kind < SENSOR_KIND_MAX ? s_drivers[kind] : NULL;
+}
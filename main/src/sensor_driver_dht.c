@@ -0,0 +1,80 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "inc/sensor_driver.h"
+
+static const char *TAG = "SENSOR_DHT";
+
+// Thời gian chờ tối đa cho một lần đọc bất đồng bộ (một lần đọc thực tế ~30 ms)
+#define SENSOR_DHT_READ_TIMEOUT_MS 200
+
+static dht_sensor_type_t dht_type_of(const sensor_probe_t *probe) {
+    switch (probe->kind) {
+    case SENSOR_KIND_AM2301:
+        return DHT_TYPE_AM2301;
+    case SENSOR_KIND_SI7021:
+        return DHT_TYPE_SI7021;
+    case SENSOR_KIND_DHT11:
+    default:
+        return DHT_TYPE_DHT11;
+    }
+}
+
+// Callback hoàn tất đọc DHT (chạy trong task esp_timer): chép kết quả và đánh thức task quét
+static void dht_read_done_cb(const dht_reading_t *reading, void *arg) {
+    sensor_driver_ctx_t *ctx = (sensor_driver_ctx_t *)arg;
+
+    ctx->reading.result = reading->result;
+    ctx->reading.fault = reading->fault;
+    ctx->reading.temperature = reading->temperature;
+    ctx->reading.humidity = reading->humidity;
+    ctx->reading.timestamp_us = reading->timestamp_us;
+    ctx->reading.done_us = esp_timer_get_time();
+    ctx->ready = true;
+    if (ctx->notify_task != NULL) {
+        xTaskNotifyGive(ctx->notify_task);
+    }
+}
+
+static esp_err_t sensor_dht_init(const sensor_probe_t *probe, sensor_driver_ctx_t *ctx) {
+    if (!GPIO_IS_VALID_GPIO(probe->pin)) {
+        ESP_LOGE(TAG, "Chân GPIO %d không hợp lệ!", probe->pin);
+        return ESP_ERR_INVALID_ARG;
+    }
+    ctx->handle = NULL;
+    return ESP_OK;
+}
+
+static esp_err_t sensor_dht_trigger(const sensor_probe_t *probe, sensor_driver_ctx_t *ctx, uint32_t *wait_ms) {
+    ctx->ready = false;
+    *wait_ms = SENSOR_DHT_READ_TIMEOUT_MS;
+    // Với backend bit-bang, callback chạy xong trước khi hàm này trả về
+    // ESP_ERR_INVALID_STATE: backend RMT còn bận với lần đọc trước (sensor_set đếm là DHT_FAULT_DRIVER)
+    return dht_read_async(dht_type_of(probe), probe->pin, dht_read_done_cb, ctx);
+}
+
+static esp_err_t sensor_dht_read(const sensor_probe_t *probe, sensor_driver_ctx_t *ctx, sensor_reading_t *reading) {
+    if (!ctx->ready) {
+        reading->result = ESP_ERR_TIMEOUT;
+        reading->fault = DHT_FAULT_DRIVER;
+        reading->done_us = esp_timer_get_time();
+        return ESP_ERR_TIMEOUT;
+    }
+    *reading = ctx->reading;
+    return reading->result;
+}
+
+static uint32_t sensor_dht_min_interval_ms(const sensor_probe_t *probe) {
+    // Theo datasheet: DHT11 1 lần/giây, AM2301 1 lần/2 giây
+    return probe->kind == SENSOR_KIND_AM2301 ? 2000 : 1000;
+}
+
+const sensor_driver_t sensor_driver_dht = {
+    .name = "DHT",
+    .init = sensor_dht_init,
+    .trigger = sensor_dht_trigger,
+    .read = sensor_dht_read,
+    .min_interval_ms = sensor_dht_min_interval_ms,
+};
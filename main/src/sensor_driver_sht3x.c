@@ -0,0 +1,114 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "driver/i2c_master.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "inc/sensor_driver.h"
+#include "inc/app_i2c_bus.h"
+
+static const char *TAG = "SENSOR_SHT3X";
+
+extern SemaphoreHandle_t g_i2c_bus_mutex;
+
+#define SHT3X_I2C_FREQ_HZ 100000
+#define SHT3X_BUS_TIMEOUT_MS 100        // Chờ mutex bus tối đa (LCD giữ bus theo từng dòng)
+#define SHT3X_XFER_TIMEOUT_MS 50
+#define SHT3X_CMD_MEASURE_HIGH 0x2400   // Single shot, độ lặp lại cao, không kéo dài xung clock
+#define SHT3X_MEASURE_TIME_MS 16        // Datasheet: tối đa 15.5 ms ở độ lặp lại cao
+#define SHT3X_MIN_INTERVAL_MS 200       // Giới hạn tự làm nóng, vẫn nhanh hơn DHT 5-10 lần
+
+// CRC-8 của SHT3x: đa thức 0x31, giá trị đầu 0xFF
+static uint8_t sht3x_crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0xFF;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static esp_err_t sensor_sht3x_init(const sensor_probe_t *probe, sensor_driver_ctx_t *ctx) {
+    i2c_master_bus_handle_t bus;
+    i2c_master_dev_handle_t dev;
+
+    esp_err_t err = app_i2c_bus_get(&bus);
+    if (err != ESP_OK) {
+        return err;
+    }
+    i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = probe->i2c_address,
+        .scl_speed_hz = SHT3X_I2C_FREQ_HZ,
+    };
+    err = i2c_master_bus_add_device(bus, &dev_cfg, &dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Không thêm được SHT3x 0x%02x vào bus: %s", probe->i2c_address, esp_err_to_name(err));
+        return err;
+    }
+    ctx->handle = dev;
+    return ESP_OK;
+}
+
+static esp_err_t sensor_sht3x_trigger(const sensor_probe_t *probe, sensor_driver_ctx_t *ctx, uint32_t *wait_ms) {
+    const uint8_t cmd[2] = { SHT3X_CMD_MEASURE_HIGH >> 8, SHT3X_CMD_MEASURE_HIGH & 0xFF };
+
+    ctx->ready = false;
+    ctx->reading.timestamp_us = esp_timer_get_time();
+    *wait_ms = SHT3X_MEASURE_TIME_MS;
+
+    // Chỉ giữ bus trong lúc gửi lệnh; trong thời gian chuyển đổi LCD được dùng bus
+    if (xSemaphoreTake(g_i2c_bus_mutex, pdMS_TO_TICKS(SHT3X_BUS_TIMEOUT_MS)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = i2c_master_transmit((i2c_master_dev_handle_t)ctx->handle, cmd, sizeof(cmd), SHT3X_XFER_TIMEOUT_MS);
+    xSemaphoreGive(g_i2c_bus_mutex);
+    return err;
+}
+
+static esp_err_t sensor_sht3x_read(const sensor_probe_t *probe, sensor_driver_ctx_t *ctx, sensor_reading_t *reading) {
+    uint8_t data[6];
+
+    reading->timestamp_us = ctx->reading.timestamp_us;
+    reading->fault = DHT_FAULT_NONE;
+    if (xSemaphoreTake(g_i2c_bus_mutex, pdMS_TO_TICKS(SHT3X_BUS_TIMEOUT_MS)) != pdTRUE) {
+        reading->result = ESP_ERR_TIMEOUT;
+        reading->fault = DHT_FAULT_DRIVER;
+        reading->done_us = esp_timer_get_time();
+        return reading->result;
+    }
+    esp_err_t err = i2c_master_receive((i2c_master_dev_handle_t)ctx->handle, data, sizeof(data), SHT3X_XFER_TIMEOUT_MS);
+    xSemaphoreGive(g_i2c_bus_mutex);
+    reading->done_us = esp_timer_get_time();
+
+    if (err != ESP_OK) {
+        // NACK khi cảm biến vắng mặt hoặc chưa đo xong
+        reading->fault = DHT_FAULT_NO_RESPONSE;
+    } else if (sht3x_crc8(&data[0], 2) != data[2] || sht3x_crc8(&data[3], 2) != data[5]) {
+        err = ESP_ERR_INVALID_CRC;
+        reading->fault = DHT_FAULT_CHECKSUM;
+    } else {
+        // T = -45 + 175 * raw / 65535, RH = 100 * raw / 65535 (đổi sang đơn vị 0.1)
+        uint32_t raw_t = ((uint32_t)data[0] << 8) | data[1];
+        uint32_t raw_rh = ((uint32_t)data[3] << 8) | data[4];
+        reading->temperature = (int16_t)(-450 + (int32_t)((raw_t * 1750 + 32767) / 65535));
+        reading->humidity = (int16_t)((raw_rh * 1000 + 32767) / 65535);
+    }
+    reading->result = err;
+    return err;
+}
+
+static uint32_t sensor_sht3x_min_interval_ms(const sensor_probe_t *probe) {
+    return SHT3X_MIN_INTERVAL_MS;
+}
+
+const sensor_driver_t sensor_driver_sht3x = {
+    .name = "SHT3x",
+    .init = sensor_sht3x_init,
+    .trigger = sensor_sht3x_trigger,
+    .read = sensor_sht3x_read,
+    .min_interval_ms = sensor_sht3x_min_interval_ms,
+};
@@ -0,0 +1,92 @@
+#include <string.h>
+#include <stdlib.h>
+
+#include "inc/sensor_filter.h"
+
+// Median của count phần tử đầu cửa sổ (sắp xếp chèn trên bản sao, count <= 5)
+static int16_t window_median(const sensor_filter_channel_t *ch) {
+    int16_t sorted[SENSOR_FILTER_MEDIAN_WINDOW];
+
+    for (uint8_t i = 0; i < ch->count; i++) {
+        int16_t v = ch->window[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    return sorted[ch->count / 2];
+}
+
+static int16_t channel_update(sensor_filter_channel_t *ch, const sensor_filter_config_t *cfg,
+                              int16_t raw, int16_t outlier_threshold, uint8_t *flags) {
+    ch->window[ch->pos] = raw;
+    ch->pos = (ch->pos + 1) % SENSOR_FILTER_MEDIAN_WINDOW;
+    if (ch->count < SENSOR_FILTER_MEDIAN_WINDOW) {
+        ch->count++;
+        *flags |= SENSOR_FLAG_WARMUP;
+    }
+
+    int16_t median = window_median(ch);
+    if (ch->count == SENSOR_FILTER_MEDIAN_WINDOW && abs(raw - median) > outlier_threshold) {
+        *flags |= SENSOR_FLAG_OUTLIER;
+    }
+
+    int32_t measured_q8 = (int32_t)median << 8;
+    bool was_primed = ch->primed;
+    if (!ch->primed) {
+        ch->estimate_q8 = measured_q8;
+        ch->variance_q8 = cfg->kalman_r << 8;
+        ch->primed = true;
+    } else {
+        switch (cfg->mode) {
+        case SENSOR_FILTER_EWMA:
+            ch->estimate_q8 += (measured_q8 - ch->estimate_q8) >> cfg->ewma_shift;
+            break;
+        case SENSOR_FILTER_KALMAN: {
+            // Dự đoán: x giữ nguyên, P += Q. Cập nhật: K = P / (P + R) ở Q16.
+            ch->variance_q8 += cfg->kalman_q << 8;
+            int32_t gain_q16 = (int32_t)(((int64_t)ch->variance_q8 << 16) / (ch->variance_q8 + (cfg->kalman_r << 8)));
+            ch->estimate_q8 += (int32_t)(((int64_t)(measured_q8 - ch->estimate_q8) * gain_q16) >> 16);
+            ch->variance_q8 = (int32_t)(((int64_t)ch->variance_q8 * (65536 - gain_q16)) >> 16);
+            break;
+        }
+        case SENSOR_FILTER_NONE:
+        default:
+            ch->estimate_q8 = measured_q8;
+            break;
+        }
+    }
+
+    int16_t output = (int16_t)((ch->estimate_q8 + 128) >> 8);
+    if (was_primed && output == ch->last_output) {
+        *flags |= SENSOR_FLAG_UNCHANGED;
+    }
+    ch->last_output = output;
+    return output;
+}
+
+void sensor_filter_init(sensor_filter_t *filter, const sensor_filter_config_t *config) {
+    memset(filter, 0, sizeof(*filter));
+    filter->config = config;
+}
+
+uint8_t sensor_filter_apply(sensor_filter_t *filter, int16_t *temperature, int16_t *humidity) {
+    const sensor_filter_config_t *cfg = filter->config;
+
+    if (*temperature < cfg->temp_min || *temperature > cfg->temp_max ||
+        *humidity < cfg->hum_min || *humidity > cfg->hum_max) {
+        return SENSOR_FLAG_OUT_OF_RANGE;
+    }
+
+    uint8_t temp_flags = 0;
+    uint8_t hum_flags = 0;
+    *temperature = channel_update(&filter->temperature, cfg, *temperature, cfg->temp_outlier, &temp_flags);
+    *humidity = channel_update(&filter->humidity, cfg, *humidity, cfg->hum_outlier, &hum_flags);
+
+    // Mẫu chỉ "không đổi" khi cả hai kênh đều không đổi
+    uint8_t flags = (temp_flags | hum_flags) & ~SENSOR_FLAG_UNCHANGED;
+    flags |= temp_flags & hum_flags & SENSOR_FLAG_UNCHANGED;
+    return flags | SENSOR_FLAG_FILTERED;
+}
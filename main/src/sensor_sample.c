@@ -0,0 +1,61 @@
+#include "freertos/FreeRTOS.h"
+#include <sys/time.h>
+#include "esp_timer.h"
+
+#include "inc/sensor_sample.h"
+
+static sensor_latency_stats_t s_latency;
+static portMUX_TYPE s_latency_mux = portMUX_INITIALIZER_UNLOCKED;
+
+size_t sensor_sample_format_tenths(char *buf, size_t size, int16_t tenths) {
+    char digits[SENSOR_TENTHS_STR_LEN];
+    uint32_t value = tenths < 0 ? (uint32_t)(-(int32_t)tenths) : (uint32_t)tenths;
+    size_t n = 0;
+
+    // Ghi ngược: chữ số thập phân, dấu chấm, rồi phần nguyên (ít nhất một chữ số)
+    digits[n++] = (char)('0' + value % 10);
+    digits[n++] = '.';
+    value /= 10;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (tenths < 0) {
+        digits[n++] = '-';
+    }
+
+    if (buf == NULL || size < n + 1) {
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        buf[i] = digits[n - 1 - i];
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+int64_t sensor_sample_wallclock_us(const sensor_sample_t *sample) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    int64_t wall_now_us = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+    return wall_now_us - (esp_timer_get_time() - sample->timestamp_us);
+}
+
+void sensor_sample_record_latency(const sensor_sample_t *sample) {
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - sample->timestamp_us);
+
+    portENTER_CRITICAL(&s_latency_mux);
+    s_latency.samples++;
+    s_latency.last_us = latency_us;
+    if (latency_us > s_latency.max_us) {
+        s_latency.max_us = latency_us;
+    }
+    s_latency.total_us += latency_us;
+    portEXIT_CRITICAL(&s_latency_mux);
+}
+
+void sensor_sample_get_latency_stats(sensor_latency_stats_t *stats) {
+    portENTER_CRITICAL(&s_latency_mux);
+    *stats = s_latency;
+    portEXIT_CRITICAL(&s_latency_mux);
+}
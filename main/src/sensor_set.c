@@ -0,0 +1,316 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "inc/sensor_set.h"
+
+static const char *TAG = "SENSOR_SET";
+
+typedef struct {
+    sensor_probe_t probe;
+    const sensor_driver_t *driver;
+    sensor_driver_ctx_t ctx;
+    uint32_t min_interval_ms;
+    int64_t last_read_us;   // Thời điểm đọc gần nhất, 0 nếu chưa đọc
+    sensor_set_stats_t stats;
+} sensor_slot_t;
+
+static sensor_slot_t s_slots[SENSOR_SET_MAX_SENSORS];
+static size_t s_count = 0;
+static TickType_t s_period_ticks;
+static TickType_t s_slot_ticks;
+static TickType_t s_next_sweep;
+static TickType_t s_sweep_start;    // Mốc bắt đầu của lượt quét gần nhất
+static bool s_swept = false;
+static TickType_t s_last_wake;      // Mốc thức dậy gần nhất, dùng cho vTaskDelayUntil()
+static uint32_t s_sweep_counter = 0;
+static volatile uint32_t s_period_override_ms = 0; // Ghi/đọc 32 bit là nguyên tử, không cần khóa
+static TickType_t s_prev_sweep_tick;  // Mốc lịch của lượt quét trước
+static int64_t s_prev_wake_us = 0;    // Thời điểm thực tế thức dậy ở lượt trước, 0 nếu chưa có
+static sensor_set_timing_stats_t s_timing_stats;
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Đổi ms sang tick làm tròn lên, cộng thêm một tick vì lần chờ đầu tiên có thể ngắn hơn một tick
+static TickType_t wait_ticks(uint32_t ms) {
+    return (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS + 1;
+}
+
+// Cập nhật thống kê của cảm biến sau một lần đọc
+static void sensor_set_account(sensor_slot_t *slot, const sensor_set_sample_t *sample, uint32_t latency_us) {
+    sensor_set_stats_t *stats = &slot->stats;
+
+    portENTER_CRITICAL(&s_stats_mux);
+    if (sample->result == SENSOR_SET_ERR_SKIPPED) {
+        stats->skipped++;
+    } else {
+        stats->reads++;
+        stats->last_latency_us = latency_us;
+        if (latency_us > stats->max_latency_us) {
+            stats->max_latency_us = latency_us;
+        }
+        stats->total_latency_us += latency_us;
+        if (sample->result == ESP_OK) {
+            stats->successes++;
+            stats->last_success_us = sample->timestamp_us;
+        } else {
+            stats->faults[sample->fault]++;
+        }
+    }
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+uint32_t sensor_set_min_interval_ms(uint8_t sensor_id) {
+    return sensor_id < s_count ? s_slots[sensor_id].min_interval_ms : 0;
+}
+
+esp_err_t sensor_set_init(const sensor_probe_t *probes, size_t count, uint32_t period_ms) {
+    if (probes == NULL || count == 0 || count > SENSOR_SET_MAX_SENSORS || period_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        sensor_slot_t *slot = &s_slots[i];
+        slot->driver = sensor_driver_get(probes[i].kind);
+        if (slot->driver == NULL) {
+            ESP_LOGE(TAG, "Loại cảm biến %d của cảm biến %u không được hỗ trợ!", probes[i].kind, (unsigned)i);
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        slot->probe = probes[i];
+        memset(&slot->ctx, 0, sizeof(slot->ctx));
+        esp_err_t err = slot->driver->init(&slot->probe, &slot->ctx);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Không khởi tạo được cảm biến %u (%s): %s", (unsigned)i, slot->driver->name, esp_err_to_name(err));
+            return err;
+        }
+        slot->min_interval_ms = slot->driver->min_interval_ms(&slot->probe);
+        slot->last_read_us = 0;
+        memset(&slot->stats, 0, sizeof(slot->stats));
+
+        if (period_ms < slot->min_interval_ms) {
+            ESP_LOGW(TAG, "Chu kỳ %lu ms ngắn hơn khoảng nghỉ tối thiểu của cảm biến %u (%lu ms), một số lượt sẽ bị bỏ qua.",
+                     period_ms, (unsigned)i, slot->min_interval_ms);
+        }
+    }
+    s_count = count;
+
+    sensor_set_set_period(period_ms);
+    s_next_sweep = xTaskGetTickCount();
+    s_last_wake = s_next_sweep;
+
+    ESP_LOGI(TAG, "Bộ cảm biến: %u đầu đo, chu kỳ %lu ms, lệch pha %lu ms.",
+             (unsigned)count, pdTICKS_TO_MS(s_period_ticks), pdTICKS_TO_MS(s_slot_ticks));
+    return ESP_OK;
+}
+
+void sensor_set_set_period(uint32_t period_ms) {
+    if (s_count == 0) {
+        return;
+    }
+
+    uint32_t slot_ms = period_ms / s_count;
+    if (slot_ms < SENSOR_SET_MIN_SLOT_MS) {
+        ESP_LOGW(TAG, "Chu kỳ %lu ms quá ngắn cho %u cảm biến, giãn mỗi pha thành %d ms.",
+                 period_ms, (unsigned)s_count, SENSOR_SET_MIN_SLOT_MS);
+        slot_ms = SENSOR_SET_MIN_SLOT_MS;
+    }
+    s_slot_ticks = pdMS_TO_TICKS(slot_ms);
+    s_period_ticks = pdMS_TO_TICKS(period_ms);
+    if (s_period_ticks < s_slot_ticks * s_count) {
+        s_period_ticks = s_slot_ticks * s_count;
+    }
+    if (s_swept) {
+        // Lên lịch lại lượt kế tiếp theo chu kỳ mới, tính từ đầu lượt trước
+        s_next_sweep = s_sweep_start + s_period_ticks;
+    }
+}
+
+uint32_t sensor_set_get_period_ms(void) {
+    return pdTICKS_TO_MS(s_period_ticks);
+}
+
+void sensor_set_set_period_override(uint32_t period_ms) {
+    s_period_override_ms = period_ms;
+}
+
+uint32_t sensor_set_get_period_override(void) {
+    return s_period_override_ms;
+}
+
+// Đọc một cảm biến, tôn trọng khoảng nghỉ tối thiểu của nó
+static void sensor_set_read_slot(uint8_t id, sensor_set_sample_t *sample) {
+    sensor_slot_t *slot = &s_slots[id];
+    int64_t now_us = esp_timer_get_time();
+
+    memset(sample, 0, sizeof(*sample));
+    sample->sensor_id = id;
+    sample->timestamp_us = now_us;
+    sample->flags = 0;
+
+    // last_read_us là lúc driver bắt đầu đo, muộn hơn mốc thức dậy theo lịch một chút; lượt trước thức
+    // dậy trễ vài trăm us thì lượt đúng hạn kế tiếp đo được ngắn hơn min_interval_ms. Cho phép lệch
+    // một tick để chu kỳ bằng đúng khoảng nghỉ tối thiểu (DHT22 2000 ms) không mất trọn một lượt.
+    if (slot->last_read_us != 0 &&
+        now_us - slot->last_read_us + portTICK_PERIOD_MS * 1000 < (int64_t)slot->min_interval_ms * 1000) {
+        ESP_LOGD(TAG, "Bỏ qua cảm biến %u: chưa đủ khoảng nghỉ tối thiểu.", id);
+        sample->result = SENSOR_SET_ERR_SKIPPED;
+        sensor_set_account(slot, sample, 0);
+        return;
+    }
+
+    ulTaskNotifyTake(pdTRUE, 0); // Bỏ thông báo cũ còn sót lại từ lần đọc bị timeout
+    slot->ctx.notify_task = xTaskGetCurrentTaskHandle();
+
+    sensor_reading_t reading = {
+        .result = ESP_OK,
+        .fault = DHT_FAULT_DRIVER,
+        .timestamp_us = now_us,
+        .done_us = now_us,
+    };
+    uint32_t wait_ms = 0;
+    reading.result = slot->driver->trigger(&slot->probe, &slot->ctx, &wait_ms);
+    if (reading.result == ESP_OK) {
+        // Chờ hết thời gian chuyển đổi; driver có kết quả sớm sẽ đánh thức task trước đó.
+        // Trong lúc chờ, bus I2C được nhả cho LCD.
+        ulTaskNotifyTake(pdTRUE, wait_ticks(wait_ms));
+        slot->driver->read(&slot->probe, &slot->ctx, &reading);
+    } else {
+        // Không bắt đầu được phép đo (vd. backend RMT còn bận vì lần đọc trước bị timeout): lỗi driver,
+        // được đếm và thử lại như các lỗi khác
+        reading.fault = DHT_FAULT_DRIVER;
+        reading.done_us = esp_timer_get_time();
+    }
+
+    sample->result = reading.result;
+    sample->fault = reading.result == ESP_OK ? DHT_FAULT_NONE : reading.fault;
+    if (reading.result == ESP_OK) {
+        sample->timestamp_us = reading.timestamp_us;
+        sample->temperature = reading.temperature;
+        sample->humidity = reading.humidity;
+    }
+    slot->last_read_us = sample->timestamp_us;
+    sample->read_us = (uint32_t)(reading.done_us - sample->timestamp_us);
+    sensor_set_account(slot, sample, sample->read_us);
+
+    if (reading.result != ESP_OK) {
+        ESP_LOGE(TAG, "Lỗi khi đọc cảm biến %u (%s): %s (%s)", id, slot->driver->name,
+                 esp_err_to_name(reading.result), dht_fault_to_string(sample->fault));
+    }
+}
+
+// Thử lại cảm biến vừa đọc lỗi sau khoảng nghỉ tối thiểu của nó, miễn là lần thử (cả thời gian đọc)
+// xong trước deadline: pha của cảm biến kế tiếp, hoặc lượt quét kế tiếp với cảm biến cuối, để lần
+// thử lại không đẩy lệch pha các cảm biến sau. Lỗi thoáng qua (CRC, nhiễu) chỉ làm dữ liệu cũ đi
+// 1-2 s thay vì cả chu kỳ.
+static void sensor_set_retry_slot(uint8_t id, sensor_set_sample_t *sample, TickType_t deadline) {
+    sensor_slot_t *slot = &s_slots[id];
+    TickType_t retry_ticks = pdMS_TO_TICKS(slot->min_interval_ms + SENSOR_SET_MIN_SLOT_MS);
+
+    for (uint8_t retry = 0; retry < SENSOR_SET_MAX_RETRIES; retry++) {
+        if (sample->result == ESP_OK || sample->result == SENSOR_SET_ERR_SKIPPED) {
+            return;
+        }
+        if ((int32_t)(s_last_wake + retry_ticks + pdMS_TO_TICKS(SENSOR_SET_MIN_SLOT_MS) - deadline) > 0) {
+            return;
+        }
+        vTaskDelayUntil(&s_last_wake, retry_ticks);
+
+        portENTER_CRITICAL(&s_stats_mux);
+        slot->stats.retries++;
+        portEXIT_CRITICAL(&s_stats_mux);
+
+        ESP_LOGI(TAG, "Thử lại cảm biến %u (lần %u).", id, retry + 1);
+        sensor_set_read_slot(id, sample);
+    }
+}
+
+// Jitter = |khoảng thời gian thực tế giữa hai lần thức dậy - khoảng theo lịch tick|
+static void sensor_set_record_wake(TickType_t sweep_start) {
+    int64_t now_us = esp_timer_get_time();
+
+    if (s_prev_wake_us != 0) {
+        int64_t expected_us = (int64_t)(TickType_t)(sweep_start - s_prev_sweep_tick) * portTICK_PERIOD_MS * 1000;
+        int64_t jitter_us = now_us - s_prev_wake_us - expected_us;
+        uint32_t abs_jitter_us = (uint32_t)(jitter_us < 0 ? -jitter_us : jitter_us);
+
+        portENTER_CRITICAL(&s_stats_mux);
+        s_timing_stats.sweeps++;
+        s_timing_stats.last_jitter_us = abs_jitter_us;
+        if (abs_jitter_us > s_timing_stats.max_jitter_us) {
+            s_timing_stats.max_jitter_us = abs_jitter_us;
+        }
+        s_timing_stats.total_jitter_us += abs_jitter_us;
+        portEXIT_CRITICAL(&s_stats_mux);
+    }
+    s_prev_wake_us = now_us;
+    s_prev_sweep_tick = sweep_start;
+}
+
+esp_err_t sensor_set_sweep(sensor_batch_t *batch) {
+    if (batch == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_count == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    TickType_t sweep_start = s_next_sweep;
+    s_sweep_start = sweep_start;
+    s_swept = true;
+    batch->sweep = s_sweep_counter++;
+    batch->count = s_count;
+
+    for (uint8_t i = 0; i < s_count; i++) {
+        // Chờ đến pha của cảm biến i bằng vTaskDelayUntil() tính từ mốc thức dậy trước,
+        // nên thời gian đọc không làm trôi chu kỳ (trả về ngay nếu đã quá thời điểm đó)
+        TickType_t slot_time = sweep_start + s_slot_ticks * i;
+        if ((int32_t)(slot_time - s_last_wake) > 0) {
+            vTaskDelayUntil(&s_last_wake, slot_time - s_last_wake);
+        }
+        if (i == 0) {
+            sensor_set_record_wake(sweep_start);
+        }
+        sensor_set_read_slot(i, &batch->samples[i]);
+        TickType_t deadline = i + 1 < s_count ? slot_time + s_slot_ticks : sweep_start + s_period_ticks;
+        sensor_set_retry_slot(i, &batch->samples[i], deadline);
+    }
+
+    // Lượt kế tiếp cách đúng một chu kỳ; nếu đã trễ quá một chu kỳ thì bắt đầu lại từ bây giờ
+    s_next_sweep = sweep_start + s_period_ticks;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(now - s_next_sweep) > (int32_t)s_period_ticks) {
+        ESP_LOGW(TAG, "Lượt quét %lu bị trễ, đồng bộ lại chu kỳ.", batch->sweep);
+        s_next_sweep = now;
+        s_last_wake = now;
+    }
+    return ESP_OK;
+}
+
+size_t sensor_set_count(void) {
+    return s_count;
+}
+
+const sensor_probe_t *sensor_set_get_probe(uint8_t sensor_id) {
+    return sensor_id < s_count ? &s_slots[sensor_id].probe : NULL;
+}
+
+esp_err_t sensor_set_get_stats(uint8_t sensor_id, sensor_set_stats_t *stats) {
+    if (stats == NULL || sensor_id >= s_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_stats_mux);
+    *stats = s_slots[sensor_id].stats;
+    portEXIT_CRITICAL(&s_stats_mux);
+    return ESP_OK;
+}
+
+esp_err_t sensor_set_get_timing_stats(sensor_set_timing_stats_t *stats) {
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_stats_mux);
+    *stats = s_timing_stats;
+    portEXIT_CRITICAL(&s_stats_mux);
+    return ESP_OK;
+}
@@ -4,77 +4,192 @@
 #include "driver/gpio.h"
 #include <stdio.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 
 // Bao gồm tệp cấu hình để lấy các định nghĩa chân GPIO và khoảng thời gian cập nhật
 #include "inc/app_config.h"
 
 // Bao gồm header từ thư viện zorxx/dht
 #include "dht.h"
-
-// Định nghĩa cấu trúc dữ liệu cảm biến (phải khớp với main.c)
-typedef struct {
-    float temperature;
-    float humidity;
-} sensor_data_t;
+#include "inc/sensor_set.h"
+#include "inc/adaptive_sampling.h"
+#include "inc/sensor_filter.h"
+#include "inc/sensor_sample.h"
+#include "inc/sample_bus.h"
+#include "inc/app_state.h"
+#include "inc/sample_history.h"
+#include "inc/pipeline_stats.h"
+#include "inc/mqtt_command.h"
 
 static const char *TAG = "SENSOR_TASK_DHT_ZORXX";
 
-// Hàm đọc dữ liệu từ cảm biến DHT11 sử dụng thư viện zorxx/dht
-static esp_err_t read_dht11_sensor_zorxx(float *temp, float *hum) {
-    // Sử dụng trực tiếp DHT_TYPE_DHT11 từ thư viện dht.h
-    // và DHT11_GPIO_PIN từ app_config.h
-    esp_err_t result = dht_read_float_data(DHT_TYPE_DHT11, DHT11_GPIO_PIN, hum, temp);
-
-    if (result == ESP_OK) {
-        ESP_LOGD(TAG, "zorxx/dht: Đọc DHT11 OK: Temp=%.1fC, Hum=%.1f%% (GPIO %d)", *temp, *hum, DHT11_GPIO_PIN);
-    } else {
-        // Log lỗi chi tiết hơn
-        ESP_LOGE(TAG, "zorxx/dht: Lỗi khi đọc DHT11 từ GPIO %d: %s (Mã lỗi ESP-IDF: %d)", DHT11_GPIO_PIN, esp_err_to_name(result), result);
+// Danh sách đầu đo lấy từ app_config.h
+static const sensor_probe_t s_probes[] = APP_SENSORS;
+_Static_assert(sizeof(s_probes) / sizeof(s_probes[0]) <= APP_HISTORY_SENSORS,
+               "APP_HISTORY_SENSORS phải ít nhất bằng số đầu đo trong APP_SENSORS");
+
+static const sensor_filter_config_t s_filter_config = {
+    .mode = APP_SENSOR_FILTER_MODE,
+    .ewma_shift = APP_SENSOR_FILTER_EWMA_SHIFT,
+    .kalman_q = APP_SENSOR_FILTER_KALMAN_Q,
+    .kalman_r = APP_SENSOR_FILTER_KALMAN_R,
+    .temp_outlier = APP_SENSOR_OUTLIER_TEMP,
+    .hum_outlier = APP_SENSOR_OUTLIER_HUM,
+    .temp_min = APP_SENSOR_TEMP_MIN,
+    .temp_max = APP_SENSOR_TEMP_MAX,
+    .hum_min = APP_SENSOR_HUM_MIN,
+    .hum_max = APP_SENSOR_HUM_MAX,
+};
+
+// Trạng thái lọc riêng cho từng cảm biến
+static sensor_filter_t s_filters[SENSOR_SET_MAX_SENSORS];
+
+// Số thứ tự của mẫu kế tiếp được gửi vào hàng đợi
+static uint32_t s_sample_seq = 0;
+
+// Lọc tất cả mẫu đọc thành công của lượt quét, gắn cờ chất lượng vào từng mẫu
+static void filter_batch(sensor_batch_t *batch) {
+    for (uint8_t i = 0; i < batch->count; i++) {
+        sensor_set_sample_t *sample = &batch->samples[i];
+        if (sample->result != ESP_OK) {
+            continue;
+        }
+        int16_t raw_temperature = sample->temperature;
+        int16_t raw_humidity = sample->humidity;
+        sample->flags = sensor_filter_apply(&s_filters[sample->sensor_id], &sample->temperature, &sample->humidity);
+        if (sample->flags & SENSOR_FLAG_OUTLIER) {
+            ESP_LOGW(TAG, "Cảm biến %u: giá trị thô T=%d, H=%d lệch xa median, đã được thay thế.",
+                     sample->sensor_id, raw_temperature, raw_humidity);
+        }
+    }
+}
+
+// Kiểm tra và phát một mẫu của lượt quét lên sample bus
+static void forward_sample(const sensor_set_sample_t *sample) {
+    sensor_sample_t current_data;
+
+    if (sample->result != ESP_OK) {
+        if (sample->result != SENSOR_SET_ERR_SKIPPED) {
+            ESP_LOGW(TAG, "zorxx/dht: Đọc dữ liệu từ cảm biến %u thất bại. Sẽ thử lại ở lượt sau.", sample->sensor_id);
+            // Lỗi đã được log chi tiết trong sensor_set
+        }
+        return;
+    }
+
+    current_data.temperature = sample->temperature;
+    current_data.humidity = sample->humidity;
+    current_data.sensor_id = sample->sensor_id;
+    current_data.flags = sample->flags;
+    current_data.timestamp_us = sample->timestamp_us;
+    current_data.ready_us = sample->read_us;
+
+    // Dải hợp lệ đã được kiểm tra trong bộ lọc (APP_SENSOR_TEMP_MIN..MAX, APP_SENSOR_HUM_MIN..MAX).
+    // Mẫu ngoài dải bị loại hẳn thay vì gửi đi cho các task phía sau.
+    if (sample->flags & SENSOR_FLAG_REJECTED) {
+        ESP_LOGW(TAG, "zorxx/dht: Dữ liệu cảm biến %u không hợp lệ (T=" SENSOR_TENTHS_FMT ", H=" SENSOR_TENTHS_FMT "), bỏ qua mẫu này.",
+                 sample->sensor_id, SENSOR_TENTHS_ARGS(current_data.temperature), SENSOR_TENTHS_ARGS(current_data.humidity));
+        pipeline_stats_count_drop(PIPELINE_DROP_REJECTED);
+        return;
+    }
+    current_data.seq = s_sample_seq++;
+    ESP_LOGI(TAG, "zorxx/dht: Cảm biến %u: Nhiệt độ = " SENSOR_TENTHS_FMT " C, Độ ẩm = " SENSOR_TENTHS_FMT " %% (cờ 0x%02x)",
+             sample->sensor_id, SENSOR_TENTHS_ARGS(current_data.temperature), SENSOR_TENTHS_ARGS(current_data.humidity),
+             current_data.flags);
+
+    // Phát lên bus: một lần chép, không bao giờ chặn; ring đầy thì mẫu cũ nhất của subscriber đó bị ghi đè
+    current_data.bus_us = (uint32_t)(esp_timer_get_time() - current_data.timestamp_us);
+    pipeline_stats_record(PIPELINE_STAGE_READ, current_data.ready_us);
+    pipeline_stats_record(PIPELINE_STAGE_PROCESS, current_data.bus_us - current_data.ready_us);
+    if (sample_bus_publish(&current_data) != ESP_OK) {
+        ESP_LOGE(TAG, "Không thể phát dữ liệu cảm biến lên sample bus.");
+        pipeline_stats_count_drop(PIPELINE_DROP_BUS);
+    }
+    // Giá trị mới nhất cho các consumer trạng thái (LCD), chỉ đánh thức khi giá trị đổi
+    app_state_set_sensor(&current_data);
+    // Lịch sử cục bộ (mẫu thô + tổng hợp phút/giờ), O(1) mỗi mẫu
+    sample_history_add(&current_data);
+}
+
+// Lệnh "sensor/interval <ms>": chu kỳ lấy mẫu cố định, 0 trở lại chu kỳ thích ứng.
+// Chỉ ghi giá trị ghi đè; task quét áp dụng ở cuối lượt hiện tại.
+static esp_err_t cmd_sensor_interval(const char *arg) {
+    uint32_t period_ms;
+    esp_err_t err = mqtt_command_parse_u32(arg, &period_ms);
+    if (err != ESP_OK) {
+        return err;
     }
-    return result;
+    if (period_ms != 0 && (period_ms < APP_SENSOR_MIN_INTERVAL_MS || period_ms > APP_SENSOR_MAX_INTERVAL_MS)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sensor_set_set_period_override(period_ms);
+    return ESP_OK;
 }
 
 void sensor_task(void *pvParameters) {
-    QueueHandle_t data_queue = (QueueHandle_t)pvParameters;
-    sensor_data_t current_data;
+    static sensor_batch_t batch;
+
+    ESP_LOGI(TAG, "Sensor Task (DHT - zorxx/dht) đã khởi động.");
 
-    ESP_LOGI(TAG, "Sensor Task (DHT11 - zorxx/dht) đã khởi động.");
-    ESP_LOGI(TAG, "Sử dụng chân GPIO %d cho DHT11.", DHT11_GPIO_PIN); // Lấy từ app_config.h
-    ESP_LOGI(TAG, "Khoảng thời gian cập nhật cảm biến: %d ms.", APP_SENSOR_UPDATE_INTERVAL_MS); // Lấy từ app_config.h
+    // Thư viện zorxx/dht không yêu cầu hàm init() riêng biệt, chỉ chọn backend đọc.
+    // Thời gian tắt ngắt của từng backend được in ra bởi system_monitor_task.
+    esp_err_t backend_err = dht_set_backend(APP_DHT_USE_RMT ? DHT_BACKEND_RMT : DHT_BACKEND_BITBANG);
+    if (backend_err != ESP_OK) {
+        ESP_LOGW(TAG, "Không chọn được backend DHT (%s), dùng bit-bang.", esp_err_to_name(backend_err));
+    }
+
+#if APP_SENSOR_ADAPTIVE_SAMPLING
+    const adaptive_sampling_config_t sampling_config = {
+        .min_period_ms = APP_SENSOR_MIN_INTERVAL_MS,
+        .max_period_ms = APP_SENSOR_MAX_INTERVAL_MS,
+        .temp_deadband = APP_SENSOR_TEMP_DEADBAND,
+        .hum_deadband = APP_SENSOR_HUM_DEADBAND,
+    };
+    uint32_t period_ms = adaptive_sampling_init(&sampling_config);
+#else
+    uint32_t period_ms = APP_SENSOR_UPDATE_INTERVAL_MS;
+#endif
+    ESP_LOGI(TAG, "Khoảng thời gian cập nhật cảm biến: %lu ms.", period_ms);
+
+    for (uint8_t i = 0; i < SENSOR_SET_MAX_SENSORS; i++) {
+        sensor_filter_init(&s_filters[i], &s_filter_config);
+    }
 
-    // Kiểm tra xem chân GPIO có hợp lệ không trước khi sử dụng
-    if (!GPIO_IS_VALID_GPIO(DHT11_GPIO_PIN)) {
-        ESP_LOGE(TAG, "Chân GPIO %d được cấu hình cho DHT11 không hợp lệ!", DHT11_GPIO_PIN);
-        ESP_LOGE(TAG, "Vui lòng kiểm tra định nghĩa DHT11_GPIO_PIN trong inc/app_config.h.");
+    // Một chân DHT11 duy nhất chỉ là bộ cảm biến có một phần tử
+    esp_err_t err = sensor_set_init(s_probes, sizeof(s_probes) / sizeof(s_probes[0]), period_ms);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Cấu hình cảm biến không hợp lệ (%s)!", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Vui lòng kiểm tra APP_SENSORS trong inc/app_config.h.");
         vTaskDelete(NULL); // Tự hủy task nếu cấu hình sai
         return;
     }
 
-    // Thư viện zorxx/dht không yêu cầu hàm init() riêng biệt.
+    mqtt_command_register("sensor/interval", cmd_sensor_interval, MQTT_COMMAND_INLINE);
 
     while (1) {
-        if (read_dht11_sensor_zorxx(&current_data.temperature, &current_data.humidity) == ESP_OK) {
-            // Kiểm tra cơ bản tính hợp lệ của dữ liệu từ DHT11
-            // Nhiệt độ DHT11: 0-50°C, Độ ẩm: 20-90% RH (thông thường)
-            if (current_data.temperature < -10.0f || current_data.temperature > 60.0f ||
-                current_data.humidity < 0.0f || current_data.humidity > 100.0f) {
-                ESP_LOGW(TAG, "zorxx/dht: Dữ liệu DHT11 có vẻ không hợp lệ sau khi đọc (T=%.1f, H=%.1f). Có thể do lỗi checksum hoặc nhiễu.",
-                         current_data.temperature, current_data.humidity);
-                // Bạn có thể quyết định không gửi dữ liệu này hoặc gửi giá trị báo lỗi
-            } else {
-                 ESP_LOGI(TAG, "zorxx/dht: Cảm biến DHT11: Nhiệt độ = %.1f C, Độ ẩm = %.1f %%",
-                          current_data.temperature, current_data.humidity);
-            }
-
-            // Gửi dữ liệu vào hàng đợi (queue)
-            if (xQueueSend(data_queue, &current_data, pdMS_TO_TICKS(100)) != pdPASS) {
-                ESP_LOGE(TAG, "Không thể gửi dữ liệu cảm biến vào hàng đợi.");
-            }
-        } else {
-            ESP_LOGW(TAG, "zorxx/dht: Đọc dữ liệu từ cảm biến DHT11 thất bại. Sẽ thử lại sau.");
-            // Lỗi đã được log chi tiết trong hàm read_dht11_sensor_zorxx()
+        // sensor_set_sweep() tự chờ đến pha của từng cảm biến và giữ chu kỳ quét cố định
+        if (sensor_set_sweep(&batch) != ESP_OK) {
+            vTaskDelay(pdMS_TO_TICKS(APP_SENSOR_UPDATE_INTERVAL_MS));
+            continue;
+        }
+        // Lọc trước khi đánh giá thay đổi, để nhiễu lượng tử hóa không kéo chu kỳ về mức nhanh nhất
+        filter_batch(&batch);
+        for (uint8_t i = 0; i < batch.count; i++) {
+            forward_sample(&batch.samples[i]);
+        }
+
+#if APP_SENSOR_ADAPTIVE_SAMPLING
+        uint32_t next_period_ms = adaptive_sampling_update(&batch);
+#else
+        uint32_t next_period_ms = APP_SENSOR_UPDATE_INTERVAL_MS;
+#endif
+        // Chu kỳ đặt từ xa (lệnh MQTT) được ưu tiên hơn chu kỳ thích ứng / cố định
+        uint32_t override_ms = sensor_set_get_period_override();
+        if (override_ms) {
+            next_period_ms = override_ms;
+        }
+        if (next_period_ms != sensor_set_get_period_ms()) {
+            ESP_LOGI(TAG, "Đổi chu kỳ lấy mẫu: %lu ms -> %lu ms.", sensor_set_get_period_ms(), next_period_ms);
+            sensor_set_set_period(next_period_ms);
         }
-        // Đợi khoảng thời gian đã định nghĩa trong app_config.h
-        vTaskDelay(pdMS_TO_TICKS(APP_SENSOR_UPDATE_INTERVAL_MS));
     }
 }
@@ -0,0 +1,48 @@
+#include <string.h>
+
+#include "inc/seqlock.h"
+
+void seqlock_init(seqlock_t *lock) {
+    atomic_init(&lock->seq, 0);
+    portMUX_INITIALIZE(&lock->writer_mux);
+    atomic_init(&lock->reads, 0);
+    atomic_init(&lock->retries, 0);
+    atomic_init(&lock->writes, 0);
+}
+
+void seqlock_write(seqlock_t *lock, void *dst, const void *src, size_t size) {
+    portENTER_CRITICAL(&lock->writer_mux);
+    uint_fast32_t seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(dst, src, size);
+    atomic_store_explicit(&lock->seq, seq + 2, memory_order_release);
+    portEXIT_CRITICAL(&lock->writer_mux);
+
+    atomic_fetch_add_explicit(&lock->writes, 1, memory_order_relaxed);
+}
+
+void seqlock_read(seqlock_t *lock, void *dst, const void *src, size_t size) {
+    uint_fast32_t before;
+    uint_fast32_t after;
+
+    atomic_fetch_add_explicit(&lock->reads, 1, memory_order_relaxed);
+    while (1) {
+        before = atomic_load_explicit(&lock->seq, memory_order_acquire);
+        if ((before & 1) == 0) {
+            memcpy(dst, src, size);
+            atomic_thread_fence(memory_order_acquire);
+            after = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+            if (before == after) {
+                return;
+            }
+        }
+        atomic_fetch_add_explicit(&lock->retries, 1, memory_order_relaxed);
+    }
+}
+
+void seqlock_get_stats(seqlock_t *lock, seqlock_stats_t *stats) {
+    stats->reads = atomic_load_explicit(&lock->reads, memory_order_relaxed);
+    stats->retries = atomic_load_explicit(&lock->retries, memory_order_relaxed);
+    stats->writes = atomic_load_explicit(&lock->writes, memory_order_relaxed);
+}
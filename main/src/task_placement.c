@@ -0,0 +1,129 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#include "inc/app_config.h"
+#include "inc/task_placement.h"
+#include "inc/sensor_set.h"
+#include "inc/sensor_sample.h"
+
+static const char *TAG = "TASK_PLACEMENT";
+
+#define TASK_PLACEMENT_BENCH_MAGIC 0x504C4331u
+
+// Nhân của từng nhóm task theo phương án; stack WiFi của ESP-IDF chạy ở nhân 0 (PRO_CPU)
+static const BaseType_t s_core_map[APP_PLACEMENT_MAX][TASK_CLASS_MAX] = {
+    [APP_PLACEMENT_FLOATING]     = { tskNO_AFFINITY, tskNO_AFFINITY, tskNO_AFFINITY, tskNO_AFFINITY },
+    [APP_PLACEMENT_SPLIT]        = { 0,              1,              1,              tskNO_AFFINITY },
+    [APP_PLACEMENT_ACQ_ISOLATED] = { 0,              1,              0,              0              },
+};
+
+// Kết quả benchmark giữ qua esp_restart() (không bị xóa khi khởi động lại bằng phần mềm)
+typedef struct {
+    uint32_t magic;
+    uint32_t next;                  // Phương án sẽ chạy ở lần khởi động này
+    task_placement_result_t results[APP_PLACEMENT_MAX];
+} task_placement_bench_t;
+
+static RTC_NOINIT_ATTR task_placement_bench_t s_bench;
+static task_placement_t s_active = APP_TASK_PLACEMENT;
+static bool s_resolved = false;
+
+task_placement_t task_placement_active(void) {
+    if (s_resolved) {
+        return s_active;
+    }
+    s_resolved = true;
+
+#if APP_PLACEMENT_BENCHMARK_MS > 0
+    // Chỉ tin RTC RAM sau khi chính benchmark khởi động lại; mọi lý do reset khác bắt đầu lại từ đầu
+    if (esp_reset_reason() != ESP_RST_SW || s_bench.magic != TASK_PLACEMENT_BENCH_MAGIC ||
+        s_bench.next > APP_PLACEMENT_MAX) {
+        memset(&s_bench, 0, sizeof(s_bench));
+        s_bench.magic = TASK_PLACEMENT_BENCH_MAGIC;
+    }
+    if (s_bench.next < APP_PLACEMENT_MAX) {
+        s_active = (task_placement_t)s_bench.next;
+        ESP_LOGW(TAG, "Benchmark: phương án %lu/%d (%s) trong %d ms.", s_bench.next + 1, APP_PLACEMENT_MAX,
+                 task_placement_to_string(s_active), APP_PLACEMENT_BENCHMARK_MS);
+    }
+#endif
+    return s_active;
+}
+
+BaseType_t task_placement_core(task_class_t task_class) {
+    if (task_class >= TASK_CLASS_MAX) {
+        return tskNO_AFFINITY;
+    }
+    return s_core_map[task_placement_active()][task_class];
+}
+
+const char *task_placement_to_string(task_placement_t placement) {
+    switch (placement) {
+        case APP_PLACEMENT_FLOATING: return "floating";
+        case APP_PLACEMENT_SPLIT: return "split";
+        case APP_PLACEMENT_ACQ_ISOLATED: return "acq-isolated";
+        default: return "unknown";
+    }
+}
+
+void task_placement_measure(task_placement_result_t *result) {
+    sensor_set_timing_stats_t timing;
+    sensor_latency_stats_t latency;
+
+    sensor_set_get_timing_stats(&timing);
+    sensor_sample_get_latency_stats(&latency);
+
+    memset(result, 0, sizeof(*result));
+    result->sweeps = timing.sweeps;
+    result->max_jitter_us = timing.max_jitter_us;
+    if (timing.sweeps) {
+        result->avg_jitter_us = (uint32_t)(timing.total_jitter_us / timing.sweeps);
+    }
+    result->publishes = latency.samples;
+    result->max_latency_us = latency.max_us;
+    if (latency.samples) {
+        result->avg_latency_us = (uint32_t)(latency.total_us / latency.samples);
+    }
+}
+
+void task_placement_benchmark_poll(void) {
+#if APP_PLACEMENT_BENCHMARK_MS > 0
+    if (s_bench.next >= APP_PLACEMENT_MAX ||
+        esp_timer_get_time() < (int64_t)APP_PLACEMENT_BENCHMARK_MS * 1000) {
+        return;
+    }
+    task_placement_measure(&s_bench.results[s_bench.next]);
+    s_bench.next++;
+    ESP_LOGW(TAG, "Benchmark: xong phương án %s, khởi động lại...", task_placement_to_string(s_active));
+    esp_restart();
+#endif
+}
+
+static void print_result(const char *name, const task_placement_result_t *r) {
+    printf("  %-13s jitter avg %6lu us, max %6lu us (%lu sweeps) | publish avg %7lu us, max %7lu us (%lu samples)\n",
+           name, r->avg_jitter_us, r->max_jitter_us, r->sweeps,
+           r->avg_latency_us, r->max_latency_us, r->publishes);
+}
+
+void task_placement_print_report(void) {
+    task_placement_result_t current;
+
+    task_placement_measure(&current);
+    printf("Task placement: %s\n", task_placement_to_string(task_placement_active()));
+    print_result("current", &current);
+
+#if APP_PLACEMENT_BENCHMARK_MS > 0
+    if (s_bench.next >= APP_PLACEMENT_MAX) {
+        printf("Placement benchmark (%d ms each):\n", APP_PLACEMENT_BENCHMARK_MS);
+        for (int p = 0; p < APP_PLACEMENT_MAX; p++) {
+            print_result(task_placement_to_string(p), &s_bench.results[p]);
+        }
+    }
+#endif
+}
@@ -0,0 +1,231 @@
+#include "freertos/FreeRTOS.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "esp_log.h"
+#include "esp_cpu.h"
+
+#include "inc/telemetry_codec.h"
+#include "inc/json_writer.h"
+
+static const char *TAG = "TELEMETRY_CODEC";
+
+static telemetry_codec_stats_t s_stats;
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+// Prefix "YYYY-MM-DD HH:" của giờ gần nhất; chỉ mqtt_task (và benchmark lúc khởi động) mã hóa JSON
+static json_time_cache_t s_time_cache;
+
+// Bộ mã hóa cũ (snprintf + localtime_r/strftime mỗi mẫu), chỉ còn dùng làm mốc trong benchmark
+static size_t encode_sample_snprintf(const sensor_sample_t *sample, int64_t wall_us, bool replay,
+                                     char *buf, size_t size) {
+    char temp_str[SENSOR_TENTHS_STR_LEN];
+    char hum_str[SENSOR_TENTHS_STR_LEN];
+    time_t sample_time = (time_t)(wall_us / 1000000);
+    struct tm timeinfo;
+    char time_str[64];
+
+    sensor_sample_format_tenths(temp_str, sizeof(temp_str), sample->temperature);
+    sensor_sample_format_tenths(hum_str, sizeof(hum_str), sample->humidity);
+    localtime_r(&sample_time, &timeinfo);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &timeinfo);
+
+    int len = snprintf(buf, size,
+                       "{\"sensor\":%u, \"seq\":%lu, \"temperature\":%s, \"humidity\":%s, \"flags\":%u, \"timestamp\":\"%s.%03d\"%s}",
+                       sample->sensor_id, (unsigned long)sample->seq, temp_str, hum_str, sample->flags, time_str,
+                       (int)(wall_us / 1000 % 1000), replay ? ", \"replay\":true" : "");
+    return len > 0 && (size_t)len < size ? (size_t)len : 0;
+}
+
+size_t telemetry_codec_encode_sample(const sensor_sample_t *sample, int64_t wall_us, bool replay,
+                                     char *buf, size_t size) {
+    json_writer_t w;
+
+    json_writer_init(&w, buf, size);
+    json_writer_begin_object(&w);
+    json_writer_key(&w, "sensor");
+    json_writer_uint(&w, sample->sensor_id);
+    json_writer_key(&w, "seq");
+    json_writer_uint(&w, sample->seq);
+    json_writer_key(&w, "temperature");
+    json_writer_tenths(&w, sample->temperature);
+    json_writer_key(&w, "humidity");
+    json_writer_tenths(&w, sample->humidity);
+    json_writer_key(&w, "flags");
+    json_writer_uint(&w, sample->flags);
+    json_writer_key(&w, "timestamp");
+    json_writer_local_time(&w, &s_time_cache, wall_us);
+    if (replay) {
+        json_writer_key(&w, "replay");
+        json_writer_bool(&w, true);
+    }
+    json_writer_end_object(&w);
+    return json_writer_finish(&w);
+}
+
+size_t telemetry_codec_encode_batch(const telemetry_log_entry_t *records, size_t count, bool replay,
+                                    char *buf, size_t size) {
+    json_writer_t w;
+
+    if (count == 0) {
+        return 0;
+    }
+    int64_t t0_ms = records[0].wall_us / 1000;
+
+    json_writer_init(&w, buf, size);
+    json_writer_begin_object(&w);
+    json_writer_key(&w, "v");
+    json_writer_uint(&w, TELEMETRY_BATCH_SCHEMA_VERSION);
+    json_writer_key(&w, "t0");
+    json_writer_int64(&w, t0_ms);
+    if (replay) {
+        json_writer_key(&w, "r");
+        json_writer_uint(&w, 1);
+    }
+    json_writer_key(&w, "s");
+    json_writer_begin_array(&w);
+    for (size_t i = 0; i < count; i++) {
+        const sensor_sample_t *sample = &records[i].sample;
+        json_writer_begin_array(&w);
+        json_writer_uint(&w, sample->sensor_id);
+        json_writer_uint(&w, sample->seq);
+        json_writer_int(&w, (int32_t)(records[i].wall_us / 1000 - t0_ms));
+        json_writer_int(&w, sample->temperature);
+        json_writer_int(&w, sample->humidity);
+        json_writer_uint(&w, sample->flags);
+        json_writer_end_array(&w);
+    }
+    json_writer_end_array(&w);
+    json_writer_end_object(&w);
+    return json_writer_finish(&w);
+}
+
+size_t telemetry_codec_encode_alert(const char *alert, const sensor_sample_t *sample, int64_t wall_us,
+                                    char *buf, size_t size) {
+    json_writer_t w;
+
+    json_writer_init(&w, buf, size);
+    json_writer_begin_object(&w);
+    json_writer_key(&w, "alert");
+    json_writer_string(&w, alert);
+    json_writer_key(&w, "sensor");
+    json_writer_uint(&w, sample->sensor_id);
+    json_writer_key(&w, "seq");
+    json_writer_uint(&w, sample->seq);
+    json_writer_key(&w, "temperature");
+    json_writer_tenths(&w, sample->temperature);
+    json_writer_key(&w, "humidity");
+    json_writer_tenths(&w, sample->humidity);
+    json_writer_key(&w, "timestamp");
+    json_writer_local_time(&w, &s_time_cache, wall_us);
+    json_writer_end_object(&w);
+    return json_writer_finish(&w);
+}
+
+size_t telemetry_codec_encode_packed(const telemetry_log_entry_t *records, size_t count, bool replay,
+                                     uint8_t *buf, size_t size) {
+    size_t len = TELEMETRY_CODEC_PACKED_LEN(count);
+    if (count == 0 || count > UINT8_MAX || len > size) {
+        return 0;
+    }
+    int64_t t0_ms = records[0].wall_us / 1000;
+    telemetry_packed_header_t header = {
+        .schema = TELEMETRY_PACKED_SCHEMA,
+        .flags = replay ? TELEMETRY_PACKED_FLAG_REPLAY : 0,
+        .count = (uint8_t)count,
+        .t0_ms = t0_ms,
+    };
+    memcpy(buf, &header, sizeof(header));
+
+    // ESP32 là little-endian nên chép thẳng struct là đúng bố cục trên dây
+    uint8_t *out = buf + sizeof(header);
+    for (size_t i = 0; i < count; i++) {
+        const sensor_sample_t *sample = &records[i].sample;
+        telemetry_packed_record_t rec = {
+            .sensor_id = sample->sensor_id,
+            .flags = sample->flags,
+            .temperature = sample->temperature,
+            .humidity = sample->humidity,
+            .seq = sample->seq,
+            .dt_ms = (int32_t)(records[i].wall_us / 1000 - t0_ms),
+        };
+        memcpy(out, &rec, sizeof(rec));
+        out += sizeof(rec);
+    }
+    return len;
+}
+
+void telemetry_codec_benchmark(uint32_t iterations, telemetry_codec_bench_t *result) {
+    static telemetry_log_entry_t records[TELEMETRY_CODEC_BENCH_BATCH];
+    static char buf[TELEMETRY_CODEC_PAYLOAD_LEN(TELEMETRY_CODEC_BENCH_BATCH)];
+    uint64_t snprintf_cycles = 0, json_cycles = 0, batch_cycles = 0, packed_cycles = 0;
+    size_t snprintf_len = 0, json_len = 0, batch_len = 0, packed_len = 0;
+    uint32_t start;
+
+    memset(result, 0, sizeof(*result));
+    if (iterations == 0) {
+        return;
+    }
+    result->iterations = iterations;
+    for (size_t i = 0; i < TELEMETRY_CODEC_BENCH_BATCH; i++) {
+        records[i].sample = (sensor_sample_t){
+            .temperature = (int16_t)(253 + i),
+            .humidity = (int16_t)(551 - i),
+            .sensor_id = (uint8_t)(i % 2),
+            .flags = SENSOR_FLAG_FILTERED,
+            .seq = 1000 + i,
+        };
+        records[i].wall_us = 1714557600123000LL + (int64_t)i * 2000000;
+    }
+
+    // Bộ đếm chu kỳ 32 bit tràn sau vài giây nên cộng dồn từng lần đo; app_main chạy cố định
+    // trên một core nên mọi lần đọc cùng một bộ đếm
+    for (uint32_t it = 0; it < iterations; it++) {
+        for (size_t i = 0; i < TELEMETRY_CODEC_BENCH_BATCH; i++) {
+            start = esp_cpu_get_cycle_count();
+            snprintf_len = encode_sample_snprintf(&records[i].sample, records[i].wall_us, false, buf, sizeof(buf));
+            snprintf_cycles += esp_cpu_get_cycle_count() - start;
+
+            start = esp_cpu_get_cycle_count();
+            json_len = telemetry_codec_encode_sample(&records[i].sample, records[i].wall_us, false, buf, sizeof(buf));
+            json_cycles += esp_cpu_get_cycle_count() - start;
+        }
+
+        start = esp_cpu_get_cycle_count();
+        batch_len = telemetry_codec_encode_batch(records, TELEMETRY_CODEC_BENCH_BATCH, false, buf, sizeof(buf));
+        batch_cycles += esp_cpu_get_cycle_count() - start;
+
+        start = esp_cpu_get_cycle_count();
+        packed_len = telemetry_codec_encode_packed(records, TELEMETRY_CODEC_BENCH_BATCH, false, (uint8_t *)buf, sizeof(buf));
+        packed_cycles += esp_cpu_get_cycle_count() - start;
+    }
+
+    uint32_t samples = iterations * TELEMETRY_CODEC_BENCH_BATCH;
+    result->json_snprintf_cycles = (uint32_t)(snprintf_cycles / samples);
+    result->json_snprintf_bytes = (uint32_t)snprintf_len;
+    result->json_cycles = (uint32_t)(json_cycles / samples);
+    result->json_bytes = (uint32_t)json_len;
+    result->json_batch_cycles = (uint32_t)(batch_cycles / samples);
+    result->json_batch_bytes = (uint32_t)(batch_len / TELEMETRY_CODEC_BENCH_BATCH);
+    result->packed_cycles = (uint32_t)(packed_cycles / samples);
+    result->packed_bytes = (uint32_t)(packed_len / TELEMETRY_CODEC_BENCH_BATCH);
+
+    ESP_LOGI(TAG, "Benchmark (%lu x %d samples), cycles / bytes per sample: json snprintf %lu / %lu, "
+             "json writer %lu / %lu, json batch %lu / %lu, packed %lu / %lu",
+             result->iterations, TELEMETRY_CODEC_BENCH_BATCH,
+             result->json_snprintf_cycles, result->json_snprintf_bytes, result->json_cycles, result->json_bytes,
+             result->json_batch_cycles, result->json_batch_bytes, result->packed_cycles, result->packed_bytes);
+}
+
+void telemetry_codec_record_publish(size_t samples, size_t bytes) {
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.messages++;
+    s_stats.samples += samples;
+    s_stats.bytes += bytes;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+void telemetry_codec_get_stats(telemetry_codec_stats_t *stats) {
+    portENTER_CRITICAL(&s_stats_mux);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
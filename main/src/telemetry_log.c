@@ -0,0 +1,545 @@
+#include "freertos/FreeRTOS.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#if CONFIG_SPI_FLASH_ENABLE_COUNTERS
+#include "esp_spi_flash_counters.h"
+#endif
+
+#include "inc/app_config.h"
+#include "inc/telemetry_log.h"
+
+static const char *TAG = "TELEMETRY_LOG";
+
+#define TLOG_MAGIC      0x544Cu
+#define TLOG_VERSION    2
+
+// Bản ghi 16 byte; thời gian lưu dạng lệch (ms) so với base_wall_ms của trang
+typedef struct __attribute__((packed)) {
+    uint32_t delta_ms;
+    uint32_t seq;
+    int16_t temperature;
+    int16_t humidity;
+    uint8_t sensor_id;
+    uint8_t flags;
+    uint16_t crc;               // CRC-16 của 14 byte phía trên
+} tlog_record_t;
+
+// Header 32 byte ở đầu mỗi trang, được ghi cùng lô bản ghi đầu tiên
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t record_size;
+    uint32_t page_seq;          // Tăng dần qua các lần khởi động, xác định thứ tự trang khi quét
+    int64_t base_wall_ms;
+    uint32_t erase_count;       // Bộ đếm hao mòn của sector chứa trang
+    uint16_t header_crc;        // CRC-16 của các trường phía trên
+    uint16_t consumed_mask;     // Bit i = 1: bản ghi i chưa gửi; chỉ xóa bit 1 -> 0, nằm ngoài CRC
+    uint8_t reserved[8];
+} tlog_page_header_t;
+
+#define TLOG_RECORDS_PER_PAGE ((TELEMETRY_LOG_PAGE_SIZE - sizeof(tlog_page_header_t)) / sizeof(tlog_record_t))
+#define TLOG_PAGES_PER_SECTOR (TELEMETRY_LOG_SECTOR_SIZE / TELEMETRY_LOG_PAGE_SIZE)
+
+typedef struct __attribute__((packed)) {
+    tlog_page_header_t header;
+    tlog_record_t records[TLOG_RECORDS_PER_PAGE];
+} tlog_page_t;
+
+_Static_assert(sizeof(tlog_record_t) == 16, "tlog_record_t phải là 16 byte");
+_Static_assert(sizeof(tlog_page_header_t) == 32, "tlog_page_header_t phải là 32 byte");
+_Static_assert(sizeof(tlog_page_t) == TELEMETRY_LOG_PAGE_SIZE, "Trang phải vừa đúng TELEMETRY_LOG_PAGE_SIZE");
+_Static_assert(TLOG_RECORDS_PER_PAGE <= 16, "consumed_mask chỉ có 16 bit");
+
+static const esp_partition_t *s_partition = NULL;
+static uint32_t s_pages;
+static uint32_t s_sectors;
+static uint32_t s_sector_erases[TELEMETRY_LOG_MAX_SECTORS];
+static uint32_t s_next_page_seq;
+
+// Trang đang ghi: bản sao trong RAM, s_head_flushed bản ghi đầu đã nằm trên flash
+static tlog_page_t s_head;
+static uint32_t s_head_page;        // Trang đang ghi, hoặc trang sẽ mở kế tiếp nếu !s_head_active
+static bool s_head_active;
+static uint8_t s_head_count;
+static uint8_t s_head_flushed;
+static int64_t s_buffer_since_us;   // Thời điểm bản ghi cũ nhất chưa ghi xuống flash được thêm vào
+
+static uint32_t s_tail_page;        // Trang cũ nhất có thể còn bản ghi chờ gửi
+static tlog_page_t s_page_buf;      // Buffer đọc cho quét/peek
+
+// Vị trí các bản ghi của lần peek gần nhất
+static struct {
+    uint32_t page;
+    uint8_t index;
+} s_peeked[TELEMETRY_LOG_PEEK_MAX];
+static size_t s_peeked_count;
+
+static telemetry_log_stats_t s_stats;
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint16_t tlog_crc16(const void *data, size_t len) {
+    return esp_rom_crc16_le(0, data, len);
+}
+
+static bool is_erased(const void *data, size_t len) {
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t page_offset(uint32_t page) {
+    return (size_t)page * TELEMETRY_LOG_PAGE_SIZE;
+}
+
+static bool header_valid(const tlog_page_header_t *h) {
+    return h->magic == TLOG_MAGIC && h->version == TLOG_VERSION && h->record_size == sizeof(tlog_record_t) &&
+           h->header_crc == tlog_crc16(h, offsetof(tlog_page_header_t, header_crc));
+}
+
+static bool record_valid(const tlog_record_t *r) {
+    return !is_erased(r, sizeof(*r)) && r->crc == tlog_crc16(r, offsetof(tlog_record_t, crc));
+}
+
+static uint32_t page_pending_count(const tlog_page_t *page) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < TLOG_RECORDS_PER_PAGE; i++) {
+        if ((page->header.consumed_mask & (1u << i)) && record_valid(&page->records[i])) {
+            n++;
+        }
+    }
+    return n;
+}
+
+static void update_wear_stats(void) {
+    uint32_t min = UINT32_MAX, max = 0;
+    for (uint32_t s = 0; s < s_sectors; s++) {
+        if (s_sector_erases[s] < min) min = s_sector_erases[s];
+        if (s_sector_erases[s] > max) max = s_sector_erases[s];
+    }
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.min_sector_erases = s_sectors ? min : 0;
+    s_stats.max_sector_erases = max;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+esp_err_t telemetry_log_init(void) {
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                           (esp_partition_subtype_t)TELEMETRY_LOG_PARTITION_SUBTYPE,
+                                           TELEMETRY_LOG_PARTITION_LABEL);
+    if (s_partition == NULL) {
+        ESP_LOGW(TAG, "Không tìm thấy phân vùng '%s', tắt lưu tạm trên flash.", TELEMETRY_LOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_sectors = s_partition->size / TELEMETRY_LOG_SECTOR_SIZE;
+    if (s_sectors > TELEMETRY_LOG_MAX_SECTORS) {
+        s_sectors = TELEMETRY_LOG_MAX_SECTORS;
+    }
+    s_pages = s_sectors * TLOG_PAGES_PER_SECTOR;
+    memset(s_sector_erases, 0, sizeof(s_sector_erases));
+
+    // Quét mọi trang: trang mới nhất xác định vị trí ghi, trang chờ gửi cũ nhất xác định vị trí đọc.
+    // Header hoặc bản ghi có CRC sai là dấu vết của lần ghi dở khi mất điện và bị bỏ qua.
+    bool found = false, found_pending = false;
+    uint32_t newest_seq = 0, newest_page = 0, oldest_pending_seq = 0, oldest_pending_page = 0;
+    uint32_t pending = 0, torn = 0;
+    for (uint32_t page = 0; page < s_pages; page++) {
+        esp_err_t err = esp_partition_read(s_partition, page_offset(page), &s_page_buf, sizeof(s_page_buf));
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Đọc phân vùng thất bại (%s).", esp_err_to_name(err));
+            s_partition = NULL;
+            return err;
+        }
+        const tlog_page_header_t *h = &s_page_buf.header;
+        if (is_erased(h, sizeof(*h))) {
+            continue;
+        }
+        if (!header_valid(h)) {
+            torn++;
+            continue;
+        }
+        uint32_t sector = page / TLOG_PAGES_PER_SECTOR;
+        if (h->erase_count > s_sector_erases[sector]) {
+            s_sector_erases[sector] = h->erase_count;
+        }
+        if (!found || (int32_t)(h->page_seq - newest_seq) > 0) {
+            found = true;
+            newest_seq = h->page_seq;
+            newest_page = page;
+        }
+        for (uint32_t i = 0; i < TLOG_RECORDS_PER_PAGE; i++) {
+            const tlog_record_t *r = &s_page_buf.records[i];
+            if (!is_erased(r, sizeof(*r)) && !record_valid(r)) {
+                torn++;
+            }
+        }
+        uint32_t page_pending = page_pending_count(&s_page_buf);
+        if (page_pending) {
+            pending += page_pending;
+            if (!found_pending || (int32_t)(h->page_seq - oldest_pending_seq) < 0) {
+                found_pending = true;
+                oldest_pending_seq = h->page_seq;
+                oldest_pending_page = page;
+            }
+        }
+    }
+
+    if (found) {
+        // Không ghi tiếp vào trang cũ (có thể đang dở): bắt đầu từ trang kế tiếp
+        s_next_page_seq = newest_seq + 1;
+        s_head_page = (newest_page + 1) % s_pages;
+    } else {
+        // Log trống: bắt đầu ở sector ít bị xóa nhất
+        uint32_t best = 0;
+        for (uint32_t s = 1; s < s_sectors; s++) {
+            if (s_sector_erases[s] < s_sector_erases[best]) {
+                best = s;
+            }
+        }
+        s_next_page_seq = 0;
+        s_head_page = best * TLOG_PAGES_PER_SECTOR;
+    }
+    s_head_active = false;
+    s_head_count = 0;
+    s_head_flushed = 0;
+    s_tail_page = found_pending ? oldest_pending_page : s_head_page;
+    s_peeked_count = 0;
+
+    portENTER_CRITICAL(&s_stats_mux);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.capacity = s_pages * TLOG_RECORDS_PER_PAGE;
+    s_stats.pending = pending;
+    s_stats.torn = torn;
+    portEXIT_CRITICAL(&s_stats_mux);
+    update_wear_stats();
+
+    ESP_LOGI(TAG, "Log '%s': %lu bản ghi, %lu đang chờ gửi lại, %lu hỏng đã bỏ qua.",
+             TELEMETRY_LOG_PARTITION_LABEL, s_stats.capacity, pending, torn);
+    return ESP_OK;
+}
+
+// Xóa một sector trước khi ghi vào; khi log đầy, bản ghi chưa gửi trong sector đó bị bỏ
+static esp_err_t erase_sector(uint32_t sector) {
+    uint32_t dropped = 0;
+    uint32_t first = sector * TLOG_PAGES_PER_SECTOR;
+
+    if (s_stats.pending) {
+        for (uint32_t page = first; page < first + TLOG_PAGES_PER_SECTOR; page++) {
+            if (esp_partition_read(s_partition, page_offset(page), &s_page_buf, sizeof(s_page_buf)) == ESP_OK &&
+                header_valid(&s_page_buf.header)) {
+                dropped += page_pending_count(&s_page_buf);
+            }
+        }
+        if (s_tail_page / TLOG_PAGES_PER_SECTOR == sector) {
+            s_tail_page = ((sector + 1) % s_sectors) * TLOG_PAGES_PER_SECTOR;
+        }
+        s_peeked_count = 0;
+    }
+
+    esp_err_t err = esp_partition_erase_range(s_partition, (size_t)sector * TELEMETRY_LOG_SECTOR_SIZE,
+                                              TELEMETRY_LOG_SECTOR_SIZE);
+    s_sector_erases[sector]++;
+    portENTER_CRITICAL(&s_stats_mux);
+    if (dropped > s_stats.pending) {
+        dropped = s_stats.pending;
+    }
+    s_stats.pending -= dropped;
+    s_stats.dropped += dropped;
+    s_stats.erases++;
+    portEXIT_CRITICAL(&s_stats_mux);
+    update_wear_stats();
+    if (dropped) {
+        ESP_LOGW(TAG, "Log đầy, bỏ %lu mẫu chưa gửi cũ nhất.", dropped);
+    }
+    return err;
+}
+
+// Cấp trang mới cho s_head: xóa sector khi bước sang sector mới, bỏ qua phần sector không còn trống
+static esp_err_t open_head_page(int64_t base_wall_ms) {
+    uint32_t page = s_head_page;
+
+    if (page % TLOG_PAGES_PER_SECTOR != 0) {
+        esp_err_t err = esp_partition_read(s_partition, page_offset(page), &s_page_buf, sizeof(s_page_buf));
+        if (err != ESP_OK || !is_erased(&s_page_buf, sizeof(s_page_buf))) {
+            page = ((page / TLOG_PAGES_PER_SECTOR + 1) % s_sectors) * TLOG_PAGES_PER_SECTOR;
+        }
+    }
+    if (page % TLOG_PAGES_PER_SECTOR == 0) {
+        esp_err_t err = erase_sector(page / TLOG_PAGES_PER_SECTOR);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Xóa sector thất bại (%s).", esp_err_to_name(err));
+            return err;
+        }
+    }
+    if (s_stats.pending == 0) {
+        s_tail_page = page;
+    }
+
+    memset(&s_head, 0xFF, sizeof(s_head));
+    s_head.header.magic = TLOG_MAGIC;
+    s_head.header.version = TLOG_VERSION;
+    s_head.header.record_size = sizeof(tlog_record_t);
+    s_head.header.page_seq = s_next_page_seq++;
+    s_head.header.base_wall_ms = base_wall_ms;
+    s_head.header.erase_count = s_sector_erases[page / TLOG_PAGES_PER_SECTOR];
+    s_head.header.header_crc = tlog_crc16(&s_head.header, offsetof(tlog_page_header_t, header_crc));
+    s_head_page = page;
+    s_head_active = true;
+    s_head_count = 0;
+    s_head_flushed = 0;
+    return ESP_OK;
+}
+
+esp_err_t telemetry_log_flush(void) {
+    if (s_partition == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!s_head_active || s_head_flushed == s_head_count) {
+        return ESP_OK;
+    }
+    // Lô đầu tiên của trang ghi cùng header trong một lần; các lô sau chỉ ghi vào phần còn trống
+    size_t from = s_head_flushed == 0 ? 0 : offsetof(tlog_page_t, records) + s_head_flushed * sizeof(tlog_record_t);
+    size_t to = offsetof(tlog_page_t, records) + s_head_count * sizeof(tlog_record_t);
+    esp_err_t err = esp_partition_write(s_partition, page_offset(s_head_page) + from,
+                                        (const uint8_t *)&s_head + from, to - from);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Ghi trang thất bại (%s).", esp_err_to_name(err));
+        return err;
+    }
+    s_head_flushed = s_head_count;
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.buffered = 0;
+    s_stats.page_writes++;
+    portEXIT_CRITICAL(&s_stats_mux);
+    return ESP_OK;
+}
+
+void telemetry_log_flush_if_due(void) {
+    if (s_partition != NULL && s_head_active && s_head_flushed != s_head_count &&
+        esp_timer_get_time() - s_buffer_since_us >= (int64_t)APP_TELEMETRY_FLUSH_MS * 1000) {
+        telemetry_log_flush();
+    }
+}
+
+esp_err_t telemetry_log_append(const sensor_sample_t *sample, int64_t wall_us) {
+    int64_t wall_ms = wall_us / 1000;
+    esp_err_t err;
+
+    if (s_partition == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // Độ lệch thời gian phải vừa 32 bit và không âm, nếu không thì sang trang mới
+    if (s_head_active && (wall_ms < s_head.header.base_wall_ms ||
+                          wall_ms - s_head.header.base_wall_ms > UINT32_MAX)) {
+        if ((err = telemetry_log_flush()) != ESP_OK) {
+            return err;
+        }
+        s_head_page = (s_head_page + 1) % s_pages;
+        s_head_active = false;
+    }
+    if (!s_head_active && (err = open_head_page(wall_ms)) != ESP_OK) {
+        return err;
+    }
+
+    tlog_record_t *rec = &s_head.records[s_head_count];
+    rec->delta_ms = (uint32_t)(wall_ms - s_head.header.base_wall_ms);
+    rec->seq = sample->seq;
+    rec->temperature = sample->temperature;
+    rec->humidity = sample->humidity;
+    rec->sensor_id = sample->sensor_id;
+    rec->flags = sample->flags;
+    rec->crc = tlog_crc16(rec, offsetof(tlog_record_t, crc));
+    if (s_head_count == s_head_flushed) {
+        s_buffer_since_us = esp_timer_get_time();
+    }
+    s_head_count++;
+
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.pending++;
+    s_stats.buffered++;
+    s_stats.appended++;
+    portEXIT_CRITICAL(&s_stats_mux);
+
+    if (s_head_count == TLOG_RECORDS_PER_PAGE) {
+        err = telemetry_log_flush();
+        s_head_page = (s_head_page + 1) % s_pages;
+        s_head_active = false;
+        return err;
+    }
+    telemetry_log_flush_if_due();
+    return ESP_OK;
+}
+
+size_t telemetry_log_peek(telemetry_log_entry_t *out, size_t max) {
+    size_t n = 0;
+    bool leading = true;
+
+    s_peeked_count = 0;
+    if (s_partition == NULL || s_stats.pending == 0 || telemetry_log_flush() != ESP_OK) {
+        return 0;
+    }
+    if (max > TELEMETRY_LOG_PEEK_MAX) {
+        max = TELEMETRY_LOG_PEEK_MAX;
+    }
+    // Trang cuối cùng có dữ liệu: trang đang ghi, hoặc trang ngay trước vị trí sẽ mở
+    uint32_t last_page = s_head_active ? s_head_page : (s_head_page + s_pages - 1) % s_pages;
+
+    uint32_t first_page = s_tail_page;
+
+    for (uint32_t visited = 0; visited < s_pages && n < max; visited++) {
+        uint32_t page = (first_page + visited) % s_pages;
+        uint32_t taken = 0;
+        if (esp_partition_read(s_partition, page_offset(page), &s_page_buf, sizeof(s_page_buf)) == ESP_OK &&
+            header_valid(&s_page_buf.header)) {
+            const tlog_page_header_t *h = &s_page_buf.header;
+            for (uint32_t i = 0; i < TLOG_RECORDS_PER_PAGE && n < max; i++) {
+                const tlog_record_t *r = &s_page_buf.records[i];
+                if (!(h->consumed_mask & (1u << i)) || !record_valid(r)) {
+                    continue;
+                }
+                out[n].sample = (sensor_sample_t){
+                    .temperature = r->temperature,
+                    .humidity = r->humidity,
+                    .sensor_id = r->sensor_id,
+                    .flags = r->flags,
+                    .seq = r->seq,
+                    .timestamp_us = 0,
+                };
+                out[n].wall_us = (h->base_wall_ms + r->delta_ms) * 1000;
+                s_peeked[n].page = page;
+                s_peeked[n].index = (uint8_t)i;
+                n++;
+                taken++;
+            }
+        }
+        // Các trang đầu không còn gì để gửi: dời vị trí đọc qua chúng
+        if (leading && taken == 0 && page != last_page) {
+            s_tail_page = (page + 1) % s_pages;
+        } else {
+            leading = false;
+        }
+        if (page == last_page) {
+            break;
+        }
+    }
+    s_peeked_count = n;
+    return n;
+}
+
+esp_err_t telemetry_log_consume(size_t count) {
+    if (s_partition == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (count > s_peeked_count) {
+        count = s_peeked_count;
+    }
+    // Gộp các bản ghi cùng trang thành một lần ghi consumed_mask
+    size_t i = 0;
+    while (i < count) {
+        uint32_t page = s_peeked[i].page;
+        uint16_t mask = 0xFFFF;
+        size_t run = 0;
+        while (i + run < count && s_peeked[i + run].page == page) {
+            mask &= ~(1u << s_peeked[i + run].index);
+            run++;
+        }
+        esp_err_t err = esp_partition_write(s_partition, page_offset(page) + offsetof(tlog_page_header_t, consumed_mask),
+                                            &mask, sizeof(mask));
+        if (err != ESP_OK) {
+            s_peeked_count = 0;
+            return err;
+        }
+        portENTER_CRITICAL(&s_stats_mux);
+        s_stats.pending -= run < s_stats.pending ? run : s_stats.pending;
+        s_stats.replayed += run;
+        portEXIT_CRITICAL(&s_stats_mux);
+        i += run;
+    }
+    s_peeked_count = 0;
+    return ESP_OK;
+}
+
+uint32_t telemetry_log_pending(void) {
+    return s_partition != NULL ? s_stats.pending : 0;
+}
+
+void telemetry_log_get_stats(telemetry_log_stats_t *stats) {
+    portENTER_CRITICAL(&s_stats_mux);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+esp_err_t telemetry_log_benchmark(uint32_t records, telemetry_log_bench_t *result) {
+    sensor_sample_t sample = { 0 };
+    nvs_handle_t nvs;
+    char key[8];
+
+    esp_err_t err = telemetry_log_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+    memset(result, 0, sizeof(*result));
+    result->records = records;
+
+    // Log: bắt đầu từ phân vùng trống
+    if ((err = esp_partition_erase_range(s_partition, 0, (size_t)s_sectors * TELEMETRY_LOG_SECTOR_SIZE)) != ESP_OK ||
+        (err = telemetry_log_init()) != ESP_OK) {
+        return err;
+    }
+    uint32_t erases_before = s_stats.erases;
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < records; i++) {
+        sample.seq = i;
+        sample.temperature = 250 + i % 10;
+        sample.humidity = 600;
+        telemetry_log_append(&sample, start_us + (int64_t)i * 1000);
+    }
+    telemetry_log_flush();
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    result->log_records_per_s = (uint32_t)((uint64_t)records * 1000000 / (elapsed_us ? elapsed_us : 1));
+    result->log_erases = s_stats.erases - erases_before;
+
+    // NVS: mỗi mẫu một blob 16 byte + commit, xoay vòng 32 khóa như khi lưu bộ đếm/mẫu gần nhất
+    if ((err = nvs_open("tlog_bench", NVS_READWRITE, &nvs)) != ESP_OK) {
+        return err;
+    }
+#if CONFIG_SPI_FLASH_ENABLE_COUNTERS
+    esp_flash_reset_counters();
+#endif
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < records; i++) {
+        tlog_record_t rec = { .delta_ms = i, .seq = i, .temperature = 250 + i % 10, .humidity = 600 };
+        rec.crc = tlog_crc16(&rec, offsetof(tlog_record_t, crc));
+        snprintf(key, sizeof(key), "r%lu", (unsigned long)(i % 32));
+        nvs_set_blob(nvs, key, &rec, sizeof(rec));
+        nvs_commit(nvs);
+    }
+    elapsed_us = esp_timer_get_time() - start_us;
+    result->nvs_records_per_s = (uint32_t)((uint64_t)records * 1000000 / (elapsed_us ? elapsed_us : 1));
+#if CONFIG_SPI_FLASH_ENABLE_COUNTERS
+    result->nvs_erases = (int32_t)esp_flash_get_counters()->erase.count;
+#else
+    result->nvs_erases = -1;
+#endif
+    nvs_erase_all(nvs);
+    nvs_commit(nvs);
+    nvs_close(nvs);
+
+    // Trả log về trạng thái trống
+    if ((err = esp_partition_erase_range(s_partition, 0, (size_t)s_sectors * TELEMETRY_LOG_SECTOR_SIZE)) != ESP_OK) {
+        return err;
+    }
+    err = telemetry_log_init();
+
+    ESP_LOGI(TAG, "Benchmark %lu bản ghi: log %lu rec/s, %lu lần xóa sector; NVS %lu rec/s, %ld lần xóa sector",
+             records, result->log_records_per_s, result->log_erases, result->nvs_records_per_s, result->nvs_erases);
+    return err;
+}
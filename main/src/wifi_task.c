@@ -10,6 +10,7 @@
 #include "esp_log.h"
 
 #include "inc/app_config.h"
+#include "inc/app_state.h"
 
 static const char *TAG = "WIFI_MANAGER_TASK";
 
@@ -34,17 +35,27 @@ static void event_handler(void* arg, esp_event_base_t event_base,
         // Không set cờ WIFI_FAIL_BIT nữa vì chúng ta luôn thử lại.
         // Chỉ xóa cờ WIFI_CONNECTED_BIT để các task khác biết là đang offline.
         xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT);
+        app_state_set_wifi(false);
 
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         ESP_LOGI(TAG, "Da ket noi WiFi va nhan duoc IP:" IPSTR, IP2STR(&event->ip_info.ip));
         // Đã kết nối thành công, set cờ WIFI_CONNECTED_BIT
         xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
+        app_state_set_wifi(true);
     }
 }
 
+#if APP_STATIC_ALLOCATION
+static StaticEventGroup_t s_wifi_event_group_buf;
+#endif
+
 void wifi_init_sta(void) {
+#if APP_STATIC_ALLOCATION
+    wifi_event_group = xEventGroupCreateStatic(&s_wifi_event_group_buf);
+#else
     wifi_event_group = xEventGroupCreate();
+#endif
 
     esp_netif_create_default_wifi_sta();
 
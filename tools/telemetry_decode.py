@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Giải mã payload telemetry của firmware (main/inc/telemetry_codec.h) thành JSON, mỗi mẫu một dòng.
+
+Tự nhận dạng định dạng theo byte đầu: '{' là JSON (mỗi mẫu một object hoặc lô "v":1),
+TELEMETRY_PACKED_SCHEMA (0x01) là payload nhị phân.
+
+Ví dụ:
+    mosquitto_sub -h test.mosquitto.org -t esp32/dht_data/packed -N | python3 tools/telemetry_decode.py
+    python3 tools/telemetry_decode.py payload.bin
+    python3 tools/telemetry_decode.py --hex 0100010000...
+"""
+
+import argparse
+import json
+import struct
+import sys
+from datetime import datetime, timezone
+
+PACKED_SCHEMA = 0x01
+PACKED_FLAG_REPLAY = 0x01
+# Khớp telemetry_packed_header_t / telemetry_packed_record_t (little-endian, không padding)
+PACKED_HEADER = struct.Struct("<BBBxq")
+PACKED_RECORD = struct.Struct("<BBhhIi")
+BATCH_SCHEMA_VERSION = 1
+
+
+def _sample(sensor, seq, wall_ms, temp_tenths, hum_tenths, flags, replay):
+    return {
+        "sensor": sensor,
+        "seq": seq,
+        "temperature": temp_tenths / 10,
+        "humidity": hum_tenths / 10,
+        "flags": flags,
+        "timestamp": datetime.fromtimestamp(wall_ms / 1000, timezone.utc).isoformat(timespec="milliseconds"),
+        "replay": replay,
+    }
+
+
+def decode_packed(payload):
+    schema, flags, count, t0_ms = PACKED_HEADER.unpack_from(payload, 0)
+    if schema != PACKED_SCHEMA:
+        raise ValueError(f"unknown packed schema 0x{schema:02x}")
+    expected = PACKED_HEADER.size + count * PACKED_RECORD.size
+    if len(payload) != expected:
+        raise ValueError(f"packed payload is {len(payload)} bytes, header says {expected}")
+    replay = bool(flags & PACKED_FLAG_REPLAY)
+    samples = []
+    for i in range(count):
+        sensor, sflags, temp, hum, seq, dt_ms = PACKED_RECORD.unpack_from(payload, PACKED_HEADER.size + i * PACKED_RECORD.size)
+        samples.append(_sample(sensor, seq, t0_ms + dt_ms, temp, hum, sflags, replay))
+    return samples
+
+
+def decode_json(payload):
+    doc = json.loads(payload)
+    if "v" not in doc:
+        # Định dạng một mẫu: giữ nguyên các trường của firmware
+        doc.setdefault("replay", False)
+        return [doc]
+    if doc["v"] != BATCH_SCHEMA_VERSION:
+        raise ValueError(f"unknown batch schema version {doc['v']}")
+    replay = bool(doc.get("r", 0))
+    return [_sample(sensor, seq, doc["t0"] + dt_ms, temp, hum, flags, replay)
+            for sensor, seq, dt_ms, temp, hum, flags in doc["s"]]
+
+
+def decode(payload):
+    if not payload:
+        return []
+    if payload[0] == ord("{"):
+        return decode_json(payload.decode("utf-8"))
+    return decode_packed(payload)
+
+
+def _stream_payloads(stream):
+    # mosquitto_sub -N không thêm ký tự xuống dòng nên có thể có nhiều payload liền nhau:
+    # tách payload nhị phân theo độ dài trong phần đầu, JSON theo '}' cuối object ngoài cùng
+    data = stream.read()
+    pos = 0
+    while pos < len(data):
+        if data[pos] == PACKED_SCHEMA:
+            count = data[pos + 2]
+            end = pos + PACKED_HEADER.size + count * PACKED_RECORD.size
+        elif data[pos] == ord("{"):
+            depth = 0
+            end = pos
+            while end < len(data):
+                depth += {ord("{"): 1, ord("}"): -1}.get(data[end], 0)
+                end += 1
+                if depth == 0:
+                    break
+        else:
+            pos += 1  # Bỏ ký tự phân cách (xuống dòng)
+            continue
+        yield data[pos:end]
+        pos = end
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("files", nargs="*", help="tệp chứa payload; mặc định đọc stdin")
+    parser.add_argument("--hex", help="payload dạng chuỗi hex")
+    args = parser.parse_args()
+
+    if args.hex:
+        payloads = [bytes.fromhex(args.hex)]
+    elif args.files:
+        payloads = []
+        for path in args.files:
+            with open(path, "rb") as f:
+                payloads.extend(_stream_payloads(f))
+    else:
+        payloads = _stream_payloads(sys.stdin.buffer)
+
+    for payload in payloads:
+        for sample in decode(payload):
+            print(json.dumps(sample, ensure_ascii=False))
+
+
+if __name__ == "__main__":
+    main()